@@ -181,6 +181,8 @@ namespace sa {
 		static void WriteMetaFile(const std::filesystem::path& path, const AssetHeader& header);
 
 		static void WaitAllAssets();
+		// Executor shared by asset loading and other engine systems
+		static tf::Executor& GetTaskExecutor();
 
 		template<typename T>
 		T* cast();
@@ -30,6 +30,9 @@ namespace sa {
 	public:
 		using Asset::Asset;
 
+		// Compiles every shader source under directory into the shader cache, returns how many compiled successfully
+		static size_t PrebuildShaderCache(const std::filesystem::path& directory);
+
 		void create(const std::vector<ShaderSourceFile>& sourceFiles);
 		void create(const std::vector<std::vector<uint32_t>>& sourceCode);
 
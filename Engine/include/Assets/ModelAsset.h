@@ -20,6 +20,8 @@ namespace sa {
 
 	class ModelAsset : public Asset {
 	private:
+		uint64_t m_dataRevision = 0;
+
 		void processNode(const void* scene, const void* node, std::vector<uint32_t>& materialIndices);
 		bool loadAssimpModel(const std::filesystem::path& path);
 	public:
@@ -31,6 +33,12 @@ namespace sa {
 
 		static bool IsExtensionSupported(const std::string& extension);
 
+		// Changes whenever data is replaced, also by a reload in place. Unique over all models,
+		// so caches keyed by the asset pointer can compare it to notice stale data
+		uint64_t getDataRevision() const;
+		// Has to be called after writing data outside of the load functions
+		void markDataChanged();
+
 		virtual bool onLoad(JsonObject& metaData, AssetLoadFlags flags) override;
 		virtual bool onLoadCompiled(ByteStream& dataInStream, AssetLoadFlags flags) override;
 
@@ -9,6 +9,9 @@ namespace sa {
 		std::vector<unsigned char> m_dataBuffer;
 
 		Texture m_texture;
+		uint32_t m_tableSlot = UINT32_MAX;
+
+		void updateTableSlot();
 		
 	public:
 		using Asset::Asset;
@@ -23,6 +26,8 @@ namespace sa {
 		TextureAsset* clone(const std::string& name, const std::filesystem::path& assetDir = "") const override;
 
 		const Texture& getTexture() const;
+		// Index into the global bindless texture table
+		uint32_t getTableSlot() const;
 
 	};
 }
\ No newline at end of file
@@ -11,6 +11,8 @@ namespace comp {
 
 		sa::Vector3 halfLengths = sa::Vector3(1.0f);
 		sa::Vector3 offset = sa::Vector3(0.0f);
+		// Triggers report overlaps instead of colliding
+		bool isTrigger = false;
 
 		physx::PxMaterial* pMaterial = nullptr;
 		physx::PxShape* pShape = nullptr;
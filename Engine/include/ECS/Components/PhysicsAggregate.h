@@ -0,0 +1,28 @@
+#pragma once
+#include "ECS/ComponentBase.h"
+
+namespace comp {
+
+	// Groups the rigid bodies of the entity and all of its children into shared broadphase entries
+	class PhysicsAggregate : public sa::ComponentBase {
+	public:
+		// Whether the bodies of the group collide with each other
+		bool selfCollision = false;
+
+		PhysicsAggregate() = default;
+		PhysicsAggregate(const PhysicsAggregate&) = default;
+		PhysicsAggregate(PhysicsAggregate&&) = default;
+		PhysicsAggregate& operator=(const PhysicsAggregate&) = default;
+		PhysicsAggregate& operator=(PhysicsAggregate&&) noexcept = default;
+
+		PhysicsAggregate(bool selfCollision);
+
+		virtual void serialize(sa::Serializer& s) override;
+		virtual void deserialize(void* pDoc) override;
+
+		virtual void onConstruct(sa::Entity* e) override;
+		virtual void onUpdate(sa::Entity* e) override;
+		virtual void onDestroy(sa::Entity* e) override;
+
+	};
+}
@@ -4,6 +4,10 @@
 
 #include "ECS/Components/Transform.h"
 
+namespace sa {
+	class Scene;
+}
+
 namespace comp {
 	class RigidBody : public sa::ComponentBase {
 	private:
@@ -12,6 +16,21 @@ namespace comp {
 
 		physx::PxRigidActor* m_pActor = nullptr;
 		bool m_isStatic = true;
+
+		friend class sa::Scene;
+		// Poses after the last two simulation steps the actor moved in
+		physx::PxTransform m_previousPose = physx::PxTransform(physx::PxIdentity);
+		physx::PxTransform m_currentPose = physx::PxTransform(physx::PxIdentity);
+		uint64_t m_lastMovedStep = 0;
+		// Last pose written to the transform, any other value was set from outside the simulation
+		physx::PxTransform m_writtenPose = physx::PxTransform(physx::PxIdentity);
+
+		// The actor user data holds the entity handle, not a pointer
+		static void* ToUserData(entt::entity entity);
+		// Replaced actors leave their aggregates, the new actor joins the group of the body before the next step
+		static void InvalidateBody(physx::PxScene* pScene, const physx::PxActor* pActor);
+		// Takes the actor out of the scene and releases it, its touching pairs are still reported as ended
+		static void ReleaseActor(physx::PxScene* pScene, physx::PxRigidActor* pActor, bool wakeOnLostTouch);
 	public:
 
 		RigidBody() = default;
@@ -37,6 +56,8 @@ namespace comp {
 
 		void setGlobalPose(const comp::Transform& transform);
 
+		static entt::entity GetEntity(const physx::PxActor* pActor);
+
 
 		virtual void serialize(sa::Serializer& s) override;
 		virtual void deserialize(void* pDoc) override;
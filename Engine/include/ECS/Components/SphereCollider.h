@@ -7,6 +7,8 @@ namespace comp {
 	public:
 		float radius = 1.f;
 		glm::vec3 offset = glm::vec3(0);
+		// Triggers report overlaps instead of colliding
+		bool isTrigger = false;
 		physx::PxMaterial* pMaterial = nullptr;
 		physx::PxShape* pShape = nullptr;
 
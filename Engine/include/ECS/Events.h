@@ -1,6 +1,9 @@
 #pragma once
 #include "Entity.h"
 
+#include <Tools/Vector.h>
+#include <span>
+
 namespace sa {
 	class Scene;
 	class SceneCamera;
@@ -8,6 +11,30 @@ namespace sa {
 	class RenderPipeline;
 	class RenderContext;
 
+	enum class TouchState : uint8_t {
+		BEGIN,
+		END
+	};
+
+	// The entity of a side destroyed before the events were sent is entt::null
+	struct ContactRecord {
+		entt::entity entity0;
+		entt::entity entity1;
+		TouchState state;
+		// Average of the contact points, pairs that stopped touching have none
+		Vector3 position;
+		// Pushes entity0 away from entity1
+		Vector3 normal;
+		float impulse;
+	};
+
+	// The entity of a side destroyed before the events were sent is entt::null
+	struct TriggerRecord {
+		entt::entity trigger;
+		entt::entity other;
+		TouchState state;
+	};
+
 	namespace engine_event {
 
 		struct OnRender {
@@ -68,6 +95,19 @@ namespace sa {
 			Entity entity;
 		};
 
+		// Every contact that began or ended during the last steps, sent once per sync
+		struct Contacts {
+			inline static const char* CallbackName = "onContact";
+			Scene* pScene;
+			std::span<const ContactRecord> contacts;
+		};
+
+		struct Triggers {
+			inline static const char* CallbackName = "onTrigger";
+			Scene* pScene;
+			std::span<const TriggerRecord> triggers;
+		};
+
 		template<typename T>
 		struct ComponentCreated {
 			Entity entity;
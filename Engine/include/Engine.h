@@ -5,6 +5,7 @@
 
 #include "AssetManager.h"
 #include "Scene.h"
+#include "Tools/FrameStatistics.h"
 
 #include <RenderWindow.hpp>
 
@@ -16,6 +17,9 @@ namespace sa {
 		sa::DeviceMemoryStats gpuMemoryStats = {};
 		size_t drawCalls = 0;
 		size_t dispatchCalls = 0;
+		size_t triangleCount = 0;
+		float gpuFrameTime = 0.0f;
+		std::vector<sa::GpuTimestampScope> gpuScopes;
 	};
 
 
@@ -38,6 +42,8 @@ namespace sa {
 			float memoryQueryTimer;
 			std::array<float, 60> frameTimes;
 			uint32_t frameTimeCount;
+			long long lastGpuFrameBeginTime = 0;
+			DeviceActivityCounters lastActivityCounters = {};
 		} m_statsQuery;
 
 
@@ -49,6 +55,8 @@ namespace sa {
 		static void SetShaderDirectory(const std::filesystem::path& path);
 		
 		static EngineStatistics& GetEngineStatistics();
+		// Per frame history fed by collectStatistics
+		static FrameStatistics& GetFrameStatistics();
 		void collectStatistics(float dt);
 
 		// Call this to set up engine
@@ -62,6 +70,7 @@ namespace sa {
 
 		RenderPipeline& getRenderPipeline();
 
+		RenderTarget& getMainRenderTarget();
 		const RenderTarget& getMainRenderTarget() const;
 
 		void setWindowRenderer(IWindowRenderer* pWindowRenderer);
@@ -11,6 +11,10 @@ namespace sa {
 		
 		std::unordered_map<Entity, std::unordered_set<Entity>> m_children;
 		std::unordered_map<Entity, Entity> m_parents;
+		// Incremented on every change, lets systems built from the hierarchy know when to rebuild
+		uint64_t m_version = 0;
+		// Entities that changed parent and their old and new parents, since the last takeChangedEntities
+		std::vector<Entity> m_changedEntities;
 
 		bool isParent(const Entity& target, const Entity& parent);
 
@@ -35,6 +39,10 @@ namespace sa {
 
 		void forEachParent(std::function<void(const Entity&)> func);
 
+		uint64_t getVersion() const;
+		// Lets a system only update the parts of the hierarchy that changed, entities may be listed more than once
+		std::vector<Entity> takeChangedEntities();
+
 	};
 
 }
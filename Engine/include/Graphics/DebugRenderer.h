@@ -5,30 +5,102 @@
 #include "RenderContext.hpp"
 #include "SceneCamera.h"
 #include "Resources/DynamicBuffer.hpp"
+#include "Tools/Clock.h"
+
+#include <glm/gtx/quaternion.hpp>
+
+#define DEBUG_SHAPE_SEGMENTS 32U
+// Persistent draws with this lifetime stay until clearPersistent is called
+#define DEBUG_LIFETIME_INFINITE std::numeric_limits<float>::infinity()
 
 namespace sa {
+
+	// Unit shapes kept in GPU memory, drawn instanced with a transform and color per instance
+	enum class DebugShape : uint32_t {
+		BOX,		// [-1, 1] on every axis
+		SPHERE,		// radius 1
+		CONE,		// apex at origin, base of radius 1 at z = 1
+		FRUSTUM,	// NDC cube with z in [-1, 1], transform with an inverse view projection
+		ARROW,		// from origin to z = 1
+		COUNT
+	};
+
 	class DebugRenderer {
 	private:
-		
+
 		struct Vertex {
 			glm::vec3 position;
 			Color color;
 		};
 
+		struct ShapeInstance {
+			glm::mat4 transform;
+			Color color;
+		};
+
+		struct ShapeRange {
+			uint32_t firstVertex;
+			uint32_t vertexCount;
+		};
+
+		struct PersistentLine {
+			Vertex p1, p2;
+			float expireTime;
+		};
+
+		struct PersistentShape {
+			ShapeInstance instance;
+			float expireTime;
+		};
+
+		template<typename T>
+		using ShapeArray = std::array<T, static_cast<size_t>(DebugShape::COUNT)>;
+
 		std::array<Shader, 2> m_shaders;
 
 		ResourceID m_pipeline;
 		ResourceID m_wireframePipeline;
 		PipelineLayout m_pipelineLayout;
 
+		std::array<Shader, 2> m_shapeShaders;
+		ResourceID m_shapePipeline;
+		PipelineLayout m_shapePipelineLayout;
+
 		bool m_isInitialized;
 
 		DynamicBuffer m_lineVertexBuffer;
 
 		std::vector<Vertex> m_lineList;
 
+		// Shape geometry, line lists of every shape after each other
+		Buffer m_shapeVertexBuffer;
+		ShapeArray<ShapeRange> m_shapeRanges;
+
+		// Shapes drawn this frame only
+		ShapeArray<std::vector<ShapeInstance>> m_shapeInstances;
+		DynamicBuffer m_shapeInstanceBuffer;
+		ResourceID m_shapeDescriptorSet;
+
+		// Persistent draws, only uploaded when something is added or expires
+		Clock m_clock;
+		std::vector<PersistentLine> m_persistentLines;
+		ShapeArray<std::vector<PersistentShape>> m_persistentShapes;
+		uint64_t m_persistentVersion;
+		// Version of the persistent draws each buffer copy holds
+		std::vector<uint64_t> m_persistentBufferVersions;
+		DynamicBuffer m_persistentLineVertexBuffer;
+		DynamicBuffer m_persistentShapeInstanceBuffer;
+		ResourceID m_persistentShapeDescriptorSet;
 
 		DebugRenderer();
+
+		void createShapeGeometry();
+		void removeExpired();
+		void syncPersistentBuffers();
+
+		void addLine(const Vertex& p1, const Vertex& p2, float lifetime);
+		void drawShapeInstances(RenderContext& context, ResourceID descriptorSet, const DynamicBuffer& instanceBuffer, const ShapeArray<uint32_t>& instanceCounts);
+
 	public:
 		static DebugRenderer& Get();
 
@@ -37,9 +109,23 @@ namespace sa {
 
 		void render(RenderContext& context, Extent extent, const SceneCamera& sceneCamera);
 
-		void drawLine(const glm::vec3& p1, const glm::vec3& p2, Color color = Color::White);
-		void drawLines(glm::vec3* pPoints, uint32_t pointCount, Color color = Color::White);
-		void drawLineLoop(glm::vec3* pPoints, uint32_t pointCount, Color color = Color::White);
+		// lifetime is in seconds, 0 draws for this frame only
+		void drawLine(const glm::vec3& p1, const glm::vec3& p2, Color color = Color::White, float lifetime = 0.0f);
+		void drawLines(glm::vec3* pPoints, uint32_t pointCount, Color color = Color::White, float lifetime = 0.0f);
+		void drawLineLoop(glm::vec3* pPoints, uint32_t pointCount, Color color = Color::White, float lifetime = 0.0f);
+
+		void drawShape(DebugShape shape, const glm::mat4& transform, Color color = Color::White, float lifetime = 0.0f);
+		void drawBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation = glm::quat(1, 0, 0, 0), Color color = Color::White, float lifetime = 0.0f);
+		void drawSphere(const glm::vec3& center, float radius, Color color = Color::White, float lifetime = 0.0f);
+		// angle is the half angle of the cone in radians
+		void drawCone(const glm::vec3& apex, const glm::vec3& direction, float length, float angle, Color color = Color::White, float lifetime = 0.0f);
+		// zeroToOneDepth for projections with a [0, 1] NDC depth range, like the orthographic SceneCamera projection
+		void drawFrustum(const glm::mat4& viewProjection, bool zeroToOneDepth, Color color = Color::White, float lifetime = 0.0f);
+		// Picks the depth range from the projection mode of the camera
+		void drawFrustum(const SceneCamera& camera, Color color = Color::White, float lifetime = 0.0f);
+		void drawArrow(const glm::vec3& from, const glm::vec3& to, Color color = Color::White, float lifetime = 0.0f);
+
+		void clearPersistent();
 
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <GpuTimestamps.hpp>
+
+// Scale changes are rounded to this step, so small variations in frame time do not move the scale
+#define DYNAMIC_RESOLUTION_SCALE_STEP 0.05f
+
+namespace sa {
+
+	struct DynamicResolutionSettings {
+		bool isEnabled = false;
+		// GPU frame time budget in milliseconds
+		float targetFrameTime = 16.0f;
+		// Scale of each axis of the render target
+		float minScale = 0.5f;
+		float maxScale = 1.0f;
+		// The scale is only increased while the frame time stays below this fraction of the budget
+		float increaseThreshold = 0.85f;
+		// Frames in a row below the threshold before the scale is increased
+		uint32_t increaseDelay = 30;
+		// Strength of the sharpening applied when upscaling, 0 to 1
+		float sharpness = 0.5f;
+	};
+
+	// Picks the render scale of a render target from the GPU frame time. The scale drops as soon as the
+	// smoothed frame time is over budget, and only rises one step at a time after staying well below it.
+	class DynamicResolution {
+	private:
+		DynamicResolutionSettings m_settings;
+		float m_scale;
+		// Exponential moving average in milliseconds
+		float m_smoothedFrameTime;
+		uint32_t m_framesBelowThreshold;
+		long long m_lastFrameBeginTime;
+
+		void setScale(float scale);
+
+	public:
+		DynamicResolution();
+
+		// Feeds the last resolved GPU frame, returns true if the scale changed
+		bool update(const GpuFrameTimestamps& timestamps);
+
+		float getScale() const;
+
+		const DynamicResolutionSettings& getSettings() const;
+		void setSettings(const DynamicResolutionSettings& settings);
+	};
+
+}
@@ -5,6 +5,7 @@
 #include "SceneCamera.h"
 #include "SceneCollection.h"
 #include "RenderTarget.h"
+#include "RenderGraph.h"
 
 
 namespace sa {
@@ -24,10 +25,16 @@ namespace sa {
 		virtual void init() = 0;
 		virtual void cleanup() = 0;
 
+		// Readable name of the layer, used for its profiler and render graph scopes
+		virtual const char* getName() const = 0;
+
 		virtual void onRenderTargetResize(UUID renderTargetID, Extent oldExtent, Extent newExtent) = 0;
 		virtual void onPreferencesUpdated() {};
 
 		virtual bool preRender(RenderContext& context, SceneCollection& sceneCollection) { return true; };
+		// Declares the passes of the layer. The default adds one ordered pass named name that calls render.
+		// Returning false skips the remaining layers, like returning false from render.
+		virtual bool addRenderPasses(RenderGraph& graph, const std::string& name, RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection);
 		virtual bool render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) = 0;
 		virtual bool postRender(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) = 0;
 
@@ -212,6 +212,7 @@ namespace sa {
 		AssetHolder<MaterialShader> m_materialShader;
 
 		bool fetchTextures(MaterialTextureType type);
+		uint32_t getTextureSlot(MaterialTextureType type) const;
 		
 	public:
 		
@@ -240,6 +241,8 @@ namespace sa {
 			float opacity = 1.0f;
 			float roughness = 0.5f;
 			float metallic = 0.0f;
+
+			bool operator==(const Values&) const = default;
 		} values;
 
 		bool twoSided;
@@ -253,6 +256,9 @@ namespace sa {
 		
 		// Gathers all textures into an array, unless already gathered since last update
 		const std::vector<Texture>& fetchTextures();
+
+		// Values with every map index pointing into the global texture table
+		Values getShaderValues() const;
 		
 		std::unordered_map<MaterialTextureType, std::vector<AssetHolder<TextureAsset>>>& getTextures();
 
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "RenderContext.hpp"
+#include "Resources/TransientTexture.hpp"
+
+#define RENDER_GRAPH_INVALID_RESOURCE UINT32_MAX
+
+namespace sa {
+
+	typedef uint32_t RenderGraphResource;
+
+	enum class RenderGraphQueue {
+		GRAPHICS,
+		// Recorded on the graphics queue until the renderer exposes a dedicated compute queue,
+		// but scheduled as early as the dependencies allow so the work can be moved to one
+		COMPUTE
+	};
+
+	// Frame graph of passes that declare the textures and buffers they read and write.
+	// compile() orders the passes, culls passes whose writes are never used, places the
+	// transient textures and plans the barriers, which execute() records merged into one
+	// pipeline barrier per pass.
+	class RenderGraph {
+	public:
+		class PassBuilder;
+		typedef std::function<bool(RenderContext&)> ExecuteFunction;
+
+	private:
+		struct Resource {
+			std::string name;
+			const Texture* pTexture = nullptr;
+			const Buffer* pBuffer = nullptr;
+			// State when imported
+			Transition initialState = Transition::NONE;
+			bool isOutput = false;
+
+			// Created by the graph, placed when compiled
+			bool isTransient = false;
+			TransientTextureDesc transientDesc;
+			const TransientTexture* pTransientTexture = nullptr;
+		};
+
+		struct Access {
+			RenderGraphResource resource;
+			Transition transition;
+			bool isRead;
+			bool isWrite;
+		};
+
+		struct Pass {
+			std::string name;
+			RenderGraphQueue queue;
+			std::vector<Access> accesses;
+			// Never culled
+			bool hasSideEffects = false;
+			// Never culled and no pass is moved across it
+			bool isOrdered = false;
+			ExecuteFunction execute;
+
+			// Set by compile
+			bool isCulled = false;
+			std::vector<TextureBarrier> textureBarriers;
+			std::vector<BufferBarrier> bufferBarriers;
+		};
+
+		std::vector<Resource> m_resources;
+		std::vector<Pass> m_passes;
+		std::vector<uint32_t> m_executionOrder;
+
+		// Imported resources by their GPU object, so layers importing the same texture share the state tracking
+		std::map<std::tuple<const void*, uint32_t, uint32_t>, RenderGraphResource> m_importedTextures;
+		std::unordered_map<const void*, RenderGraphResource> m_importedBuffers;
+		std::unordered_map<std::string, RenderGraphResource> m_namedResources;
+
+		bool m_isCompiled;
+		uint32_t m_barrierCount;
+
+		void sortPasses();
+		void cullPasses();
+		void allocateTransientTextures();
+		void planBarriers();
+
+	public:
+		class PassBuilder {
+		private:
+			friend class RenderGraph;
+			RenderGraph* m_pGraph;
+			Pass* m_pPass;
+
+			PassBuilder(RenderGraph* pGraph, Pass* pPass);
+		public:
+			RenderGraphResource read(RenderGraphResource resource, Transition transition);
+			RenderGraphResource write(RenderGraphResource resource, Transition transition);
+			// The pass is never culled
+			void setSideEffects();
+		};
+
+		RenderGraph();
+
+		// currentState is the state the resource is in before the graph executes
+		RenderGraphResource importTexture(const std::string& name, const Texture& texture, Transition currentState);
+		RenderGraphResource importBuffer(const std::string& name, const Buffer& buffer, Transition currentState);
+		// A texture that only lives within the graph. Its memory is shared with transient textures of passes
+		// that are not alive at the same time and of every other graph executed in the frame.
+		RenderGraphResource createTexture(const std::string& name, const TransientTextureDesc& desc);
+		// RENDER_GRAPH_INVALID_RESOURCE if nothing was imported or created with this name
+		RenderGraphResource getResource(const std::string& name) const;
+
+		// Valid once compiled, for passes that were not culled
+		const Texture& getTexture(RenderGraphResource resource) const;
+		const std::vector<Texture>& getMipLevelTextures(RenderGraphResource resource) const;
+
+		// Output resources and everything they depend on are kept when culling
+		void markOutput(RenderGraphResource resource);
+
+		void addPass(const std::string& name, RenderGraphQueue queue, const std::function<void(PassBuilder&)>& setup, const ExecuteFunction& execute);
+		// A pass that declares nothing, for render layers that do their own synchronization.
+		// It is never culled and nothing is moved across it.
+		void addOrderedPass(const std::string& name, const ExecuteFunction& execute);
+
+		void compile();
+		// Returns false if a pass failed, the remaining passes are skipped
+		bool execute(RenderContext& context);
+
+		void clear();
+
+		uint32_t getPassCount() const;
+		uint32_t getCulledPassCount() const;
+		// Barriers recorded by execute, merged per pass
+		uint32_t getBarrierCount() const;
+
+	};
+
+}
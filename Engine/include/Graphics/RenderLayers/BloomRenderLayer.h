@@ -3,6 +3,11 @@
 
 #include "Tools/Profiler.h"
 
+// Should match BLOOM_MIP_COUNT in BloomDownsample.comp
+#define BLOOM_MIP_COUNT 6U
+// Texels of mip 0 filtered by each workgroup of the downsampler, should match TILE_SIZE in BloomDownsample.comp
+#define BLOOM_DOWNSAMPLE_TILE_SIZE 32U
+
 namespace sa {
 
 	
@@ -19,26 +24,48 @@ namespace sa {
 		alignas(16) TonemapPreferences tonemapPreferences = {};
 	};
 	
+	struct BloomDownsamplePushConstants {
+		glm::uvec2 renderExtent;
+		uint32_t counterIndex;
+	};
+
+	struct BloomPushConstants {
+		glm::uvec2 renderExtent;
+		int32_t mode;
+		// Bloom level written by the upsample
+		int32_t level;
+	};
+
 	struct BloomData {
 		bool isInitialized = false;
+		// The mip chains are only owned when rendering outside of a render graph, the graph places them in transient memory
+		bool hasScratchTextures = false;
 
-		ResourceID filterDescriptorSet = NULL_RESOURCE;
-		std::vector<ResourceID> blurDescriptorSets;
+		ResourceID downsampleDescriptorSet = NULL_RESOURCE;
 		std::vector<ResourceID> upsampleDescriptorSets;
 		ResourceID compositeDescriptorSet = NULL_RESOURCE;
 
 		DynamicTexture bloomTexture;
 		std::vector<DynamicTexture> bloomMipTextures;
 
+		// Upsampled chain, mip i holds bloom level i + 1. Level 0 is merged into the composite pass
 		DynamicTexture bufferTexture;
 		std::vector<DynamicTexture> bufferMipTextures;
 
 		DynamicTexture outputTexture;
 
+		// One counter per frame in flight, used by the single pass downsampler to find the last workgroup
+		Buffer atomicCounterBuffer;
+
 	};
 
 	class BloomRenderLayer : public IRenderLayer<BloomData, BloomPreferences>{
 	private:
+		Shader m_downsampleShader;
+		PipelineLayout m_downsamplePipelineLayout;
+		ResourceID m_downsamplePipeline = NULL_RESOURCE;
+		ResourceID m_downsamplePreferencesDescriptorSet = NULL_RESOURCE;
+
 		Shader m_bloomShader;
 		PipelineLayout m_pipelineLayout;
 		ResourceID m_bloomPipeline = NULL_RESOURCE;
@@ -47,23 +74,35 @@ namespace sa {
 		ResourceID m_bloomPreferencesDescriptorSet = NULL_RESOURCE;
 		
 		ResourceID m_sampler = NULL_RESOURCE;
+		ResourceID m_linearSampler = NULL_RESOURCE;
 
-		Extent m_threadCountStack[7];
-		uint8_t m_stackSize = 0;
-		
-
-		void initializeBloomData(const UUID& renderTargetID, RenderContext& context, Extent extent, const DynamicTexture* colorTexture);
+		void initializeBloomData(const UUID& renderTargetID, RenderContext& context, Extent extent, const DynamicTexture* colorTexture, bool createScratchTextures);
 		void cleanupBloomData(const UUID& renderTargetID);
+		// Initializes and syncs the data of the render target, false if there is no color to read
+		bool prepareBloomData(RenderContext& context, RenderTarget* pRenderTarget, bool useScratchTextures);
+		Extent getBloomExtent(Extent colorExtent) const;
+		TransientTextureDesc getBloomTextureDesc(Extent extent) const;
+		TransientTextureDesc getBufferTextureDesc(Extent extent) const;
+
+		// Points the descriptor sets of this frame at the mip chains in use
+		void updateDescriptorSets(RenderContext& context, BloomData& bd, const Texture& colorTexture, const std::vector<Texture>& bloomMipTextures, const std::vector<Texture>& bufferMipTextures);
+
+		void downsample(RenderContext& context, const BloomData& bd, Extent renderExtent);
+		void upsample(RenderContext& context, const BloomData& bd, const std::vector<Texture>& bufferMipTextures, Extent renderExtent);
+		void composite(RenderContext& context, const BloomData& bd, Extent outputExtent);
 
 	public:
 
 		virtual void init() override;
 		virtual void cleanup() override;
 
+		virtual const char* getName() const override;
+
 		virtual void onRenderTargetResize(UUID renderTargetID, Extent oldExtent, Extent newExtent) override;
 		virtual void onPreferencesUpdated() override;
 
 
+		virtual bool addRenderPasses(RenderGraph& graph, const std::string& name, RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) override;
 		virtual bool render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) override;
 		virtual bool postRender(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) override;
 
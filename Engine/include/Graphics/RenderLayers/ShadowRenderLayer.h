@@ -25,6 +25,11 @@ namespace sa {
 		DynamicTexture depthTexture;
 		std::array<DynamicTexture, ShadowPreferences::MaxCascadeCount> depthTextureLayers;
 		std::array<ResourceID, ShadowPreferences::MaxCascadeCount> depthFramebuffers;
+		// Secondary contexts, one per layer. Every render of the data within a frame records into its own set, so a
+		// second camera rendering the same light does not re-record buffers the first camera already executed
+		std::vector<std::array<SubContext, ShadowPreferences::MaxCascadeCount>> layerContextSets;
+		uint32_t usedLayerContextSets = 0;
+		uint32_t layerCount = 0;
 		LightType lightType;
 		bool isInitialized = false;
 
@@ -64,6 +69,11 @@ namespace sa {
 
 		std::unordered_map<UUID, MaterialShadowPipeline> m_materialShaderPipelines;
 
+		// Layers of a shadow map are recorded in parallel, each layer index owns a context pool
+		// so that no two workers record into buffers from the same pool.
+		std::array<ResourceID, ShadowPreferences::MaxCascadeCount> m_contextPools;
+		bool m_hasContextPools = false;
+
 		void createSampler();
 
 		void initMaterialShadowPipeline(MaterialShader* pMaterialShader, MaterialShadowPipeline& data);
@@ -71,21 +81,22 @@ namespace sa {
 		void cleanupRenderData(ShadowRenderData& data);
 		void initializeRenderData(ShadowRenderData& data, LightType lightType);
 
-		void renderMaterialCollection(RenderContext& context, MaterialShaderCollection& collection, ShadowData& data, const ShadowRenderData& renderData, uint32_t layer);
+		size_t renderMaterialCollection(RenderContext& context, MaterialShaderCollection& collection, const ShadowData& data, const ShadowRenderData& renderData, uint32_t layer);
+		void renderShadowLayers(RenderContext& context, const ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection, uint32_t layerCount);
 
 		// Directional lights
 		void updateCascadeSplits(float near, float far);
 		void calculateCascadeMatrices(const SceneCamera& sceneCamera, ShadowData& data);
-		void renderCascadedShadowMaps(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection);
+		void renderCascadedShadowMaps(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection);
 
 		// Point lights
-		void renderCubeMapShadows(RenderContext& context, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection);
+		void renderCubeMapShadows(RenderContext& context, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection);
 
 		// Spot lights
-		void renderSingleDirectedShadow(RenderContext& context, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection);
+		void renderSingleDirectedShadow(RenderContext& context, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection);
 
 
-		void renderShadowMap(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection);
+		void renderShadowMap(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection);
 		
 		void renderShadowMap(
 			RenderContext& context,
@@ -101,6 +112,8 @@ namespace sa {
 		virtual void init() override;
 		virtual void cleanup() override;
 
+		virtual const char* getName() const override;
+
 		virtual void onRenderTargetResize(UUID renderTargetID, Extent oldExtent, Extent newExtent) override;
 		virtual void onPreferencesUpdated() override;
 
@@ -2,13 +2,25 @@
 
 #include "IRenderTechnique.h"
 #include "IRenderLayer.h"
+#include "RenderGraph.h"
 #include "Tools/Profiler.h"
 
 namespace sa {
 
 	class RenderPipeline {
 	private:
+		// GPU timestamp scope names, built once per layer
+		struct LayerScopeNames {
+			std::string preRender;
+			std::string render;
+			std::string postRender;
+		};
+
 		std::vector<BasicRenderLayer*> m_renderLayers;
+		std::vector<LayerScopeNames> m_layerScopeNames;
+
+		// Rebuilt for every render target every frame, kept to reuse its allocations
+		RenderGraph m_renderGraph;
 		
 	public:
 		RenderPipeline();
@@ -4,6 +4,7 @@
 #include <RenderWindow.hpp>
 #include "Assets\Asset.h"
 #include "ECS/Events.h"
+#include "DynamicResolution.h"
 
 namespace sa {
 
@@ -19,6 +20,8 @@ namespace sa {
 		Extent m_extent;
 		bool m_wasResized;
 
+		DynamicResolution m_dynamicResolution;
+
 		entt::connection m_windowResizedConnection;
 
 		Transition m_lastTransition;
@@ -46,6 +49,13 @@ namespace sa {
 		void makeSampleReady(const RenderContext& context);
 
 		const Extent& getExtent() const;
+		// Extent the scene is rendered at, the top left part of the textures allocated at getExtent()
+		Extent getRenderExtent() const;
+		// Part of the output texture that holds the rendered image, in texture coordinates
+		glm::vec2 getOutputUVScale() const;
+
+		DynamicResolution& getDynamicResolution();
+		const DynamicResolution& getDynamicResolution() const;
 
 		const DynamicTexture* getOutputTextureDynamic() const;
 		const Texture& getOutputTexture() const;
@@ -2,6 +2,7 @@
 
 #include "Assets/ModelAsset.h"
 #include "Graphics/IRenderLayer.h"
+#include "structs.h"
 
 #include "Resources/DynamicTexture.hpp"
 #include "Resources/DynamicBuffer.hpp"
@@ -13,6 +14,11 @@
 #define TILE_SIZE 16U
 #define MAX_LIGHTS_PER_TILE 1024
 
+#define OCCLUSION_CULLING_GROUP_SIZE 64U
+// Should match the phases in OcclusionCulling.comp
+#define OCCLUSION_CULLING_PHASE_VISIBLE_LAST_FRAME 0U
+#define OCCLUSION_CULLING_PHASE_HIZ 1U
+
 
 namespace sa {
 
@@ -29,19 +35,54 @@ namespace sa {
 		// Light culling
 		glm::uvec2 tileCount;
 		DynamicBuffer lightIndexBuffer;
+		DynamicBuffer tileLightCountBuffer;
 		ResourceID lightCullingDescriptorSet = NULL_RESOURCE;
 
+		DynamicBuffer tileFrustumBuffer;
+		// Projection and rendered extent each copy of the tile frustums was built from
+		std::vector<glm::mat4> tileFrustumProjections;
+		std::vector<glm::uvec2> tileFrustumScreenSizes;
+		ResourceID tileFrustumDescriptorSet = NULL_RESOURCE;
+
+		DynamicBuffer lightBoundsBuffer;
+		ResourceID lightBoundsDescriptorSet = NULL_RESOURCE;
+
 		DynamicTexture debugLightHeatmap;
 		ResourceID debugLightHeatmapFramebuffer = NULL_RESOURCE;
 		ResourceID debugLightHeatmapDescriptorSet = NULL_RESOURCE;
 		bool renderDebugHeatmap = false;
 
+		// Occlusion culling
+		DynamicTexture hiZTexture;
+		std::vector<DynamicTexture> hiZMipTextures;
+
 
 		bool isInitialized = false;
 	};
 
 	struct ForwardPlusPreferences {
-		
+		bool occlusionCulling = true;
+	};
+
+	struct TileFrustumPushConstants {
+		glm::mat4 inverseProjection;
+		glm::uvec2 screenSize;
+		glm::uvec2 tileCount;
+	};
+
+	struct LightCullingPushConstants {
+		glm::vec4 depthUnproject;
+		uint32_t lightCount;
+		uint32_t tileCountX;
+		glm::uvec2 screenSize;
+	};
+
+	struct OcclusionCullingPushConstants {
+		glm::mat4 viewProjection;
+		glm::vec4 viewport;
+		uint32_t objectCount;
+		uint32_t drawCommandCount;
+		uint32_t phase;
 	};
 
 	class ForwardPlus : public IRenderLayer<ForwardPlusRenderData, ForwardPlusPreferences> {
@@ -52,11 +93,35 @@ namespace sa {
 		ResourceID m_nearestSampler = NULL_RESOURCE;
 
 		ResourceID m_depthPreRenderProgram = NULL_RESOURCE;
+		// Draws the objects found by the second culling phase on top of the first prepass
+		ResourceID m_depthPreLoadRenderProgram = NULL_RESOURCE;
 		ResourceID m_lightCullingPipeline = NULL_RESOURCE;
 
 		PipelineLayout m_lightCullingLayout;
 		Shader m_lightCullingShader;
 
+		PipelineLayout m_tileFrustumLayout;
+		Shader m_tileFrustumShader;
+		ResourceID m_tileFrustumPipeline = NULL_RESOURCE;
+
+		PipelineLayout m_lightBoundsLayout;
+		Shader m_lightBoundsShader;
+		ResourceID m_lightBoundsPipeline = NULL_RESOURCE;
+
+		PipelineLayout m_hiZReduceLayout;
+		Shader m_hiZReduceShader;
+		ResourceID m_hiZReducePipeline = NULL_RESOURCE;
+
+		PipelineLayout m_occlusionCullingLayout;
+		Shader m_occlusionCullingShader;
+		ResourceID m_occlusionCullingPipeline = NULL_RESOURCE;
+
+		// Bindless texture table shared by every material shader, the set is only written when the table changed
+		PipelineLayout m_textureTableLayout;
+		ResourceID m_textureTableDescriptorSet = NULL_RESOURCE;
+		// Table revision each copy of the set was last written with
+		std::vector<uint64_t> m_textureTableRevisions;
+
 		PipelineLayout m_debugHeatmapLayout;
 		Shader m_debugHeatmapVertexShader;
 		Shader m_debugHeatmapFragmentShader;
@@ -80,14 +145,24 @@ namespace sa {
 
 		void createPreDepthPass();
 		void createLightCullingShader();
+		void createOcclusionCullingShaders();
 		void createColorPass();
+		void createTextureTable();
 
 		void createSkyboxPipeline();
 
 		void initializeMainRenderData(ForwardPlusRenderData& data, Extent extent);
 		void cleanupMainRenderData(ForwardPlusRenderData& data);
 
-		void bindShadows(const RenderContext& context, const SceneCollection& sc, const MaterialShaderCollection& collection);
+		void bindShadows(const RenderContext& context, const SceneCollection& sc, ResourceID descriptorSet);
+		void updateTextureTable(const RenderContext& context);
+
+		void buildHiZ(RenderContext& context, ForwardPlusRenderData& data);
+		void cullObjects(RenderContext& context, ForwardPlusRenderData& data, MaterialShaderCollection& collection, const OcclusionCullingPushConstants& pushConstants);
+		void renderDepthPrepass(RenderContext& context, ResourceID renderProgram, ForwardPlusRenderData& data, RenderTarget* pRenderTarget, SceneCollection& sc, InstanceList instanceList, const PerFrameBuffer& perFrame, const Rect& viewport);
+		void drawCollection(const RenderContext& context, const MaterialShaderCollection& collection, InstanceList instanceList);
+
+		void cullLights(RenderContext& context, ForwardPlusRenderData& data, SceneCamera* pCamera, SceneCollection& sc, Extent renderExtent);
 
 	public:
 
@@ -98,9 +173,16 @@ namespace sa {
 		virtual void init() override;
 		virtual void cleanup() override;
 
+		virtual const char* getName() const override;
+
+		virtual bool addRenderPasses(RenderGraph& graph, const std::string& name, RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) override;
+		// Builds and executes a graph of only this layer
 		virtual bool render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) override;
 		virtual bool postRender(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) override;
 
+		// Lights found in a tile by the last finished light culling pass, for debugging
+		uint32_t getTileLightCount(const UUID& renderTargetID, glm::uvec2 tile);
+
 	};
 }
 
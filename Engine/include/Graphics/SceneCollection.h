@@ -9,6 +9,7 @@
 
 
 #define MAX_SHADOW_TEXTURE_COUNT 8u
+#define INSTANCE_LIST_COUNT 4u
 
 
 namespace sa {
@@ -19,6 +20,22 @@ namespace sa {
 		bool operator==(const ObjectData&) const = default;
 	};
 	
+	// World space bounds and draw commands of an object, read by the occlusion culling shader
+	struct alignas(16) ObjectCullData {
+		glm::vec4 boundingSphere; // xyz center, w radius
+		uint32_t firstCommand;
+		uint32_t commandCount;
+	};
+
+	// Regions of the instance index buffer. Every region holds one index per object,
+	// the culled regions are filled by the culling passes and drawn with the culled draw commands.
+	enum class InstanceList : uint32_t {
+		ALL,
+		VISIBLE_LAST_FRAME,	// phase 1, visible last frame and inside the frustum
+		NEWLY_VISIBLE,		// phase 2, passed the Hi-Z test but was not drawn in phase 1
+		VISIBLE,			// phase 2, every object that passed the Hi-Z test
+	};
+	
 	struct ShadowData {
 		entt::entity entityID;
 		glm::vec4 lightPosition;
@@ -35,15 +52,33 @@ namespace sa {
 
 	class MaterialShaderCollection {
 	private:
+		// One instanced indirect draw, every object using the model draws the mesh
+		struct DrawGroup {
+			const ModelAsset* pModelAsset;
+			// A model reloaded in place keeps its pointer, so the data is compared by revision
+			uint64_t modelRevision;
+			uint32_t meshIndex;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+			bool operator==(const DrawGroup&) const = default;
+		};
 		
 		std::vector<ModelAsset*> m_models;
 		std::vector<std::vector<uint32_t>> m_meshes;
 
 		std::vector<std::vector<Entity>> m_objects;
-		std::vector<Texture> m_textures;
 		std::vector<Material*> m_materials;
 		std::vector<Material::Values> m_materialData;
 		std::vector<uint32_t> m_materialIndices;
+		// Material values and indices the material buffers were last written with, per buffer in flight
+		std::vector<std::vector<Material::Values>> m_writtenMaterialData;
+		std::vector<std::vector<uint32_t>> m_writtenMaterialIndices;
+		struct BoundingSphere {
+			uint64_t modelRevision;
+			glm::vec4 sphere;
+		};
+		// Model space bounding spheres, computed once per revision of the model data
+		std::unordered_map<const ModelAsset*, BoundingSphere> m_boundingSpheres;
 
 
 		// These could expand
@@ -54,21 +89,35 @@ namespace sa {
 		DynamicBuffer m_materialBuffer;
 		DynamicBuffer m_materialIndicesBuffer;
 
+		// Occlusion culling
+		DynamicBuffer m_instanceIndexBuffer;
+		DynamicBuffer m_cullDataBuffer;
+		DynamicBuffer m_culledDrawCommandBuffer;
+		DynamicBuffer m_visibilityBuffer;
+
 		uint32_t m_objectCount = 0;
 		uint32_t m_vertexCount = 0;
 		uint32_t m_indexCount = 0;
 		uint32_t m_uniqueMeshCount = 0;
+		size_t m_triangleCount = 0;
+		// Objects drawn by the draw command buffer, objects of models still loading are not included
+		uint32_t m_instanceCount = 0;
+
+		std::vector<DrawGroup> m_drawGroups;
+		// Groups the geometry and draw commands were last built from, per buffer in flight
+		std::vector<std::vector<DrawGroup>> m_builtDrawGroups;
 
 
 		UUID m_materialShaderID;
 
-		ResourceID m_sceneDescriptorSetColorPass = NULL_RESOURCE;
 		ResourceID m_sceneDescriptorSetDepthPass = NULL_RESOURCE;
 
 		Extent m_currentExtent;
 
 		bool m_updatedDescriptorSets;
 
+		const glm::vec4& getBoundingSphere(const ModelAsset* pModelAsset);
+
 	public:
 
 		MaterialShaderCollection(MaterialShader* pMaterialShader);
@@ -100,10 +149,23 @@ namespace sa {
 		const Buffer& getObjectBuffer() const;
 		const Buffer& getMaterialBuffer() const;
 		const Buffer& getMaterialIndicesBuffer() const;
-
-		const std::vector<Texture>& getTextures() const;
-
-		ResourceID getSceneDescriptorSetColorPass() const;
+		// Triangles drawn by the draw command buffer, all instances included
+		size_t getTriangleCount() const;
+
+		uint32_t getInstanceCount() const;
+		const Buffer& getInstanceIndexBuffer() const;
+		const Buffer& getCullDataBuffer() const;
+		// One draw command per mesh for each of the culled instance lists, instance counts are written by the culling passes
+		const Buffer& getCulledDrawCommandBuffer() const;
+		// Byte offset of the draw commands drawing an instance list
+		uint32_t getCulledDrawCommandOffset(InstanceList list) const;
+		// One flag per object, written by the second culling phase and read by the first phase of the next frame
+		const Buffer& getVisibilityBuffer() const;
+		const Buffer& getPreviousVisibilityBuffer();
+
+		// Allocates a set for one color pass with the collection's buffers written, the pass fills in the rest.
+		// The set is only valid for the current frame
+		ResourceID allocateSceneDescriptorSetColorPass(RenderContext& context) const;
 		ResourceID getSceneDescriptorSetDepthPass() const;
 
 		MaterialShader* getMaterialShader() const;
@@ -123,6 +185,7 @@ namespace sa {
 
 		// These could expand
 		DynamicBuffer m_lightBuffer;
+		uint32_t m_lightCount = 0;
 
 		std::vector<MaterialShaderCollection> m_materialShaderCollections;
 		
@@ -188,6 +251,8 @@ namespace sa {
 		void swap();
 
 		const Buffer& getLightBuffer() const;
+		// Lights in the light buffer
+		uint32_t getLightCount() const;
 
 		std::vector<ShadowData>::iterator iterateShadowsBegin();
 		std::vector<ShadowData>::iterator iterateShadowsEnd();
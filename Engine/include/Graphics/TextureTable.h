@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Resources/Texture.hpp>
+#include <DescriptorSetStructs.h>
+
+#define TEXTURE_TABLE_CAPACITY MAX_VARIABLE_DESCRIPTOR_COUNT
+#define TEXTURE_TABLE_DEFAULT_SLOT 0U
+// Frames a retired texture is kept alive. The table is written to one frame in flight at a time,
+// so the old image is bound until every frame in flight has picked up the change and finished
+#define TEXTURE_TABLE_RETIRE_FRAMES 3U
+
+namespace sa {
+
+	// Global bindless texture table. Every loaded texture gets a stable slot that shaders index directly,
+	// slot 0 always holds the default white texture.
+	class TextureTable {
+	private:
+		std::vector<Texture> m_pendingTextures;
+		std::vector<Texture> m_textures;
+		std::vector<uint32_t> m_freeSlots;
+		bool m_isDirty;
+		uint64_t m_revision;
+
+		struct RetiredTexture {
+			Texture texture;
+			uint64_t frame;
+		};
+		std::vector<RetiredTexture> m_retiredTextures;
+		uint64_t m_frameCount;
+
+		mutable std::mutex m_mutex;
+
+		TextureTable();
+	public:
+		static TextureTable& Get();
+
+		// Thread safe, returns TEXTURE_TABLE_DEFAULT_SLOT if the table is full
+		uint32_t insert(const Texture& texture);
+		void update(uint32_t slot, const Texture& texture);
+		void remove(uint32_t slot);
+		// Thread safe, destroys the texture once no frame in flight can have it bound anymore
+		void retire(const Texture& texture);
+
+		// Call from the render thread once per frame, destroys textures retired long enough ago
+		void beginFrame();
+
+		// Call from the render thread only, picks up changes made since last call
+		const std::vector<Texture>& getTextures();
+		// Bumped whenever getTextures picks up a change
+		uint64_t getRevision() const;
+
+		void clear();
+	};
+
+}
@@ -5,11 +5,13 @@
 #include <Resources\Texture.hpp>
 #include <RenderWindow.hpp>
 
+#include "RenderTarget.h"
+
 namespace sa {
 	class IWindowRenderer {
 	public:
 		virtual ~IWindowRenderer();
-		virtual void render(RenderContext& context, const Texture& texture) = 0;		
+		virtual void render(RenderContext& context, const RenderTarget& renderTarget) = 0;
 		virtual void onWindowResize(Extent newExtent) = 0;
 	};
 
@@ -28,13 +30,16 @@ namespace sa {
 		ResourceID m_swapchainDescriptorSet;
 		ResourceID m_sampler;
 
-
-		
+		struct PushConstants {
+			glm::vec2 uvScale;
+			float sharpness;
+		};
 
 	public:		
 		WindowRenderer(RenderWindow* pWindow);
 
-		virtual void render(RenderContext& context, const Texture& texture) override;
+		// Upscales the rendered part of the output texture to the window, sharpened when it is scaled
+		virtual void render(RenderContext& context, const RenderTarget& renderTarget) override;
 		void onWindowResize(Extent newExtent) override;
 
 	};
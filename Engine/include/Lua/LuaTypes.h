@@ -327,6 +327,21 @@ namespace sa {
 		return true;
 	}
 
+	// Each hit becomes { entity, position, normal, distance }
+	inline sol::table QueryHitsToTable(Scene& scene, const PhysicsQueryBatch& batch, const QueryResult& result) {
+		auto& lua = LuaAccessable::getState();
+		sol::table hits = lua.create_table(result.hitCount, 0);
+		const QueryHit* pHits = batch.getHits(result);
+		for (uint32_t i = 0; i < result.hitCount; i++) {
+			hits[i + 1] = lua.create_table_with(
+				"entity", Entity(&scene, pHits[i].entity),
+				"position", pHits[i].position,
+				"normal", pHits[i].normal,
+				"distance", pHits[i].distance);
+		}
+		return hits;
+	}
+
 	template<>
 	inline bool LuaAccessable::registerType<Scene>() {
 		auto type = userType<Scene>("Scene",
@@ -355,6 +370,88 @@ namespace sa {
 
 		};
 
+		// Physics queries, every function returns a table of hits sorted by distance
+		type["raycast"] = [](Scene& self, const Vector3& origin, const Vector3& direction, sol::optional<float> maxDistance, sol::optional<uint32_t> maxHits, sol::optional<Entity> ignored) {
+			RaycastQuery query;
+			query.origin = origin;
+			query.direction = direction;
+			query.maxDistance = maxDistance.value_or(query.maxDistance);
+			query.maxHits = maxHits.value_or(query.maxHits);
+			if (ignored)
+				query.filter.ignoredEntity = ignored.value();
+
+			PhysicsQueryBatch batch;
+			batch.addRaycast(query);
+			self.executeQueries(batch);
+			return QueryHitsToTable(self, batch, batch.getRaycastResults()[0]);
+		};
+
+		// Takes an array of { origin, direction, maxDistance, maxHits, ignore } and returns an array of hit tables in the same order
+		type["raycastBatch"] = [](Scene& self, const sol::table& rays) {
+			PhysicsQueryBatch batch;
+			for (size_t i = 1; i <= rays.size(); i++) {
+				const sol::table ray = rays[i];
+				RaycastQuery query;
+				query.origin = ray["origin"].get<Vector3>();
+				query.direction = ray["direction"].get<Vector3>();
+				query.maxDistance = ray["maxDistance"].get_or(query.maxDistance);
+				query.maxHits = ray["maxHits"].get_or(query.maxHits);
+				sol::optional<Entity> ignored = ray["ignore"];
+				if (ignored)
+					query.filter.ignoredEntity = ignored.value();
+				batch.addRaycast(query);
+			}
+			self.executeQueries(batch, true);
+
+			const auto& results = batch.getRaycastResults();
+			sol::table hitTables = getState().create_table(results.size(), 0);
+			for (size_t i = 0; i < results.size(); i++) {
+				hitTables[i + 1] = QueryHitsToTable(self, batch, results[i]);
+			}
+			return hitTables;
+		};
+
+		type["sweepSphere"] = [](Scene& self, const Vector3& origin, float radius, const Vector3& direction, sol::optional<float> maxDistance, sol::optional<uint32_t> maxHits) {
+			SweepQuery query;
+			query.shape.type = QueryShapeType::SPHERE;
+			query.shape.radius = radius;
+			query.origin = origin;
+			query.direction = direction;
+			query.maxDistance = maxDistance.value_or(query.maxDistance);
+			query.maxHits = maxHits.value_or(query.maxHits);
+
+			PhysicsQueryBatch batch;
+			batch.addSweep(query);
+			self.executeQueries(batch);
+			return QueryHitsToTable(self, batch, batch.getSweepResults()[0]);
+		};
+
+		type["overlapSphere"] = [](Scene& self, const Vector3& position, float radius, sol::optional<uint32_t> maxHits) {
+			OverlapQuery query;
+			query.shape.type = QueryShapeType::SPHERE;
+			query.shape.radius = radius;
+			query.position = position;
+			query.maxHits = maxHits.value_or(query.maxHits);
+
+			PhysicsQueryBatch batch;
+			batch.addOverlap(query);
+			self.executeQueries(batch);
+			return QueryHitsToTable(self, batch, batch.getOverlapResults()[0]);
+		};
+
+		type["overlapBox"] = [](Scene& self, const Vector3& position, const Vector3& halfExtents, sol::optional<uint32_t> maxHits) {
+			OverlapQuery query;
+			query.shape.type = QueryShapeType::BOX;
+			query.shape.halfExtents = halfExtents;
+			query.position = position;
+			query.maxHits = maxHits.value_or(query.maxHits);
+
+			PhysicsQueryBatch batch;
+			batch.addOverlap(query);
+			self.executeQueries(batch);
+			return QueryHitsToTable(self, batch, batch.getOverlapResults()[0]);
+		};
+
 		return true;
 	}
 
@@ -13,6 +13,7 @@
 #include <filesystem>
 
 #include "ECS/Entity.h"
+#include "ECS/Events.h"
 #include "EntityScript.h"
 
 namespace sa {
@@ -37,6 +38,14 @@ namespace sa {
 		void setComponents(const entt::entity& entity, sol::environment& env, std::vector<ComponentType>& components);
 			
 		void connectCallbacks(EntityScript* pScript);
+
+		// Event tables of one batch per entity, entities without a script listening for the event get an invalid table
+		using EventTables = std::unordered_map<entt::entity, sol::table>;
+		sol::table* getEventTable(EventTables& tables, entt::entity entity, const char* callbackName);
+		void callEventTables(const EventTables& tables, const char* callbackName);
+
+		void onContacts(const scene_event::Contacts& e);
+		void onTriggers(const scene_event::Triggers& e);
 		/*
 		template<typename Event, typename ...Args>
 		std::optional<entt::emitter<Scene>::connection<Event>> callback(EntityScript* pScript, Args&&...);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <task/PxCpuDispatcher.h>
+
+namespace sa {
+
+	// Runs PhysX tasks on a taskflow executor, so physics shares its workers with the rest of the engine
+	// instead of starting threads of its own
+	class PhysicsCpuDispatcher : public physx::PxCpuDispatcher {
+	private:
+		tf::Executor& m_executor;
+		std::atomic_uint32_t m_workerCount;
+
+	public:
+		// A worker count of 0 uses all workers of the executor
+		PhysicsCpuDispatcher(tf::Executor& executor, uint32_t workerCount = 0);
+
+		virtual void submitTask(physx::PxBaseTask& task) override;
+		virtual uint32_t getWorkerCount() const override;
+
+		// Number of tasks PhysX splits its work into, clamped to the workers of the executor
+		void setWorkerCount(uint32_t workerCount);
+	};
+
+}
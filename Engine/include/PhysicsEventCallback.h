@@ -0,0 +1,43 @@
+#pragma once
+
+#include <PxSimulationEventCallback.h>
+
+#include "ECS/Events.h"
+
+// Contact points read per touching pair, they are averaged into one record
+#define PHYSICS_MAX_CONTACT_POINTS 8U
+
+namespace sa {
+
+	// PhysX reports events from inside fetchResults. They are only copied into flat arrays here, the scene hands
+	// them out in bulk once the step is done and the components are safe to touch
+	class PhysicsEventCallback : public physx::PxSimulationEventCallback {
+	private:
+		std::vector<ContactRecord> m_contacts;
+		std::vector<TriggerRecord> m_triggers;
+		// Entities of the actors released since the last fetch. Removal reports still point at those actors, but
+		// a released actor can not be read from
+		std::unordered_map<const physx::PxActor*, entt::entity> m_releasedActors;
+
+		entt::entity getEntity(const physx::PxActor* pActor, bool mayBeReleased) const;
+
+	public:
+		virtual void onConstraintBreak(physx::PxConstraintInfo* pConstraints, physx::PxU32 count) override {}
+		virtual void onWake(physx::PxActor** ppActors, physx::PxU32 count) override {}
+		virtual void onSleep(physx::PxActor** ppActors, physx::PxU32 count) override {}
+		virtual void onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pPairs, physx::PxU32 pairCount) override;
+		virtual void onTrigger(physx::PxTriggerPair* pPairs, physx::PxU32 count) override;
+		virtual void onAdvance(const physx::PxRigidBody* const* ppBodies, const physx::PxTransform* pPoses, const physx::PxU32 count) override {}
+
+		std::vector<ContactRecord>& getContacts();
+		std::vector<TriggerRecord>& getTriggers();
+		// Keeps the capacity for the next steps
+		void clear();
+
+		// Has to be called before releasing an actor that may have touching pairs
+		void onActorReleased(const physx::PxActor* pActor);
+		// Called after fetchResults, every removal report of the released actors has been delivered by then
+		void clearReleasedActors();
+	};
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Tools/Vector.h"
+
+// Queries in a batch below this count are always executed on the calling thread
+#define PHYSICS_QUERY_MIN_PARALLEL_COUNT 64U
+
+namespace physx {
+	class PxScene;
+}
+
+namespace sa {
+
+	enum class QueryShapeType {
+		SPHERE,
+		BOX,
+		CAPSULE
+	};
+
+	struct QueryShape {
+		QueryShapeType type = QueryShapeType::SPHERE;
+		// Radius of spheres and capsules
+		float radius = 0.5f;
+		// Half extents of boxes, x is the half height of capsules
+		Vector3 halfExtents = Vector3(0.5f);
+	};
+
+	struct QueryFilter {
+		bool includeStatic = true;
+		bool includeDynamic = true;
+		// Matched against word0 of the query filter data of the shapes, all bits set disables the test
+		uint32_t layerMask = 0xFFFFFFFF;
+		// Hits on this entity are skipped, usually the entity asking
+		entt::entity ignoredEntity = entt::null;
+	};
+
+	struct RaycastQuery {
+		Vector3 origin = Vector3(0);
+		Vector3 direction = Vector3(0, 0, 1);
+		float maxDistance = 1000.0f;
+		// 1 reports the closest hit, more reports every hit up to the count sorted by distance
+		uint32_t maxHits = 1;
+		QueryFilter filter;
+	};
+
+	struct SweepQuery {
+		QueryShape shape;
+		Vector3 origin = Vector3(0);
+		glm::quat rotation = glm::quat_identity<float, glm::packed_highp>();
+		Vector3 direction = Vector3(0, 0, 1);
+		float maxDistance = 1000.0f;
+		uint32_t maxHits = 1;
+		QueryFilter filter;
+	};
+
+	struct OverlapQuery {
+		QueryShape shape;
+		Vector3 position = Vector3(0);
+		glm::quat rotation = glm::quat_identity<float, glm::packed_highp>();
+		uint32_t maxHits = 16;
+		QueryFilter filter;
+	};
+
+	struct QueryHit {
+		entt::entity entity = entt::null;
+		// Overlaps report the position of the entity and no normal
+		Vector3 position = Vector3(0);
+		Vector3 normal = Vector3(0);
+		float distance = 0.0f;
+	};
+
+	// Range of the hits of one query in the hit array of the batch
+	struct QueryResult {
+		uint32_t firstHit = 0;
+		uint32_t hitCount = 0;
+	};
+
+	// Collects raycasts, sweeps and overlaps and executes them together against a physics scene.
+	// Every query owns maxHits slots in one flat hit array, so queries can run on any thread without locking.
+	class PhysicsQueryBatch {
+	private:
+		std::vector<RaycastQuery> m_raycasts;
+		std::vector<SweepQuery> m_sweeps;
+		std::vector<OverlapQuery> m_overlaps;
+
+		std::vector<QueryResult> m_raycastResults;
+		std::vector<QueryResult> m_sweepResults;
+		std::vector<QueryResult> m_overlapResults;
+		std::vector<QueryHit> m_hits;
+
+		void prepareResults();
+		void executeQuery(physx::PxScene* pScene, uint32_t index);
+
+	public:
+		// Returns the index of the query in the results of its kind
+		uint32_t addRaycast(const RaycastQuery& query);
+		uint32_t addSweep(const SweepQuery& query);
+		uint32_t addOverlap(const OverlapQuery& query);
+
+		void clear();
+		uint32_t getQueryCount() const;
+
+		// The scene may be simulating, queries see the results of the last completed step
+		void execute(physx::PxScene* pScene, bool parallel = false);
+
+		const std::vector<QueryResult>& getRaycastResults() const;
+		const std::vector<QueryResult>& getSweepResults() const;
+		const std::vector<QueryResult>& getOverlapResults() const;
+
+		const QueryHit* getHits(const QueryResult& result) const;
+	};
+
+}
@@ -2,11 +2,17 @@
 
 #include <Tools/Vector.h>
 
+// Query filter word0 of created shapes, scene queries with a layer mask only hit shapes sharing a bit
+#define PHYSICS_DEFAULT_QUERY_LAYER 1U
+// Shape sizes and offsets are rounded to 1 / PHYSICS_SHAPE_KEY_PRECISION units when looking for a shape to share
+#define PHYSICS_SHAPE_KEY_PRECISION 1000.0f
+// Most actors PhysX allows in one aggregate, larger groups are split
+#define PHYSICS_MAX_AGGREGATE_SIZE 128U
+
 namespace physx {
 	class PxFoundation;
 	class PxPhysics;
 	class PxCpuDispatcher;
-	class PxDefaultCpuDispatcher;
 
 
 	class PxScene;
@@ -14,6 +20,7 @@ namespace physx {
 	class PxRigidActor;
 	class PxMaterial;
 	class PxShape;
+	class PxAggregate;
 	class PxGeometry;
 	class PxTransform;
 	class PxVec3;
@@ -23,18 +30,38 @@ namespace physx {
 }
 
 namespace sa {
+	class PhysicsCpuDispatcher;
+
+	struct ShapeKey {
+		uint32_t geometryType;
+		// Quantized half extents, radius or radius and half height
+		int32_t parameters[3];
+		int32_t offset[3];
+		physx::PxMaterial* pMaterial;
+		bool isTrigger;
+
+		bool operator==(const ShapeKey& other) const = default;
+	};
+
+	struct ShapeKeyHasher {
+		size_t operator()(const ShapeKey& key) const;
+	};
+
 	class PhysicsSystem {
 	private:
 		physx::PxFoundation* m_pFoundation;
 		physx::PxPhysics* m_pPhysics;
-		physx::PxDefaultCpuDispatcher* m_pCpuDispatcher;
+		PhysicsCpuDispatcher* m_pCpuDispatcher;
 
 		physx::PxPvd* m_pPvd;
 		physx::PxPvdTransport* m_pPvdTransport;
 
 		physx::PxMaterial* m_pDefaultMaterial;
 
-		std::unordered_map<size_t, physx::PxShape*> m_shapes;
+		// Holds one reference to every shared shape, dropped when no collider uses the shape anymore
+		std::unordered_map<ShapeKey, physx::PxShape*, ShapeKeyHasher> m_shapes;
+
+		static bool GetShapeKey(const physx::PxGeometry& geometry, physx::PxMaterial* pMaterial, const Vector3& offset, bool isTrigger, ShapeKey* pKey);
 
 		PhysicsSystem();
 	public:
@@ -45,11 +72,18 @@ namespace sa {
 
 		physx::PxScene* createScene();
 
+		// Number of workers of the shared task executor the simulation is split over, 0 uses all of them
+		void setWorkerCount(uint32_t workerCount);
+		uint32_t getWorkerCount() const;
+
 		physx::PxRigidActor* createRigidBody(bool isStatic, physx::PxTransform transform);
 		physx::PxMaterial* createMaterial(float staticFriction, float dynamicFriction, float restitution);
+		physx::PxAggregate* createAggregate(uint32_t maxActorCount, bool selfCollision);
 
-		physx::PxShape* createShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial = nullptr);
-		physx::PxShape* createExclusiveShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial = nullptr);
+		// Shapes with the same geometry, material, offset and trigger flag are shared. Every call holds a reference, given back with releaseShape
+		physx::PxShape* createShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial = nullptr, const Vector3& offset = Vector3(0), bool isTrigger = false);
+		physx::PxShape* createExclusiveShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial = nullptr, bool isTrigger = false);
+		void releaseShape(physx::PxShape* pShape);
 
 		static Vector3 toVector(physx::PxVec3 vec);
 		static physx::PxVec3 toPxVec(Vector3 vec);
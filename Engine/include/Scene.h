@@ -7,6 +7,8 @@
 #include "ECS\Components.h"
 
 #include "PhysicsSystem.h"
+#include "PhysicsEventCallback.h"
+#include "PhysicsQuery.h"
 
 #include <iostream>
 
@@ -24,6 +26,41 @@
 #include "Graphics/RenderPipeline.h"
 
 namespace sa {
+
+	struct PhysicsSettings {
+		// Seconds simulated per step
+		float fixedTimeStep = 1.0f / 60.0f;
+		// Steps per update at most, time beyond that is dropped so a frame spike can not stall the next frames
+		uint32_t maxSubSteps = 4;
+		// Transforms of moving bodies are interpolated between the last two steps by the time left over
+		bool interpolate = true;
+		// Bodies under one hierarchy root share broadphase entries, roots with a PhysicsAggregate component always do
+		bool aggregateHierarchies = true;
+		bool aggregateSelfCollision = false;
+	};
+
+	struct PhysicsAggregateGroup {
+		// Aggregates hold up to PHYSICS_MAX_AGGREGATE_SIZE actors, another one is added when all of them are full
+		std::vector<physx::PxAggregate*> aggregates;
+		bool selfCollision = false;
+	};
+
+	struct PhysicsStatistics {
+		// Steps completed since the scene was created
+		uint64_t stepCount = 0;
+		// Seconds the calling thread spent in simulate and fetchResults over all those steps
+		double totalStepTime = 0.0;
+		// The rest describe the last completed step
+		uint32_t activeActorCount = 0;
+		uint32_t activeDynamicBodyCount = 0;
+		// Shape pairs the broadphase passed on to the narrowphase
+		uint32_t broadphasePairCount = 0;
+		uint32_t newPairCount = 0;
+		uint32_t lostPairCount = 0;
+		// Seconds, excludes the time the step ran alongside the rest of the frame before it was fetched
+		float stepTime = 0.0f;
+	};
+
 	class Scene : public entt::dispatcher, public Serializable, public Asset {
 	private:
 		
@@ -33,12 +70,40 @@ namespace sa {
 
 		EntityHierarchy m_hierarchy;
 		
-		SceneCollection m_dynamicSceneCollection;
+		// Created on the first render, so scenes that are only simulated never touch the renderer
+		std::unique_ptr<SceneCollection> m_pDynamicSceneCollection;
 
 		bool m_runtime;
 
 		friend class comp::RigidBody;
 		physx::PxScene* m_pPhysicsScene;
+
+		PhysicsSettings m_physicsSettings;
+		float m_physicsAccumulator;
+		uint64_t m_physicsStepCount;
+		// Time spent in the simulate call of the running step, the fetch adds its own time to it
+		float m_physicsSimulateTime;
+		// Set between simulate and fetchResults, the physics scene may only be read or written while it is clear
+		bool m_isPhysicsSimulating;
+		// Bodies moved by the last step, their transforms are interpolated until the next step
+		std::vector<entt::entity> m_bodiesMovedInLastStep;
+		std::vector<physx::PxTransform> m_posesMovedInLastStep;
+		// Bodies whose transforms are written at the next sync
+		std::vector<entt::entity> m_bodiesToWrite;
+		PhysicsStatistics m_physicsStatistics;
+		// Contacts and triggers of the steps fetched since the last sync
+		PhysicsEventCallback m_physicsEvents;
+
+		// Keyed by the entity each group is rooted at
+		std::unordered_map<entt::entity, PhysicsAggregateGroup> m_physicsAggregateGroups;
+		// Group root of every aggregated body
+		std::unordered_map<entt::entity, entt::entity> m_aggregatedBodies;
+		// Hierarchy roots whose groups are updated before the next step
+		std::unordered_set<entt::entity> m_dirtyAggregateRoots;
+		// Bodies whose actor was created, replaced or released since the last step
+		std::vector<entt::entity> m_dirtyAggregateBodies;
+		// Every group is rebuilt before the next step
+		bool m_physicsAggregatesDirty;
 	
 		friend class Entity;
 		void destroyEntity(const Entity& entity);
@@ -58,7 +123,24 @@ namespace sa {
 		void registerComponentCallBacks();
 
 
-		void updatePhysics(float dt);
+		void pushEditedTransforms();
+		void simulatePhysicsStep(float step);
+		void fetchPhysicsStep();
+		void beginPhysicsStep(float dt);
+		void releasePhysicsAggregates();
+		void releasePhysicsAggregateGroup(entt::entity root);
+		void updatePhysicsAggregates();
+		// Moves the actor of the body into the group it belongs to now, groups it left are added to touchedRoots
+		void updateAggregatedBody(entt::entity entity, std::unordered_set<entt::entity>& touchedRoots);
+		// Outermost entity with a PhysicsAggregate above or at the entity, else the hierarchy root if that has children
+		entt::entity findAggregateRoot(const Entity& entity, bool* pSelfCollision) const;
+		Entity findHierarchyRoot(const Entity& entity) const;
+		// Has to be called when the actor of a body is created, replaced or released
+		void invalidatePhysicsBody(entt::entity entity);
+		void interpolateBodies(const std::vector<entt::entity>& bodies, float alpha);
+		void dispatchPhysicsEvents();
+		// Fetches the running step without writing transforms or sending events, that is left to the next sync
+		void waitForPhysicsStep();
 		void updateChildPositions();
 		void updateCameraPositions();
 		void updateLightPositions();
@@ -104,6 +186,25 @@ namespace sa {
 		// Hierarchy
 		EntityHierarchy& getHierarchy();
 
+		// Physics
+		const PhysicsSettings& getPhysicsSettings() const;
+		void setPhysicsSettings(const PhysicsSettings& settings);
+		// Waits for the running step, writes its results to the transforms and sends its contact and trigger events
+		void syncPhysics();
+		// Every aggregate is rebuilt before the next step
+		void invalidatePhysicsAggregates();
+		// Only the groups in the hierarchy of the entity are updated before the next step
+		void invalidatePhysicsAggregate(const Entity& entity);
+		// Poses, velocities, sleep state and kinematic targets of every rigid body, keyed by entity.
+		// Restoring only touches bodies that still exist, the rest of the scene is left as it is
+		void capturePhysicsState(ByteStream& dataOutStream);
+		void restorePhysicsState(ByteStream& dataInStream);
+		const PhysicsStatistics& getPhysicsStatistics() const;
+
+		// Scene queries, they see the results of the last completed step
+		void executeQueries(PhysicsQueryBatch& batch, bool parallel = false) const;
+		bool raycast(const Vector3& origin, const Vector3& direction, float maxDistance, QueryHit* pHit = nullptr, const QueryFilter& filter = {}) const;
+
 		
 		SceneCollection& getDynamicSceneCollection();
 
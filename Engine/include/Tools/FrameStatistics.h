@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <filesystem>
+#include <mutex>
+
+#define FRAME_STATISTICS_DEFAULT_CAPACITY 1024U
+
+namespace sa {
+
+	struct FrameRecord {
+		uint64_t frameNumber = 0;
+		// seconds
+		float cpuTime = 0.0f;
+		// seconds, lags one frame or more behind cpuTime since GPU results are resolved later.
+		// NaN when no new GPU result arrived this frame
+		float gpuTime = 0.0f;
+		size_t drawCalls = 0;
+		size_t triangleCount = 0;
+		size_t uploadCount = 0;
+		size_t allocationCount = 0;
+	};
+
+	enum class FrameMetric {
+		CPU_TIME,
+		GPU_TIME,
+		DRAW_CALLS,
+		TRIANGLES,
+		UPLOADS,
+		ALLOCATIONS
+	};
+
+	struct FramePercentiles {
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+	};
+
+	// Fixed capacity history of per frame measurements. The oldest frame is overwritten when full.
+	class FrameStatistics {
+	private:
+		std::vector<FrameRecord> m_frames;
+		size_t m_capacity;
+		size_t m_first;
+		size_t m_count;
+		uint64_t m_frameNumber;
+
+		// Named user counters, values are accumulated during a frame and moved to the history by recordFrame
+		std::vector<std::string> m_counterNames;
+		std::unordered_map<std::string, uint32_t> m_counterIndices;
+		std::vector<double> m_currentCounterValues;
+		// one ring per counter, indexed like m_frames
+		std::vector<std::vector<double>> m_counterHistory;
+
+		mutable std::mutex m_mutex;
+
+		size_t getRingIndex(size_t index) const;
+		uint32_t getOrRegisterCounter(const std::string& name);
+		float getValue(const FrameRecord& record, FrameMetric metric) const;
+
+	public:
+		FrameStatistics(size_t capacity = FRAME_STATISTICS_DEFAULT_CAPACITY);
+
+		// Discards the history
+		void setCapacity(size_t capacity);
+		size_t getCapacity() const;
+
+		// Fills in the frame number and snapshots the user counters for this frame
+		void recordFrame(FrameRecord record);
+		void clear();
+
+		// Number of frames in the history
+		size_t getFrameCount() const;
+		// index 0 is the oldest frame
+		FrameRecord getFrame(size_t index) const;
+		FrameRecord getLatestFrame() const;
+
+		FramePercentiles getPercentiles(FrameMetric metric) const;
+		FramePercentiles getCounterPercentiles(const std::string& name) const;
+
+		// Frame times in seconds bucketed over [0, maxTime), the last bucket also counts every frame above maxTime.
+		// Frames without a sample of the metric are left out here and in every query below
+		std::vector<uint32_t> getFrameTimeHistogram(uint32_t bucketCount, float maxTime, FrameMetric metric = FrameMetric::CPU_TIME) const;
+
+		// Values of the metric in chronological order, for plotting
+		std::vector<float> getValues(FrameMetric metric) const;
+
+		void addCounter(const std::string& name, double value);
+		void setCounter(const std::string& name, double value);
+		std::vector<std::string> getCounterNames() const;
+		std::vector<float> getCounterValues(const std::string& name) const;
+
+		// One row per frame, oldest first, with a column for every metric and user counter
+		bool exportCSV(const std::filesystem::path& path) const;
+
+		static const char* MetricName(FrameMetric metric);
+	};
+
+}
@@ -58,6 +58,9 @@ namespace sa {
 }
 
 
+// Track GPU timestamps are written to in the trace
+#define SA_PROFILER_GPU_THREAD_ID 0U
+
 #if SA_PROFILER_ENABLE
 #define SA_PROFILER_BEGIN_SESSION_PATH(filepath) sa::Profiler::get().beginSession(filepath)
 #define SA_PROFILER_BEGIN_SESSION() sa::Profiler::get().beginSession()
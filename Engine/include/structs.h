@@ -3,6 +3,8 @@
 #define SET_PER_OBJECT 0
 #define SET_PER_FRAME 0
 #define SET_MAT 1
+// Bindless texture table of the material shaders, owned by the render technique
+#define SET_TEXTURE_TABLE 1
 
 #define MAX_VIEWPORT_COUNT 4
 
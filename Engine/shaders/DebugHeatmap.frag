@@ -5,9 +5,9 @@
 
 layout(location = 0) out vec4 out_color;
 
-layout(set = 0, binding = 0) readonly buffer LightIndices {
-	uint data[];
-} lightIndices;
+layout(set = 0, binding = 0) readonly buffer TileLightCounts {
+	uint counts[];
+} tileLightCounts;
 
 layout(push_constant) uniform PushConstants {
     uint tileCountX;
@@ -17,11 +17,7 @@ void main() {
     ivec2 pos = ivec2(gl_FragCoord.xy);
     uint index = pos.y * pc.tileCountX + pos.x;
 
-    uint offset = index * MAX_LIGHTS_PER_TILE;
-    uint lightCount = 0;
-    for(int i = 0; i < MAX_LIGHTS_PER_TILE && lightIndices.data[i + offset] != -1; i++) {
-        lightCount++;
-    }
+    uint lightCount = tileLightCounts.counts[index];
     out_color = vec4(0, 0, 0, 0);
     
     uint colorLimits[] = {
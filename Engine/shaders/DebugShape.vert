@@ -0,0 +1,27 @@
+#version 450
+
+layout(location = 0) in vec3 in_vertexPos;
+
+layout(location = 0) out vec4 out_vertexColor;
+
+struct ShapeInstance {
+    mat4 transform;
+    vec4 color;
+};
+
+layout(set = 0, binding = 0) readonly buffer Instances {
+    ShapeInstance instances[];
+} instanceBuffer;
+
+layout(push_constant) uniform PushContstant {
+    mat4 viewProjMat;
+} pc;
+
+void main() {
+    ShapeInstance instance = instanceBuffer.instances[gl_InstanceIndex];
+    out_vertexColor = instance.color;
+
+    // projective transforms, like an inverse view projection for frustums, leave w != 1
+    vec4 worldPos = instance.transform * vec4(in_vertexPos, 1.0);
+    gl_Position = pc.viewProjMat * vec4(worldPos.xyz / worldPos.w, 1.0);
+}
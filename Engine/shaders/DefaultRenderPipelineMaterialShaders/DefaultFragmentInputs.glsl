@@ -68,7 +68,9 @@ layout(set = 0, binding = 9) uniform samplerCubeShadow shadowCubeTextures[MAX_SH
 
 layout(set = 0, binding = 10) uniform samplerCube skybox;
 
-layout(set = 0, binding = 32) uniform texture2D textures[];
+// Global texture table, indexed by stable slots assigned when textures are loaded. It is a set of its own,
+// written only when the table changes and shared by every material shader
+layout(set = 1, binding = 0) uniform texture2D textures[];
 
 
 layout(push_constant) uniform PushConstants {
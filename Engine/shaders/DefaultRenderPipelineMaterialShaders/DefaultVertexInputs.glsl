@@ -15,6 +15,11 @@ layout(set = 0, binding = 0) readonly buffer Objects {
     Object objects[];
 } objectBuffer;
 
+// Maps an instance to its object, lets culling compact the visible instances of a draw
+layout(set = 0, binding = 11) readonly buffer InstanceIndices {
+    uint indices[];
+} instanceBuffer;
+
 layout(push_constant) uniform Camera {
     mat4 viewMat;
     mat4 projMat;
@@ -22,7 +27,7 @@ layout(push_constant) uniform Camera {
 } camera;
 
 Object GetObject() {
-    return objectBuffer.objects[gl_InstanceIndex];
+    return objectBuffer.objects[instanceBuffer.indices[gl_InstanceIndex]];
 }
 
 
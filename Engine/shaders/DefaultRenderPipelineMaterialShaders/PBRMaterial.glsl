@@ -6,6 +6,7 @@ struct Material {
     vec3 emissiveColor;
     float emissiveStrength;
 
+    // *MapFirst are slots in the global texture table
     uint albedoMapFirst;
     uint albedoMapCount;
     uint normalMapFirst;
@@ -2,12 +2,38 @@
 
 layout(set = 0, binding = 0) uniform sampler2D colorTexture;
 
+layout(push_constant) uniform PushConstants {
+	vec2 uvScale; // part of the texture that holds the rendered image
+	float sharpness; // 0 to 1, 0 disables sharpening
+} pc;
+
 layout(location = 0) out vec4 out_color;
 layout(location = 1) in vec2 in_vertPos;
 
+vec3 sampleColor(vec2 uv, vec2 maxUV) {
+	return clamp(texture(colorTexture, min(uv, maxUV)).rgb, 0.0, 1.0);
+}
 
 void main() {
-	vec2 uv = in_vertPos * 0.5 + 0.5;
-	vec3 color = texture(colorTexture, uv).rgb;
-	out_color = vec4(min(color, 1), 1);
-}
\ No newline at end of file
+	vec2 texelSize = 1.0 / vec2(textureSize(colorTexture, 0));
+	// Keep the bilinear footprint inside the rendered part
+	vec2 maxUV = pc.uvScale - texelSize * 0.5;
+	vec2 uv = (in_vertPos * 0.5 + 0.5) * pc.uvScale;
+
+	vec3 color = sampleColor(uv, maxUV);
+	if (pc.sharpness > 0.0) {
+		// Contrast adaptive sharpening, the cross neighbours are weighted less where the local contrast is already high
+		vec3 n = sampleColor(uv - vec2(0.0, texelSize.y), maxUV);
+		vec3 s = sampleColor(uv + vec2(0.0, texelSize.y), maxUV);
+		vec3 w = sampleColor(uv - vec2(texelSize.x, 0.0), maxUV);
+		vec3 e = sampleColor(uv + vec2(texelSize.x, 0.0), maxUV);
+
+		vec3 minColor = min(color, min(min(n, s), min(w, e)));
+		vec3 maxColor = max(color, max(max(n, s), max(w, e)));
+		vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, 0.0001), 0.0, 1.0));
+		vec3 weight = -amount * mix(0.125, 0.2, pc.sharpness);
+
+		color = clamp((color + (n + s + w + e) * weight) / (1.0 + 4.0 * weight), 0.0, 1.0);
+	}
+	out_color = vec4(color, 1);
+}
@@ -405,4 +405,8 @@ namespace sa {
 		s_taskExecutor.wait_for_all();
 	}
 
+	tf::Executor& Asset::GetTaskExecutor() {
+		return s_taskExecutor;
+	}
+
 }
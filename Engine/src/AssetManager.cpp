@@ -274,6 +274,7 @@ namespace sa {
 
 		pAsset->data.meshes.push_back(mesh);
 
+		pAsset->markDataChanged();
 		pAsset->write();
 		return pAsset;
 	}
@@ -347,6 +348,7 @@ namespace sa {
 
 
 		mesh.material = getDefaultMaterial();
+		pAsset->markDataChanged();
 		pAsset->write();
 		return pAsset;
 	}
@@ -406,6 +408,7 @@ namespace sa {
 		}
 
 		mesh.material = getDefaultMaterial();
+		pAsset->markDataChanged();
 		pAsset->write();
 		return pAsset;
 	}
@@ -685,7 +688,7 @@ namespace sa {
 	}
 
 	AssetManager::AssetManager() {
-		loadDefaultTexture();
+		// The default texture is created by its first user, the manager itself has to work without a renderer
 		sa::ResourceManager::Get().setCleanupFunction<Texture>([](Texture* pTexture) {
 			pTexture->destroy();
 		});
@@ -3,69 +3,36 @@
 #include "Engine.h"
 
 namespace sa {
-	void BloomRenderLayer::initializeBloomData(const UUID& renderTargetID, RenderContext& context, Extent extent, const DynamicTexture* colorTexture) {
+	void BloomRenderLayer::initializeBloomData(const UUID& renderTargetID, RenderContext& context, Extent extent, const DynamicTexture* colorTexture, bool createScratchTextures) {
 		BloomData& data = getRenderTargetData(renderTargetID);
 
 		//Textures
-		data.bloomTexture.create2D(TextureUsageFlagBits::STORAGE | TextureUsageFlagBits::SAMPLED, extent, Format::UNDEFINED, 6U);
-		data.bloomMipTextures = data.bloomTexture.createMipLevelTextures();
-
-		data.bufferTexture.create2D(TextureUsageFlagBits::STORAGE | TextureUsageFlagBits::SAMPLED, extent, Format::UNDEFINED, data.bloomMipTextures.size() - 1);
-		data.bufferMipTextures = data.bufferTexture.createMipLevelTextures();
+		if (createScratchTextures) {
+			TransientTextureDesc bloomDesc = getBloomTextureDesc(extent);
+			data.bloomTexture.create2D(bloomDesc.usage, bloomDesc.extent, bloomDesc.format, bloomDesc.mipLevels);
+			data.bloomMipTextures = data.bloomTexture.createMipLevelTextures();
+
+			TransientTextureDesc bufferDesc = getBufferTextureDesc(extent);
+			data.bufferTexture.create2D(bufferDesc.usage, bufferDesc.extent, bufferDesc.format, bufferDesc.mipLevels);
+			data.bufferMipTextures = data.bufferTexture.createMipLevelTextures();
+		}
+		data.hasScratchTextures = createScratchTextures;
 
 		//bloomData.outputTexture = DynamicTexture2D(TextureTypeFlagBits::STORAGE | TextureTypeFlagBits::SAMPLED, tex.getExtent(), sa::FormatPrecisionFlagBits::e8Bit, sa::FormatDimensionFlagBits::e4, sa::FormatTypeFlagBits::UNORM);
 		data.outputTexture.create2D(TextureUsageFlagBits::STORAGE | TextureUsageFlagBits::SAMPLED, colorTexture->getExtent());
 
-		// DescriptorSets
-		if (data.filterDescriptorSet == NULL_RESOURCE)
-			data.filterDescriptorSet = m_pipelineLayout.allocateDescriptorSet(0);
-
-		if (data.blurDescriptorSets.empty()) {
-			data.blurDescriptorSets.resize(data.bloomMipTextures.size() - 1);
-			for (size_t i = 0; i < data.blurDescriptorSets.size(); i++) {
-				data.blurDescriptorSets[i] = m_pipelineLayout.allocateDescriptorSet(0);
-			}
+		if (!data.atomicCounterBuffer.isValid()) {
+			std::vector<uint32_t> counters(data.outputTexture.getTextureCount(), 0U);
+			data.atomicCounterBuffer.create(BufferType::STORAGE, counters.size() * sizeof(uint32_t), counters.data());
 		}
 
-		if (data.upsampleDescriptorSets.empty()) {
-			data.upsampleDescriptorSets.resize(data.bloomMipTextures.size() - 1);
-			for (size_t i = 0; i < data.upsampleDescriptorSets.size(); i++) {
-				data.upsampleDescriptorSets[i] = m_pipelineLayout.allocateDescriptorSet(0);
-			}
-		}
+		// DescriptorSets, written every frame since the mip chains may move
+		if (data.downsampleDescriptorSet == NULL_RESOURCE)
+			data.downsampleDescriptorSet = m_downsamplePipelineLayout.allocateDescriptorSet(0);
 
 		if (data.compositeDescriptorSet == NULL_RESOURCE)
 			data.compositeDescriptorSet = m_pipelineLayout.allocateDescriptorSet(0);
 
-		m_renderer.updateDescriptorSet(data.filterDescriptorSet, 0, *colorTexture, m_sampler);
-		m_renderer.updateDescriptorSet(data.filterDescriptorSet, 1, data.bloomMipTextures[0]);
-		m_renderer.updateDescriptorSet(data.filterDescriptorSet, 2, data.bloomMipTextures[0]);
-		m_renderer.updateDescriptorSet(data.filterDescriptorSet, 3, data.bloomMipTextures[0]);
-		for (size_t i = 0; i < data.bloomMipTextures.size() - 1; i++) {
-			m_renderer.updateDescriptorSet(data.blurDescriptorSets[i], 0, data.bloomMipTextures[i], m_sampler);
-			m_renderer.updateDescriptorSet(data.blurDescriptorSets[i], 1, data.bloomMipTextures[i]);
-			m_renderer.updateDescriptorSet(data.blurDescriptorSets[i], 2, data.bloomMipTextures[i]);
-			m_renderer.updateDescriptorSet(data.blurDescriptorSets[i], 3, data.bloomMipTextures[i + 1]);
-		}
-
-		DynamicTexture smallImage = data.bloomMipTextures[data.bloomMipTextures.size() - 1];
-		DynamicTexture bigImage = data.bloomMipTextures[data.bloomMipTextures.size() - 2];
-		for (int i = (int)data.bufferMipTextures.size() - 1; i >= 0; i--) {
-			m_renderer.updateDescriptorSet(data.upsampleDescriptorSets[i], 0, *colorTexture, m_sampler);
-			m_renderer.updateDescriptorSet(data.upsampleDescriptorSets[i], 1, smallImage);
-			m_renderer.updateDescriptorSet(data.upsampleDescriptorSets[i], 2, bigImage);
-			m_renderer.updateDescriptorSet(data.upsampleDescriptorSets[i], 3, data.bufferMipTextures[i]);
-			if (i > 0) {
-				smallImage = data.bufferMipTextures[i];
-				bigImage = data.bloomMipTextures[i - 1];
-			}
-		}
-
-		m_renderer.updateDescriptorSet(data.compositeDescriptorSet, 0, *colorTexture, m_sampler);
-		m_renderer.updateDescriptorSet(data.compositeDescriptorSet, 1, data.bufferMipTextures[0]);
-		m_renderer.updateDescriptorSet(data.compositeDescriptorSet, 2, data.bufferMipTextures[0]);
-		m_renderer.updateDescriptorSet(data.compositeDescriptorSet, 3, data.outputTexture);
-
 		data.isInitialized = true;
 
 		SA_DEBUG_LOG_INFO("Initialized Bloom data for RenderTarget UUID: ", renderTargetID, " with extent { w:", extent.width * 2, ", h:", extent.height * 2, " }");
@@ -80,31 +47,65 @@ namespace sa {
 			}
 			data.bloomTexture.destroy();
 		}
+		data.bloomMipTextures.clear();
 		if (data.bufferTexture.isValid()) {
 			for (auto& tex : data.bufferMipTextures) {
 				tex.destroy();
 			}
 			data.bufferTexture.destroy();
 		}
+		data.bufferMipTextures.clear();
 		if (data.outputTexture.isValid())
 			data.outputTexture.destroy();
 	}
 
+	void BloomRenderLayer::updateDescriptorSets(RenderContext& context, BloomData& bd, const Texture& colorTexture, const std::vector<Texture>& bloomMipTextures, const std::vector<Texture>& bufferMipTextures) {
+		const Texture& outputTexture = bd.outputTexture.getTexture();
+
+		context.updateDescriptorSet(bd.downsampleDescriptorSet, 0, colorTexture, m_sampler);
+		context.updateDescriptorSet(bd.downsampleDescriptorSet, 1, bloomMipTextures, 0);
+		context.updateDescriptorSet(bd.downsampleDescriptorSet, 2, bd.atomicCounterBuffer);
+
+		while (bd.upsampleDescriptorSets.size() < bufferMipTextures.size()) {
+			bd.upsampleDescriptorSets.push_back(m_pipelineLayout.allocateDescriptorSet(0));
+		}
+
+		// bufferMipTextures[i] is bloom level i + 1, written from the level below it
+		for (int i = (int)bufferMipTextures.size() - 1; i >= 0; i--) {
+			const Texture& lowerImage = i == (int)bufferMipTextures.size() - 1 ? bloomMipTextures.back() : bufferMipTextures[i + 1];
+			context.updateDescriptorSet(bd.upsampleDescriptorSets[i], 0, colorTexture, m_sampler);
+			context.updateDescriptorSet(bd.upsampleDescriptorSets[i], 1, lowerImage, m_linearSampler);
+			context.updateDescriptorSet(bd.upsampleDescriptorSets[i], 2, bloomMipTextures[i + 1], m_linearSampler);
+			context.updateDescriptorSet(bd.upsampleDescriptorSets[i], 3, bufferMipTextures[i]);
+			context.updateDescriptorSet(bd.upsampleDescriptorSets[i], 4, outputTexture);
+		}
+
+		context.updateDescriptorSet(bd.compositeDescriptorSet, 0, colorTexture, m_sampler);
+		context.updateDescriptorSet(bd.compositeDescriptorSet, 1, bufferMipTextures[0], m_linearSampler);
+		context.updateDescriptorSet(bd.compositeDescriptorSet, 2, bloomMipTextures[0], m_linearSampler);
+		context.updateDescriptorSet(bd.compositeDescriptorSet, 3, bufferMipTextures[0]);
+		context.updateDescriptorSet(bd.compositeDescriptorSet, 4, outputTexture);
+	}
+
 	void BloomRenderLayer::init() {
 		if (m_isInitialized)
 			return;
-		auto code = ReadSPVFile((Engine::GetShaderDirectory() / "BloomShader.comp.spv").generic_string().c_str());
-
+		auto code = ReadSPVFile((Engine::GetShaderDirectory() / "BloomDownsample.comp.spv").generic_string().c_str());
+		m_downsampleShader.create(code, ShaderStageFlagBits::COMPUTE);
+		m_downsamplePipelineLayout.createFromShaders({ m_downsampleShader });
+		m_downsamplePipeline = m_renderer.createComputePipeline(m_downsampleShader, m_downsamplePipelineLayout);
 
+		code = ReadSPVFile((Engine::GetShaderDirectory() / "BloomShader.comp.spv").generic_string().c_str());
 		m_bloomShader.create(code, ShaderStageFlagBits::COMPUTE);
 		m_pipelineLayout.createFromShaders({ m_bloomShader });
-
 		m_bloomPipeline = m_renderer.createComputePipeline(m_bloomShader, m_pipelineLayout);
 
+		m_downsamplePreferencesDescriptorSet = m_downsamplePipelineLayout.allocateDescriptorSet(1);
 		m_bloomPreferencesDescriptorSet = m_pipelineLayout.allocateDescriptorSet(1);
 
 		BloomPreferences& prefs = getPreferences();
 		m_bloomPreferencesBuffer.create(BufferType::UNIFORM, sizeof(BloomPreferences), &prefs);
+		m_renderer.updateDescriptorSet(m_downsamplePreferencesDescriptorSet, 0, m_bloomPreferencesBuffer);
 		m_renderer.updateDescriptorSet(m_bloomPreferencesDescriptorSet, 0, m_bloomPreferencesBuffer);
 
 
@@ -118,7 +119,10 @@ namespace sa {
 
 		m_sampler = m_renderer.createSampler(samplerInfo);
 
-		m_stackSize = 0;
+		// The upsample taps rely on bilinear filtering between mip texels
+		samplerInfo.minFilter = FilterMode::LINEAR;
+		samplerInfo.magFilter = FilterMode::LINEAR;
+		m_linearSampler = m_renderer.createSampler(samplerInfo);
 
 		m_isInitialized = true;
 	}
@@ -127,6 +131,14 @@ namespace sa {
 		m_pipelineLayout.destroy();
 		m_bloomShader.destroy();
 		m_renderer.destroyPipeline(m_bloomPipeline);
+
+		m_downsamplePipelineLayout.destroy();
+		m_downsampleShader.destroy();
+		m_renderer.destroyPipeline(m_downsamplePipeline);
+	}
+
+	const char* BloomRenderLayer::getName() const {
+		return "BloomRenderLayer";
 	}
 
 	void BloomRenderLayer::onRenderTargetResize(UUID renderTargetID, Extent oldExtent, Extent newExtent) {
@@ -137,102 +149,224 @@ namespace sa {
 	void BloomRenderLayer::onPreferencesUpdated() {
 		BloomPreferences& prefs = getPreferences();
 		m_bloomPreferencesBuffer.write(prefs);
+		m_renderer.updateDescriptorSet(m_downsamplePreferencesDescriptorSet, 0, m_bloomPreferencesBuffer);
 		m_renderer.updateDescriptorSet(m_bloomPreferencesDescriptorSet, 0, m_bloomPreferencesBuffer);
 	}
 
-	bool BloomRenderLayer::render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) {
-		SA_PROFILE_FUNCTION();
-
+	bool BloomRenderLayer::prepareBloomData(RenderContext& context, RenderTarget* pRenderTarget, bool useScratchTextures) {
 		const DynamicTexture* pTex = pRenderTarget->getOutputTextureDynamic();
 		if (!pTex)
 			return false;
-		Extent extent = {
-			static_cast<uint32_t>(std::ceil(pTex->getExtent().width * 0.5f)),
-			static_cast<uint32_t>(std::ceil(pTex->getExtent().height * 0.5f))
-		};
+		Extent extent = getBloomExtent(pTex->getExtent());
 
 		BloomData& bd = getRenderTargetData(pRenderTarget->getID());
 		
-		if (!bd.isInitialized) {
+		if (!bd.isInitialized || bd.hasScratchTextures != useScratchTextures) {
 			// Free old data
 			cleanupBloomData(pRenderTarget->getID());
 			// Initialize
-			initializeBloomData(pRenderTarget->getID(), context, extent, pTex);
+			initializeBloomData(pRenderTarget->getID(), context, extent, pTex, useScratchTextures);
 		}
 
 		bd.outputTexture.sync(context);
-		bd.bloomTexture.sync(context);
-		bd.bufferTexture.sync(context);
+		if (bd.hasScratchTextures) {
+			bd.bloomTexture.sync(context);
+			bd.bufferTexture.sync(context);
+			for (auto& tex : bd.bloomMipTextures) {
+				tex.sync(context);
+			}
+			for (auto& tex : bd.bufferMipTextures) {
+				tex.sync(context);
+			}
+		}
+		return true;
+	}
 
-		context.barrier(bd.bloomTexture, sa::Transition::NONE, sa::Transition::COMPUTE_SHADER_READ_WRITE);
-		context.barrier(bd.bufferTexture, sa::Transition::NONE, sa::Transition::COMPUTE_SHADER_READ_WRITE);
-		context.barrier(bd.outputTexture, sa::Transition::NONE, sa::Transition::COMPUTE_SHADER_READ_WRITE);
+	Extent BloomRenderLayer::getBloomExtent(Extent colorExtent) const {
+		return {
+			static_cast<uint32_t>(std::ceil(colorExtent.width * 0.5f)),
+			static_cast<uint32_t>(std::ceil(colorExtent.height * 0.5f))
+		};
+	}
+
+	TransientTextureDesc BloomRenderLayer::getBloomTextureDesc(Extent extent) const {
+		return {
+			.usage = TextureUsageFlagBits::STORAGE | TextureUsageFlagBits::SAMPLED,
+			.extent = extent,
+			.format = Format::R16G16B16A16_SFLOAT,
+			.mipLevels = BLOOM_MIP_COUNT,
+		};
+	}
 
+	TransientTextureDesc BloomRenderLayer::getBufferTextureDesc(Extent extent) const {
+		return {
+			.usage = TextureUsageFlagBits::STORAGE | TextureUsageFlagBits::SAMPLED,
+			.extent = { std::max(extent.width >> 1, 1U), std::max(extent.height >> 1, 1U) },
+			.format = Format::R16G16B16A16_SFLOAT,
+			.mipLevels = BLOOM_MIP_COUNT - 2,
+		};
+	}
 
-		uint32_t threadX = std::ceil(extent.width / 32.f);
-		uint32_t threadY = std::ceil(extent.height / 32.f);
-		m_threadCountStack[m_stackSize++] = { threadX << 1, threadY << 1 };
-		m_threadCountStack[m_stackSize++] = { threadX, threadY };
+	void BloomRenderLayer::downsample(RenderContext& context, const BloomData& bd, Extent renderExtent) {
+		// Filter + downsample every mip in one dispatch
+		context.bindPipelineLayout(m_downsamplePipelineLayout);
+		context.bindPipeline(m_downsamplePipeline);
+		context.bindDescriptorSet(m_downsamplePreferencesDescriptorSet);
+		context.bindDescriptorSet(bd.downsampleDescriptorSet);
+
+		BloomDownsamplePushConstants pushConstants = {};
+		pushConstants.renderExtent = { renderExtent.width, renderExtent.height };
+		pushConstants.counterIndex = context.getFrameIndex();
+		context.pushConstant(ShaderStageFlagBits::COMPUTE, pushConstants);
+
+		const Extent extent = getBloomExtent(renderExtent);
+		context.dispatch(
+			(extent.width + BLOOM_DOWNSAMPLE_TILE_SIZE - 1) / BLOOM_DOWNSAMPLE_TILE_SIZE,
+			(extent.height + BLOOM_DOWNSAMPLE_TILE_SIZE - 1) / BLOOM_DOWNSAMPLE_TILE_SIZE,
+			1);
+		Engine::GetEngineStatistics().dispatchCalls++;
+	}
 
-		context.barrier(*pTex, Transition::RENDER_PROGRAM_OUTPUT, Transition::COMPUTE_SHADER_READ);
+	void BloomRenderLayer::upsample(RenderContext& context, const BloomData& bd, const std::vector<Texture>& bufferMipTextures, Extent renderExtent) {
+		const Extent extent = getBloomExtent(renderExtent);
+		context.bindPipelineLayout(m_pipelineLayout);
+		context.bindPipeline(m_bloomPipeline);
+		context.bindDescriptorSet(m_bloomPreferencesDescriptorSet);
+		for (int i = (int)bufferMipTextures.size() - 1; i >= 0; i--) {
+			if (i < (int)bufferMipTextures.size() - 1) {
+				context.barrier(bufferMipTextures[i + 1], Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ_WRITE);
+			}
 
-		// Filter
+			// Same rounding as the mips, the rest of them is left untouched
+			const Extent mipExtent = {
+				std::max(extent.width >> (i + 1), 1U),
+				std::max(extent.height >> (i + 1), 1U)
+			};
+			BloomPushConstants pushConstants = {};
+			pushConstants.renderExtent = { renderExtent.width, renderExtent.height };
+			pushConstants.mode = 2;
+			pushConstants.level = i + 1;
+			context.bindDescriptorSet(bd.upsampleDescriptorSets[i]);
+			context.pushConstant(ShaderStageFlagBits::COMPUTE, pushConstants);
+			context.dispatch(
+				static_cast<uint32_t>(std::ceil(mipExtent.width / 16.f)),
+				static_cast<uint32_t>(std::ceil(mipExtent.height / 16.f)),
+				1);
+		}
+		Engine::GetEngineStatistics().dispatchCalls += bufferMipTextures.size();
+	}
+
+	void BloomRenderLayer::composite(RenderContext& context, const BloomData& bd, Extent outputExtent) {
+		// Upsample level 0 + Composite + Tonemap
 		context.bindPipelineLayout(m_pipelineLayout);
 		context.bindPipeline(m_bloomPipeline);
 		context.bindDescriptorSet(m_bloomPreferencesDescriptorSet);
+		context.bindDescriptorSet(bd.compositeDescriptorSet);
+		BloomPushConstants pushConstants = {};
+		pushConstants.renderExtent = { outputExtent.width, outputExtent.height };
+		pushConstants.mode = 3;
+		context.pushConstant(ShaderStageFlagBits::COMPUTE, pushConstants);
+		context.dispatch(
+			static_cast<uint32_t>(std::ceil(outputExtent.width / 16.f)),
+			static_cast<uint32_t>(std::ceil(outputExtent.height / 16.f)),
+			1);
+		Engine::GetEngineStatistics().dispatchCalls++;
+	}
 
-		context.bindDescriptorSet(bd.filterDescriptorSet);
-		context.pushConstant(ShaderStageFlagBits::COMPUTE, 0);
-		context.dispatch(threadX, threadY, 1);
+	bool BloomRenderLayer::addRenderPasses(RenderGraph& graph, const std::string& name, RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) {
+		SA_PROFILE_FUNCTION();
 
-		// Downsample + blur
-		for (size_t i = 0; i < bd.bloomMipTextures.size() - 1; i++) {
-			bd.bloomMipTextures[i].sync(context);
-			context.barrier(bd.bloomMipTextures[i], sa::Transition::COMPUTE_SHADER_WRITE, sa::Transition::COMPUTE_SHADER_READ);
+		// Only joins the graph when the scene color was declared by the layer before, otherwise its state is unknown
+		if (graph.getResource("SceneColor") == RENDER_GRAPH_INVALID_RESOURCE)
+			return BasicRenderLayer::addRenderPasses(graph, name, context, pCamera, pRenderTarget, sceneCollection);
 
+		if (!prepareBloomData(context, pRenderTarget, false))
+			return false;
 
-			threadX += threadX % 2;
-			threadX = threadX >> 1;
+		const DynamicTexture* pTex = pRenderTarget->getOutputTextureDynamic();
+		const Extent extent = getBloomExtent(pTex->getExtent());
+		// Only the rendered part of the color is filtered, the rest of the textures is left untouched
+		const Extent outputExtent = pRenderTarget->getRenderExtent();
+		BloomData& bd = getRenderTargetData(pRenderTarget->getID());
 
-			threadY += threadY % 2;
-			threadY = threadY >> 1;
-			m_threadCountStack[m_stackSize++] = { threadX, threadY };
+		const RenderGraphResource sceneColor = graph.importTexture("SceneColor", pTex->getTexture(), Transition::RENDER_PROGRAM_OUTPUT);
+		// The mip chains are only alive between the downsample and the composite
+		const RenderGraphResource bloom = graph.createTexture("Bloom", getBloomTextureDesc(extent));
+		const RenderGraphResource buffer = graph.createTexture("Bloom buffer", getBufferTextureDesc(extent));
+		const RenderGraphResource output = graph.importTexture("Bloom output", bd.outputTexture.getTexture(), Transition::NONE);
+		graph.markOutput(output);
+
+		const Texture& colorTexture = pTex->getTexture();
+
+		graph.addPass("Bloom downsample", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+			builder.read(sceneColor, Transition::COMPUTE_SHADER_READ);
+			builder.write(bloom, Transition::COMPUTE_SHADER_READ_WRITE);
+		}, [=, this, &graph, &bd, &colorTexture](RenderContext& context) {
+			updateDescriptorSets(context, bd, colorTexture, graph.getMipLevelTextures(bloom), graph.getMipLevelTextures(buffer));
+			downsample(context, bd, outputExtent);
+			return true;
+		});
+
+		graph.addPass("Bloom upsample", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+			builder.read(sceneColor, Transition::COMPUTE_SHADER_READ);
+			builder.read(bloom, Transition::COMPUTE_SHADER_READ_WRITE);
+			builder.write(buffer, Transition::COMPUTE_SHADER_READ_WRITE);
+			// Bound as storage image, only written by the composite
+			builder.read(output, Transition::COMPUTE_SHADER_READ_WRITE);
+		}, [=, this, &graph, &bd](RenderContext& context) {
+			upsample(context, bd, graph.getMipLevelTextures(buffer), outputExtent);
+			return true;
+		});
+
+		graph.addPass("Bloom composite", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+			builder.read(sceneColor, Transition::COMPUTE_SHADER_READ);
+			builder.read(bloom, Transition::COMPUTE_SHADER_READ_WRITE);
+			builder.read(buffer, Transition::COMPUTE_SHADER_READ_WRITE);
+			builder.write(output, Transition::COMPUTE_SHADER_READ_WRITE);
+		}, [=, this, &bd](RenderContext& context) {
+			composite(context, bd, outputExtent);
+			return true;
+		});
 
-			context.bindDescriptorSet(bd.blurDescriptorSets[i]);
-			context.pushConstant(ShaderStageFlagBits::COMPUTE, 1);
-			context.dispatch(threadX, threadY, 1);
-		}
-		// Upsample + combine
-
-		m_stackSize--;
-		DynamicTexture smallImage = bd.bloomMipTextures[bd.bloomMipTextures.size() - 1];
-		smallImage.sync(context);
-		for (int i = (int)bd.bufferMipTextures.size() - 1; i >= 0; i--) {
-			bd.bufferMipTextures[i].sync(context);
-			context.barrier(smallImage, sa::Transition::COMPUTE_SHADER_WRITE, sa::Transition::COMPUTE_SHADER_READ);
-
-			m_stackSize--;
-			threadX = m_threadCountStack[m_stackSize].width;
-			threadY = m_threadCountStack[m_stackSize].height;
-			context.bindDescriptorSet(bd.upsampleDescriptorSets[i]);
-			context.pushConstant(ShaderStageFlagBits::COMPUTE, 2);
-			context.dispatch(threadX, threadY, 1);
+		pRenderTarget->setOutputTexture(bd.outputTexture, Transition::COMPUTE_SHADER_WRITE);
+		return true;
+	}
 
-			if (i > 0) {
-				smallImage = bd.bufferMipTextures[i];
-			}
+	bool BloomRenderLayer::render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) {
+		SA_PROFILE_FUNCTION();
+
+		if (!prepareBloomData(context, pRenderTarget, true))
+			return false;
+
+		const DynamicTexture* pTex = pRenderTarget->getOutputTextureDynamic();
+		const Extent outputExtent = pRenderTarget->getRenderExtent();
+		BloomData& bd = getRenderTargetData(pRenderTarget->getID());
+
+		std::vector<Texture> bloomMipTextures;
+		for (const auto& tex : bd.bloomMipTextures) {
+			bloomMipTextures.push_back(tex.getTexture());
 		}
+		std::vector<Texture> bufferMipTextures;
+		for (const auto& tex : bd.bufferMipTextures) {
+			bufferMipTextures.push_back(tex.getTexture());
+		}
+		updateDescriptorSets(context, bd, pTex->getTexture(), bloomMipTextures, bufferMipTextures);
+
+		context.barrier(bd.bloomTexture, sa::Transition::NONE, sa::Transition::COMPUTE_SHADER_READ_WRITE);
+		context.barrier(bd.bufferTexture, sa::Transition::NONE, sa::Transition::COMPUTE_SHADER_READ_WRITE);
+		context.barrier(bd.outputTexture, sa::Transition::NONE, sa::Transition::COMPUTE_SHADER_READ_WRITE);
 
-		threadX = m_threadCountStack[--m_stackSize].width;
-		threadY = m_threadCountStack[m_stackSize].height;
+		context.barrier(*pTex, Transition::RENDER_PROGRAM_OUTPUT, Transition::COMPUTE_SHADER_READ);
+
+		downsample(context, bd, outputExtent);
+
+		context.barrier(bd.bloomTexture, Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ_WRITE);
 
-		// Composite + Tonemap
-		context.barrier(bd.bufferMipTextures[0], Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ);
+		upsample(context, bd, bufferMipTextures, outputExtent);
+
+		context.barrier(bufferMipTextures[0], Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ_WRITE);
 		
-		context.bindDescriptorSet(bd.compositeDescriptorSet);
-		context.pushConstant(ShaderStageFlagBits::COMPUTE, 3);
-		context.dispatch(threadX, threadY, 1);
-		Engine::GetEngineStatistics().dispatchCalls += bd.bufferMipTextures.size() * 2 + 2;
+		composite(context, bd, outputExtent);
 		
 		pRenderTarget->setOutputTexture(bd.outputTexture, Transition::COMPUTE_SHADER_WRITE);
 		return true;
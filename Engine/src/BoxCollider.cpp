@@ -18,6 +18,7 @@ namespace comp {
 	void BoxCollider::serialize(sa::Serializer& s) {
 		s.value("halfLengths", (glm::vec3)halfLengths);
 		s.value("offset", (glm::vec3)offset);
+		s.value("isTrigger", isTrigger);
 	}
 
 	void BoxCollider::deserialize(void* pDoc) {
@@ -27,6 +28,10 @@ namespace comp {
 		halfLengths = sa::Serializer::DeserializeVec3(&member);
 		member = obj["offset"];
 		offset = sa::Serializer::DeserializeVec3(&member);
+
+		auto field = obj.find_field("isTrigger");
+		if (field.error() != simdjson::NO_SUCH_FIELD)
+			isTrigger = field.get_bool().value();
 	}
 
 	void BoxCollider::onConstruct(sa::Entity* e) {
@@ -35,15 +40,9 @@ namespace comp {
 		if (!rb)
 			rb = e->addComponent<comp::RigidBody>();
 
+		// A copied collider still points at the shape of the original, clones get it back from the shape cache
 		PxBoxGeometry box(sa::PhysicsSystem::toPxVec(halfLengths));
-		if (offset.x + offset.y + offset.z > 0.01f) {
-			pShape = sa::PhysicsSystem::get().createExclusiveShape(&box);
-			PxTransform transform(sa::PhysicsSystem::toPxVec(offset));
-			pShape->setLocalPose(transform);
-		}
-		else {
-			pShape = sa::PhysicsSystem::get().createShape(&box);
-		}
+		pShape = sa::PhysicsSystem::get().createShape(&box, pMaterial, offset, isTrigger);
 
 		rb->m_pActor->attachShape(*pShape);
 	}
@@ -54,18 +53,12 @@ namespace comp {
 		if (!rb)
 			rb = e->addComponent<comp::RigidBody>();
 		rb->m_pActor->detachShape(*pShape);
+		sa::PhysicsSystem::get().releaseShape(pShape);
 		
 		halfLengths = glm::max(halfLengths, 0.01f);
 
 		PxBoxGeometry box(sa::PhysicsSystem::toPxVec(halfLengths));
-		if (abs(offset.x) + abs(offset.y) + abs(offset.z) > 0.01f) {
-			pShape = sa::PhysicsSystem::get().createExclusiveShape(&box);
-			PxTransform transform(sa::PhysicsSystem::toPxVec(offset));
-			pShape->setLocalPose(transform);
-		}
-		else {
-			pShape = sa::PhysicsSystem::get().createShape(&box);
-		}
+		pShape = sa::PhysicsSystem::get().createShape(&box, pMaterial, offset, isTrigger);
 		rb->m_pActor->attachShape(*pShape);
 
 	}
@@ -74,6 +67,8 @@ namespace comp {
 		comp::RigidBody* rb = e->getComponent<comp::RigidBody>();
 		if (rb)
 			rb->m_pActor->detachShape(*pShape);
+		sa::PhysicsSystem::get().releaseShape(pShape);
+		pShape = nullptr;
 	}
 
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ namespace sa {
 		registerComponentType<comp::RigidBody>();
 		registerComponentType<comp::BoxCollider>();
 		registerComponentType<comp::SphereCollider>();
+		registerComponentType<comp::PhysicsAggregate>();
 		registerComponentType<comp::Camera>();
 	}
 
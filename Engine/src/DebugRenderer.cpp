@@ -6,17 +6,159 @@
 
 namespace sa {
 
-    DebugRenderer::DebugRenderer() 
+    void DebugRenderer::createShapeGeometry() {
+        std::vector<glm::vec3> vertices;
+        auto beginShape = [&](DebugShape shape) {
+            m_shapeRanges[(size_t)shape].firstVertex = vertices.size();
+        };
+        auto endShape = [&](DebugShape shape) {
+            ShapeRange& range = m_shapeRanges[(size_t)shape];
+            range.vertexCount = vertices.size() - range.firstVertex;
+        };
+        auto addCircle = [&](glm::vec3 center, glm::vec3 u, glm::vec3 v) {
+            for (uint32_t i = 0; i < DEBUG_SHAPE_SEGMENTS; i++) {
+                float a0 = glm::two_pi<float>() * i / DEBUG_SHAPE_SEGMENTS;
+                float a1 = glm::two_pi<float>() * (i + 1) / DEBUG_SHAPE_SEGMENTS;
+                vertices.push_back(center + u * cos(a0) + v * sin(a0));
+                vertices.push_back(center + u * cos(a1) + v * sin(a1));
+            }
+        };
+
+        beginShape(DebugShape::BOX);
+        for (int axis = 0; axis < 3; axis++) {
+            // 4 edges along every axis
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 p(0.f);
+                p[(axis + 1) % 3] = (i & 1) ? 1.f : -1.f;
+                p[(axis + 2) % 3] = (i & 2) ? 1.f : -1.f;
+                p[axis] = -1.f;
+                vertices.push_back(p);
+                p[axis] = 1.f;
+                vertices.push_back(p);
+            }
+        }
+        endShape(DebugShape::BOX);
+
+        beginShape(DebugShape::SPHERE);
+        addCircle({ 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 });
+        addCircle({ 0, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 });
+        addCircle({ 0, 0, 0 }, { 0, 0, 1 }, { 1, 0, 0 });
+        endShape(DebugShape::SPHERE);
+
+        beginShape(DebugShape::CONE);
+        addCircle({ 0, 0, 1 }, { 1, 0, 0 }, { 0, 1, 0 });
+        for (glm::vec3 p : { glm::vec3(1, 0, 1), glm::vec3(-1, 0, 1), glm::vec3(0, 1, 1), glm::vec3(0, -1, 1) }) {
+            vertices.push_back({ 0, 0, 0 });
+            vertices.push_back(p);
+        }
+        endShape(DebugShape::CONE);
+
+        // The frustum is a box in NDC
+        m_shapeRanges[(size_t)DebugShape::FRUSTUM] = m_shapeRanges[(size_t)DebugShape::BOX];
+
+        beginShape(DebugShape::ARROW);
+        vertices.push_back({ 0, 0, 0 });
+        vertices.push_back({ 0, 0, 1 });
+        for (glm::vec3 p : { glm::vec3(0.1f, 0, 0.8f), glm::vec3(-0.1f, 0, 0.8f), glm::vec3(0, 0.1f, 0.8f), glm::vec3(0, -0.1f, 0.8f) }) {
+            vertices.push_back({ 0, 0, 1 });
+            vertices.push_back(p);
+        }
+        endShape(DebugShape::ARROW);
+
+        m_shapeVertexBuffer.create(BufferType::VERTEX, vertices.size() * sizeof(glm::vec3), vertices.data());
+    }
+
+    void DebugRenderer::removeExpired() {
+        float now = m_clock.getElapsedTime();
+        size_t removed = std::erase_if(m_persistentLines, [=](const PersistentLine& line) { return line.expireTime <= now; });
+        for (auto& shapes : m_persistentShapes) {
+            removed += std::erase_if(shapes, [=](const PersistentShape& shape) { return shape.expireTime <= now; });
+        }
+        if (removed > 0)
+            m_persistentVersion++;
+    }
+
+    void DebugRenderer::syncPersistentBuffers() {
+        uint32_t bufferIndex = m_persistentLineVertexBuffer.getBufferIndex();
+        if (m_persistentBufferVersions[bufferIndex] == m_persistentVersion)
+            return;
+
+        std::vector<Vertex> vertices;
+        vertices.reserve(m_persistentLines.size() * 2);
+        for (const auto& line : m_persistentLines) {
+            vertices.push_back(line.p1);
+            vertices.push_back(line.p2);
+        }
+        m_persistentLineVertexBuffer.write(vertices);
+
+        std::vector<ShapeInstance> instances;
+        for (const auto& shapes : m_persistentShapes) {
+            for (const auto& shape : shapes) {
+                instances.push_back(shape.instance);
+            }
+        }
+        m_persistentShapeInstanceBuffer.write(instances);
+
+        m_persistentBufferVersions[bufferIndex] = m_persistentVersion;
+    }
+
+    void DebugRenderer::addLine(const Vertex& p1, const Vertex& p2, float lifetime) {
+        if (lifetime > 0.0f) {
+            m_persistentLines.push_back(PersistentLine{
+                .p1 = p1,
+                .p2 = p2,
+                .expireTime = m_clock.getElapsedTime() + lifetime
+            });
+            m_persistentVersion++;
+            return;
+        }
+        m_lineList.push_back(p1);
+        m_lineList.push_back(p2);
+    }
+
+    void DebugRenderer::drawShapeInstances(RenderContext& context, ResourceID descriptorSet, const DynamicBuffer& instanceBuffer, const ShapeArray<uint32_t>& instanceCounts) {
+        context.updateDescriptorSet(descriptorSet, 0, instanceBuffer.getBuffer());
+        context.bindDescriptorSet(descriptorSet);
+
+        uint32_t firstInstance = 0;
+        for (size_t i = 0; i < instanceCounts.size(); i++) {
+            if (instanceCounts[i] == 0)
+                continue;
+            const ShapeRange& range = m_shapeRanges[i];
+            context.draw(range.vertexCount, instanceCounts[i], range.firstVertex, firstInstance);
+            Engine::GetEngineStatistics().drawCalls++;
+            firstInstance += instanceCounts[i];
+        }
+    }
+
+    DebugRenderer::DebugRenderer()
         : m_isInitialized(false)
         , m_pipeline(NULL_RESOURCE)
+        , m_wireframePipeline(NULL_RESOURCE)
+        , m_shapePipeline(NULL_RESOURCE)
+        , m_shapeRanges({})
+        , m_persistentVersion(0)
     {
         m_shaders[0].create(ReadSPVFile((Engine::GetShaderDirectory() / "DebugDrawing.vert.spv").generic_string().c_str()));
         m_shaders[1].create(ReadSPVFile((Engine::GetShaderDirectory() / "DebugDrawing.frag.spv").generic_string().c_str()));
 
         m_pipelineLayout.createFromShaders(m_shaders.data(), m_shaders.size());
 
+        m_shapeShaders[0].create(ReadSPVFile((Engine::GetShaderDirectory() / "DebugShape.vert.spv").generic_string().c_str()));
+        m_shapeShaders[1].create(ReadSPVFile((Engine::GetShaderDirectory() / "DebugDrawing.frag.spv").generic_string().c_str()));
+
+        m_shapePipelineLayout.createFromShaders(m_shapeShaders.data(), m_shapeShaders.size());
 
         m_lineVertexBuffer.create(BufferType::VERTEX);
+
+        createShapeGeometry();
+        m_shapeInstanceBuffer.create(BufferType::STORAGE);
+        m_shapeDescriptorSet = m_shapePipelineLayout.allocateDescriptorSet(0);
+
+        m_persistentLineVertexBuffer.create(BufferType::VERTEX);
+        m_persistentShapeInstanceBuffer.create(BufferType::STORAGE);
+        m_persistentShapeDescriptorSet = m_shapePipelineLayout.allocateDescriptorSet(0);
+        m_persistentBufferVersions.assign(m_persistentLineVertexBuffer.getBufferCount(), 0);
     }
 
 
@@ -26,7 +168,7 @@ namespace sa {
     }
 
     void DebugRenderer::initialize(ResourceID renderProgram) {
-        
+
         PipelineSettings settings = {};
         settings.cullMode = CullModeFlagBits::NONE;
         settings.depthTestEnabled = false;
@@ -38,7 +180,8 @@ namespace sa {
         settings.polygonMode = PolygonMode::LINE;
         settings.topology = Topology::LINE_LIST;
         m_wireframePipeline = Renderer::Get().createGraphicsPipeline(m_pipelineLayout, m_shaders.data(), m_shaders.size(), renderProgram, 0, { 0, 0 }, settings);
-        
+        m_shapePipeline = Renderer::Get().createGraphicsPipeline(m_shapePipelineLayout, m_shapeShaders.data(), m_shapeShaders.size(), renderProgram, 0, { 0, 0 }, settings);
+
         m_isInitialized = true;
     }
 
@@ -47,70 +190,169 @@ namespace sa {
     }
 
     void DebugRenderer::render(RenderContext& context, Extent extent, const SceneCamera& sceneCamera) {
-        
-        if (m_lineList.empty())
+        removeExpired();
+
+        ShapeArray<uint32_t> shapeCounts;
+        ShapeArray<uint32_t> persistentShapeCounts;
+        uint32_t shapeInstanceCount = 0;
+        uint32_t persistentShapeInstanceCount = 0;
+        for (size_t i = 0; i < shapeCounts.size(); i++) {
+            shapeCounts[i] = m_shapeInstances[i].size();
+            persistentShapeCounts[i] = m_persistentShapes[i].size();
+            shapeInstanceCount += shapeCounts[i];
+            persistentShapeInstanceCount += persistentShapeCounts[i];
+        }
+
+        if (m_lineList.empty() && m_persistentLines.empty() && shapeInstanceCount == 0 && persistentShapeInstanceCount == 0)
             return;
-            
-        m_lineVertexBuffer.write(m_lineList);
-        
-        context.bindPipelineLayout(m_pipelineLayout);
-        context.bindPipeline(m_wireframePipeline);
+
+        syncPersistentBuffers();
 
         Rect viewport = Rect{
             .offset = { 0, 0 },
             .extent = extent
         };
-        context.setViewport(viewport);
-        context.setScissor(viewport);
-
         glm::mat4 mat = sceneCamera.getProjectionMatrix() * sceneCamera.getViewMatrix();
-        context.pushConstant(ShaderStageFlagBits::VERTEX, mat);
 
-        context.bindVertexBuffers(0, &m_lineVertexBuffer.getBuffer(), 1);
-        
-        context.draw(m_lineVertexBuffer.getElementCount<Vertex>(), 1);
-        Engine::GetEngineStatistics().drawCalls++;
+        if (!m_lineList.empty() || !m_persistentLines.empty()) {
+            context.bindPipelineLayout(m_pipelineLayout);
+            context.bindPipeline(m_wireframePipeline);
+
+            context.setViewport(viewport);
+            context.setScissor(viewport);
+
+            context.pushConstant(ShaderStageFlagBits::VERTEX, mat);
+
+            if (!m_lineList.empty()) {
+                m_lineVertexBuffer.write(m_lineList);
+                context.bindVertexBuffers(0, &m_lineVertexBuffer.getBuffer(), 1);
+                context.draw(m_lineVertexBuffer.getElementCount<Vertex>(), 1);
+                Engine::GetEngineStatistics().drawCalls++;
+            }
+
+            if (!m_persistentLines.empty()) {
+                context.bindVertexBuffers(0, &m_persistentLineVertexBuffer.getBuffer(), 1);
+                context.draw(m_persistentLines.size() * 2, 1);
+                Engine::GetEngineStatistics().drawCalls++;
+            }
+        }
+
+        if (shapeInstanceCount > 0 || persistentShapeInstanceCount > 0) {
+            context.bindPipelineLayout(m_shapePipelineLayout);
+            context.bindPipeline(m_shapePipeline);
+
+            context.setViewport(viewport);
+            context.setScissor(viewport);
+
+            context.pushConstant(ShaderStageFlagBits::VERTEX, mat);
+            context.bindVertexBuffers(0, &m_shapeVertexBuffer, 1);
+
+            if (shapeInstanceCount > 0) {
+                m_shapeInstanceBuffer.clear();
+                for (const auto& instances : m_shapeInstances) {
+                    m_shapeInstanceBuffer.append(instances);
+                }
+                drawShapeInstances(context, m_shapeDescriptorSet, m_shapeInstanceBuffer, shapeCounts);
+            }
+
+            if (persistentShapeInstanceCount > 0) {
+                drawShapeInstances(context, m_persistentShapeDescriptorSet, m_persistentShapeInstanceBuffer, persistentShapeCounts);
+            }
+        }
 
         m_lineVertexBuffer.swap();
+        m_shapeInstanceBuffer.swap();
+        m_persistentLineVertexBuffer.swap();
+        m_persistentShapeInstanceBuffer.swap();
         m_lineList.clear();
+        for (auto& instances : m_shapeInstances) {
+            instances.clear();
+        }
     }
 
-    void DebugRenderer::drawLine(const glm::vec3& p1, const glm::vec3& p2, Color color) {
-        m_lineList.push_back(Vertex{
-            .position = p1,
-            .color = color
-        });
-        m_lineList.push_back(Vertex{
-            .position = p2,
-            .color = color
-        });
+    void DebugRenderer::drawLine(const glm::vec3& p1, const glm::vec3& p2, Color color, float lifetime) {
+        addLine(Vertex{ .position = p1, .color = color }, Vertex{ .position = p2, .color = color }, lifetime);
     }
 
-    void DebugRenderer::drawLines(glm::vec3* pPoints, uint32_t pointCount, Color color) {
+    void DebugRenderer::drawLines(glm::vec3* pPoints, uint32_t pointCount, Color color, float lifetime) {
         for (uint32_t i = 0; i < pointCount - 1; i++) {
-            m_lineList.push_back(Vertex{
-                .position = pPoints[i],
-                .color = color 
-            });
-            m_lineList.push_back(Vertex{
-                .position = pPoints[i + 1],
-                .color = color
-            });
+            addLine(Vertex{ .position = pPoints[i], .color = color }, Vertex{ .position = pPoints[i + 1], .color = color }, lifetime);
         }
     }
 
-    void DebugRenderer::drawLineLoop(glm::vec3* pPoints, uint32_t pointCount, Color color) {
+    void DebugRenderer::drawLineLoop(glm::vec3* pPoints, uint32_t pointCount, Color color, float lifetime) {
         for (uint32_t i = 0; i < pointCount; i++) {
-            m_lineList.push_back(Vertex{
-                .position = pPoints[i],
-                .color = color
-            });
-            m_lineList.push_back(Vertex{
-                .position = pPoints[(i + 1) % pointCount],
-                .color = color
+            addLine(Vertex{ .position = pPoints[i], .color = color }, Vertex{ .position = pPoints[(i + 1) % pointCount], .color = color }, lifetime);
+        }
+    }
+
+    void DebugRenderer::drawShape(DebugShape shape, const glm::mat4& transform, Color color, float lifetime) {
+        if (shape == DebugShape::COUNT)
+            throw std::runtime_error("Invalid debug shape");
+
+        ShapeInstance instance = {
+            .transform = transform,
+            .color = color
+        };
+        if (lifetime > 0.0f) {
+            m_persistentShapes[(size_t)shape].push_back(PersistentShape{
+                .instance = instance,
+                .expireTime = m_clock.getElapsedTime() + lifetime
             });
+            m_persistentVersion++;
+            return;
         }
+        m_shapeInstances[(size_t)shape].push_back(instance);
+    }
+
+    void DebugRenderer::drawBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation, Color color, float lifetime) {
+        glm::mat4 transform = glm::translate(glm::mat4(1), center) * glm::toMat4(rotation) * glm::scale(glm::mat4(1), halfExtents);
+        drawShape(DebugShape::BOX, transform, color, lifetime);
+    }
+
+    void DebugRenderer::drawSphere(const glm::vec3& center, float radius, Color color, float lifetime) {
+        glm::mat4 transform = glm::translate(glm::mat4(1), center) * glm::scale(glm::mat4(1), glm::vec3(radius));
+        drawShape(DebugShape::SPHERE, transform, color, lifetime);
+    }
+
+    void DebugRenderer::drawCone(const glm::vec3& apex, const glm::vec3& direction, float length, float angle, Color color, float lifetime) {
+        float radius = tan(angle) * length;
+        glm::quat rotation = glm::rotation(glm::vec3(0, 0, 1), glm::normalize(direction));
+        glm::mat4 transform = glm::translate(glm::mat4(1), apex) * glm::toMat4(rotation) * glm::scale(glm::mat4(1), glm::vec3(radius, radius, length));
+        drawShape(DebugShape::CONE, transform, color, lifetime);
     }
 
+    void DebugRenderer::drawFrustum(const glm::mat4& viewProjection, bool zeroToOneDepth, Color color, float lifetime) {
+        glm::mat4 transform = glm::inverse(viewProjection);
+        if (zeroToOneDepth) {
+            // Squash the z of the unit shape from [-1, 1] to [0, 1] before unprojecting
+            transform = transform * glm::translate(glm::mat4(1), glm::vec3(0, 0, 0.5f)) * glm::scale(glm::mat4(1), glm::vec3(1, 1, 0.5f));
+        }
+        drawShape(DebugShape::FRUSTUM, transform, color, lifetime);
+    }
+
+    void DebugRenderer::drawFrustum(const SceneCamera& camera, Color color, float lifetime) {
+        // Perspective uses glm::perspective with [-1, 1] depth, orthographic uses glm::orthoRH_ZO
+        const bool zeroToOneDepth = camera.getProjectionMode() == eOrthographic;
+        drawFrustum(camera.getProjectionMatrix() * camera.getViewMatrix(), zeroToOneDepth, color, lifetime);
+    }
+
+    void DebugRenderer::drawArrow(const glm::vec3& from, const glm::vec3& to, Color color, float lifetime) {
+        glm::vec3 direction = to - from;
+        float length = glm::length(direction);
+        if (length <= 0.0f)
+            return;
+        glm::quat rotation = glm::rotation(glm::vec3(0, 0, 1), direction / length);
+        glm::mat4 transform = glm::translate(glm::mat4(1), from) * glm::toMat4(rotation) * glm::scale(glm::mat4(1), glm::vec3(length));
+        drawShape(DebugShape::ARROW, transform, color, lifetime);
+    }
+
+    void DebugRenderer::clearPersistent() {
+        m_persistentLines.clear();
+        for (auto& shapes : m_persistentShapes) {
+            shapes.clear();
+        }
+        m_persistentVersion++;
+    }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "Graphics/DynamicResolution.h"
+
+// Weight of the newest frame in the smoothed frame time
+#define DYNAMIC_RESOLUTION_SMOOTHING 0.2f
+
+namespace sa {
+
+	void DynamicResolution::setScale(float scale) {
+		scale = std::clamp(scale, m_settings.minScale, std::min(m_settings.maxScale, 1.0f));
+		if (scale == m_scale)
+			return;
+		// The cost follows the pixel count, predict it so the next frames still in flight do not scale again
+		const float ratio = scale / m_scale;
+		m_smoothedFrameTime *= ratio * ratio;
+		m_scale = scale;
+		m_framesBelowThreshold = 0;
+	}
+
+	DynamicResolution::DynamicResolution()
+		: m_scale(1.0f)
+		, m_smoothedFrameTime(0.0f)
+		, m_framesBelowThreshold(0)
+		, m_lastFrameBeginTime(0)
+	{
+	}
+
+	bool DynamicResolution::update(const GpuFrameTimestamps& timestamps) {
+		const float oldScale = m_scale;
+		if (!m_settings.isEnabled) {
+			m_scale = 1.0f;
+			m_smoothedFrameTime = 0.0f;
+			return m_scale != oldScale;
+		}
+
+		if (timestamps.cpuBeginTime == m_lastFrameBeginTime || timestamps.frameTimeMs <= 0.0)
+			return false;
+		m_lastFrameBeginTime = timestamps.cpuBeginTime;
+
+		const float frameTime = static_cast<float>(timestamps.frameTimeMs);
+		if (m_smoothedFrameTime <= 0.0f)
+			m_smoothedFrameTime = frameTime;
+		else
+			m_smoothedFrameTime += (frameTime - m_smoothedFrameTime) * DYNAMIC_RESOLUTION_SMOOTHING;
+
+		if (m_smoothedFrameTime > m_settings.targetFrameTime) {
+			// Straight to the scale that fits the budget, at least one step down
+			const float fittingScale = m_scale * std::sqrt(m_settings.targetFrameTime / m_smoothedFrameTime);
+			const float steppedScale = std::floor(fittingScale / DYNAMIC_RESOLUTION_SCALE_STEP) * DYNAMIC_RESOLUTION_SCALE_STEP;
+			setScale(std::min(steppedScale, m_scale - DYNAMIC_RESOLUTION_SCALE_STEP));
+		}
+		else if (m_smoothedFrameTime < m_settings.targetFrameTime * m_settings.increaseThreshold) {
+			m_framesBelowThreshold++;
+			if (m_framesBelowThreshold >= m_settings.increaseDelay) {
+				setScale(m_scale + DYNAMIC_RESOLUTION_SCALE_STEP);
+				m_framesBelowThreshold = 0;
+			}
+		}
+		else {
+			m_framesBelowThreshold = 0;
+		}
+
+		return m_scale != oldScale;
+	}
+
+	float DynamicResolution::getScale() const {
+		return m_scale;
+	}
+
+	const DynamicResolutionSettings& DynamicResolution::getSettings() const {
+		return m_settings;
+	}
+
+	void DynamicResolution::setSettings(const DynamicResolutionSettings& settings) {
+		m_settings = settings;
+		m_framesBelowThreshold = 0;
+		if (m_settings.isEnabled)
+			setScale(m_scale);
+	}
+
+}
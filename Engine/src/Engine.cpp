@@ -6,6 +6,7 @@
 #include "Graphics/RenderTechniques/ForwardPlus.h"
 #include "Graphics/RenderLayers/BloomRenderLayer.h"
 #include "Graphics/RenderLayers/ShadowRenderLayer.h"
+#include "Graphics/TextureTable.h"
 
 #include "Lua/Ref.h"
 #include "Tools/Vector.h"
@@ -41,6 +42,11 @@ namespace sa {
 		return stats;
 	}
 
+	FrameStatistics& Engine::GetFrameStatistics() {
+		static FrameStatistics frameStatistics;
+		return frameStatistics;
+	}
+
 	void Engine::collectStatistics(float dt) {
 		auto& stats = GetEngineStatistics();
 		
@@ -70,6 +76,43 @@ namespace sa {
 			m_statsQuery.memoryQueryTimer = 0.0f;
 		}
 
+		const GpuFrameTimestamps& gpuTimestamps = Renderer::Get().getGpuTimestamps();
+		const bool hasNewGpuResult = gpuTimestamps.cpuBeginTime != m_statsQuery.lastGpuFrameBeginTime;
+		if (hasNewGpuResult) {
+			m_statsQuery.lastGpuFrameBeginTime = gpuTimestamps.cpuBeginTime;
+			stats.gpuFrameTime = static_cast<float>(gpuTimestamps.frameTimeMs / 1000.0);
+			stats.gpuScopes = gpuTimestamps.scopes;
+
+#if SA_PROFILER_ENABLE
+			// GPU time is placed relative to when the frame began recording on the CPU, on a separate track
+			Profiler::Result result;
+			result.threadID = SA_PROFILER_GPU_THREAD_ID;
+			result.name = "GPU Frame";
+			result.start = gpuTimestamps.cpuBeginTime;
+			result.end = result.start + static_cast<long long>(gpuTimestamps.frameTimeMs * 1000.0);
+			Profiler::get().writeProfile(result);
+			for (const auto& scope : gpuTimestamps.scopes) {
+				result.name = "GPU " + scope.name;
+				result.start = gpuTimestamps.cpuBeginTime + static_cast<long long>(scope.beginMs * 1000.0);
+				result.end = result.start + static_cast<long long>(scope.durationMs * 1000.0);
+				Profiler::get().writeProfile(result);
+			}
+#endif
+		}
+
+		// Draw statistics are from the last frame drawn, which is the one dt measured
+		DeviceActivityCounters activityCounters = Renderer::Get().getDeviceActivityCounters();
+		FrameRecord record = {};
+		record.cpuTime = dt;
+		// Results do not arrive every frame, repeating the last one would weigh it into the percentiles again
+		record.gpuTime = hasNewGpuResult ? stats.gpuFrameTime : std::numeric_limits<float>::quiet_NaN();
+		record.drawCalls = stats.drawCalls;
+		record.triangleCount = stats.triangleCount;
+		record.uploadCount = activityCounters.uploadCount - m_statsQuery.lastActivityCounters.uploadCount;
+		record.allocationCount = activityCounters.allocationCount - m_statsQuery.lastActivityCounters.allocationCount;
+		m_statsQuery.lastActivityCounters = activityCounters;
+		GetFrameStatistics().recordFrame(record);
+
 	}
 
 	void Engine::setup(sa::RenderWindow* pWindow, bool enableImgui) {
@@ -77,6 +120,8 @@ namespace sa {
 		
 		m_currentScene = nullptr;
 		m_pWindow = pWindow;
+
+		SetShaderCacheDirectory((std::filesystem::path(GetUserCacheDirectory()) / "shader_cache").generic_string().c_str());
 		
 		registerAllComponents();
 
@@ -97,6 +142,7 @@ namespace sa {
 			pWindow->setResizeCallback(std::bind(&Engine::onWindowResize, this, std::placeholders::_1));
 			m_windowExtent = pWindow->getCurrentExtent();
 			m_mainRenderTarget.initialize(this, m_pWindow);
+			m_statsQuery.lastActivityCounters = Renderer::Get().getDeviceActivityCounters();
 		}
 		sink<engine_event::SceneSet>().connect<&Engine::onSceneSet>(this);
 		sink<engine_event::RenderTargetResized>().connect<&Engine::onRenderTargetResize>(this);
@@ -130,12 +176,15 @@ namespace sa {
 		auto& stats = GetEngineStatistics();
 		stats.drawCalls = 0;
 		stats.dispatchCalls = 0;
+		stats.triangleCount = 0;
 
 		RenderContext context = m_pWindow->beginFrame();
 		if (!context)
 			return;
+		TextureTable::Get().beginFrame();
 		
 		Scene* pCurrentScene = getCurrentScene();
+		m_mainRenderTarget.getDynamicResolution().update(Renderer::Get().getGpuTimestamps());
 		m_mainRenderTarget.sync(context);
 		if (pCurrentScene) {
 			pCurrentScene->render(context, m_renderPipeline, m_mainRenderTarget);
@@ -145,7 +194,7 @@ namespace sa {
 		if (pCurrentScene)
 			pCurrentScene->getDynamicSceneCollection().swap();
 
-		m_pWindowRenderer->render(context, m_mainRenderTarget.getOutputTexture());
+		m_pWindowRenderer->render(context, m_mainRenderTarget);
 		{
 			SA_PROFILE_SCOPE("Display");
 			m_pWindow->display();
@@ -156,6 +205,10 @@ namespace sa {
 		return m_renderPipeline;
 	}
 
+	RenderTarget& Engine::getMainRenderTarget() {
+		return m_mainRenderTarget;
+	}
+
 	const RenderTarget& Engine::getMainRenderTarget() const {
 		return m_mainRenderTarget;
 	}
@@ -20,6 +20,10 @@ namespace sa {
 			parent.orphan();
 		}
 
+		m_changedEntities.push_back(target);
+		m_changedEntities.push_back(parent);
+		if (m_parents.count(target))
+			m_changedEntities.push_back(m_parents.at(target));
 		m_parents[target] = parent;
 		for (auto& [prnt, children] : m_children) {
 			size_t e = children.erase(target);
@@ -30,11 +34,15 @@ namespace sa {
 		}
 		
 		m_children[parent].emplace(target);
+		m_version++;
 	}
 
 	void EntityHierarchy::orphan(const Entity& target) {
+		m_changedEntities.push_back(target);
+		m_changedEntities.push_back(m_parents[target]);
 		m_children[m_parents[target]].erase(target);
 		m_parents.erase(target);
+		m_version++;
 	}
 
 	const Entity& EntityHierarchy::getParent(const Entity& child) const {
@@ -57,6 +65,8 @@ namespace sa {
 	void EntityHierarchy::clear() {
 		m_children.clear();
 		m_parents.clear();
+		m_changedEntities.clear();
+		m_version++;
 	}
 
 	void EntityHierarchy::freeMemory() {
@@ -97,4 +107,14 @@ namespace sa {
 				func(parent);
 		}
 	}
+
+	uint64_t EntityHierarchy::getVersion() const {
+		return m_version;
+	}
+
+	std::vector<Entity> EntityHierarchy::takeChangedEntities() {
+		std::vector<Entity> changedEntities;
+		changedEntities.swap(m_changedEntities);
+		return changedEntities;
+	}
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Engine.h"
 
 #include "Graphics\DebugRenderer.h"
+#include "Graphics/TextureTable.h"
 
 namespace sa {
 	void ForwardPlus::createPreDepthPass() {
@@ -21,6 +22,19 @@ namespace sa {
 			.endSubpass()
 			.end();
 
+		if (m_depthPreLoadRenderProgram != NULL_RESOURCE) {
+			m_renderer.destroyRenderProgram(m_depthPreLoadRenderProgram);
+			m_depthPreLoadRenderProgram = NULL_RESOURCE;
+		}
+
+		// Compatible with the depth framebuffer and the depth pipelines of the prepass
+		m_depthPreLoadRenderProgram = m_renderer.createRenderProgram()
+			.addDepthAttachment(AttachmentFlagBits::eLoad | AttachmentFlagBits::eStore)
+			.beginSubpass()
+			.addAttachmentReference(0, SubpassAttachmentUsage::DepthTarget)
+			.endSubpass()
+			.end();
+
 	}
 	
 	void ForwardPlus::createLightCullingShader() {
@@ -34,9 +48,50 @@ namespace sa {
 		m_lightCullingLayout.createFromShaders({ code });
 		m_lightCullingShader.create(code, ShaderStageFlagBits::COMPUTE);
 		m_lightCullingPipeline = m_renderer.createComputePipeline(m_lightCullingShader, m_lightCullingLayout);
+
+		if (m_tileFrustumPipeline != NULL_RESOURCE) {
+			m_renderer.destroyPipeline(m_tileFrustumPipeline);
+			m_tileFrustumPipeline = NULL_RESOURCE;
+		}
+
+		code = ReadSPVFile((Engine::GetShaderDirectory() / "LightTileFrustums.comp.spv").generic_string().c_str());
+		m_tileFrustumLayout.createFromShaders({ code });
+		m_tileFrustumShader.create(code, ShaderStageFlagBits::COMPUTE);
+		m_tileFrustumPipeline = m_renderer.createComputePipeline(m_tileFrustumShader, m_tileFrustumLayout);
+
+		if (m_lightBoundsPipeline != NULL_RESOURCE) {
+			m_renderer.destroyPipeline(m_lightBoundsPipeline);
+			m_lightBoundsPipeline = NULL_RESOURCE;
+		}
+
+		code = ReadSPVFile((Engine::GetShaderDirectory() / "LightBounds.comp.spv").generic_string().c_str());
+		m_lightBoundsLayout.createFromShaders({ code });
+		m_lightBoundsShader.create(code, ShaderStageFlagBits::COMPUTE);
+		m_lightBoundsPipeline = m_renderer.createComputePipeline(m_lightBoundsShader, m_lightBoundsLayout);
 		
 	}
 
+	void ForwardPlus::createOcclusionCullingShaders() {
+		if (m_hiZReducePipeline != NULL_RESOURCE) {
+			m_renderer.destroyPipeline(m_hiZReducePipeline);
+			m_hiZReducePipeline = NULL_RESOURCE;
+		}
+		if (m_occlusionCullingPipeline != NULL_RESOURCE) {
+			m_renderer.destroyPipeline(m_occlusionCullingPipeline);
+			m_occlusionCullingPipeline = NULL_RESOURCE;
+		}
+
+		auto code = ReadSPVFile((Engine::GetShaderDirectory() / "HiZReduce.comp.spv").generic_string().c_str());
+		m_hiZReduceLayout.createFromShaders({ code });
+		m_hiZReduceShader.create(code, ShaderStageFlagBits::COMPUTE);
+		m_hiZReducePipeline = m_renderer.createComputePipeline(m_hiZReduceShader, m_hiZReduceLayout);
+
+		code = ReadSPVFile((Engine::GetShaderDirectory() / "OcclusionCulling.comp.spv").generic_string().c_str());
+		m_occlusionCullingLayout.createFromShaders({ code });
+		m_occlusionCullingShader.create(code, ShaderStageFlagBits::COMPUTE);
+		m_occlusionCullingPipeline = m_renderer.createComputePipeline(m_occlusionCullingShader, m_occlusionCullingLayout);
+	}
+
 	void ForwardPlus::createColorPass() {
 		
 		if (m_colorRenderProgram != NULL_RESOURCE) {
@@ -58,6 +113,19 @@ namespace sa {
 
 	}
 
+	void ForwardPlus::createTextureTable() {
+		// Defined like the table of the material shaders, so the set is compatible with every material pipeline layout.
+		// A pipeline layout needs every set below the table
+		m_textureTableLayout.beginDescriptorSet(SET_PER_FRAME).endDescriptorSet();
+		m_textureTableLayout.beginDescriptorSet(SET_TEXTURE_TABLE)
+			.addBinding(0, DescriptorType::SAMPLED_IMAGE, VARIABLE_DESCRIPTOR_COUNT, ShaderStageFlagBits::FRAGMENT, 0)
+			.endDescriptorSet();
+		m_textureTableLayout.create();
+
+		m_textureTableDescriptorSet = m_textureTableLayout.allocateDescriptorSet(SET_TEXTURE_TABLE);
+		m_textureTableRevisions.clear();
+	}
+
 	void ForwardPlus::createSkyboxPipeline() {
 		Image skyboxImage("resources/skybox.png");
 
@@ -117,22 +185,40 @@ namespace sa {
 
 		// Light culling pass
 		data.tileCount = { extent.width, extent.height };
-		data.tileCount += (TILE_SIZE - data.tileCount % TILE_SIZE);
-		data.tileCount /= TILE_SIZE;
+		data.tileCount = (data.tileCount + TILE_SIZE - 1U) / TILE_SIZE;
 
 		size_t totalTileCount = data.tileCount.x * data.tileCount.y;
 		if (data.lightCullingDescriptorSet == NULL_RESOURCE)
 			data.lightCullingDescriptorSet = m_lightCullingLayout.allocateDescriptorSet(0);
+		if (data.tileFrustumDescriptorSet == NULL_RESOURCE)
+			data.tileFrustumDescriptorSet = m_tileFrustumLayout.allocateDescriptorSet(0);
+		if (data.lightBoundsDescriptorSet == NULL_RESOURCE)
+			data.lightBoundsDescriptorSet = m_lightBoundsLayout.allocateDescriptorSet(0);
 
 		data.lightIndexBuffer.create(BufferType::STORAGE, sizeof(uint32_t) * MAX_LIGHTS_PER_TILE * totalTileCount);
+		data.tileLightCountBuffer.create(BufferType::STORAGE, sizeof(uint32_t) * totalTileCount);
+		data.tileFrustumBuffer.create(BufferType::STORAGE, sizeof(glm::vec4) * 4 * totalTileCount);
+		data.tileFrustumProjections.assign(data.tileFrustumBuffer.getBufferCount(), glm::mat4(0.0f)); // forces a rebuild
+		data.tileFrustumScreenSizes.assign(data.tileFrustumBuffer.getBufferCount(), glm::uvec2(0));
+		data.lightBoundsBuffer.create(BufferType::STORAGE);
 
 		// Color pass
 		const DynamicTexture textures[] = { data.colorTexture, data.depthTexture };
 		data.colorFramebuffer = m_renderer.createFramebuffer(m_colorRenderProgram, textures, 2);
 
 
-		m_renderer.updateDescriptorSet(data.lightCullingDescriptorSet, 0, data.depthTexture, m_linearSampler);	// read depth texture
+		m_renderer.updateDescriptorSet(data.lightCullingDescriptorSet, 0, data.depthTexture, m_nearestSampler);	// read depth texture
 		m_renderer.updateDescriptorSet(data.lightCullingDescriptorSet, 1, data.lightIndexBuffer);		// write what lights are in what tiles
+		m_renderer.updateDescriptorSet(data.lightCullingDescriptorSet, 4, data.tileLightCountBuffer);
+
+		// Hi-Z pyramid, level 0 is half the depth resolution and the last level is 1x1
+		Extent hiZExtent = {
+			std::max(extent.width >> 1, 1U),
+			std::max(extent.height >> 1, 1U)
+		};
+		uint32_t hiZMipCount = static_cast<uint32_t>(std::floor(std::log2(std::max(hiZExtent.width, hiZExtent.height)))) + 1;
+		data.hiZTexture.create2D(TextureUsageFlagBits::STORAGE | TextureUsageFlagBits::SAMPLED, hiZExtent, Format::R32_SFLOAT, hiZMipCount);
+		data.hiZMipTextures = data.hiZTexture.createMipLevelTextures();
 
 		// ----------- DEBUG -------------------
 
@@ -140,7 +226,7 @@ namespace sa {
 		if(data.debugLightHeatmapDescriptorSet == NULL_RESOURCE) {
 			data.debugLightHeatmapDescriptorSet = m_debugHeatmapLayout.allocateDescriptorSet(0);
 		}
-		m_renderer.updateDescriptorSet(data.debugLightHeatmapDescriptorSet, 0, data.lightIndexBuffer);
+		m_renderer.updateDescriptorSet(data.debugLightHeatmapDescriptorSet, 0, data.tileLightCountBuffer);
 
 		data.debugLightHeatmapFramebuffer = m_renderer.createFramebuffer(m_debugLightHeatmapRenderProgram, &data.debugLightHeatmap, 1);
 		// ----------------------------------
@@ -162,6 +248,20 @@ namespace sa {
 
 		if (data.lightIndexBuffer.isValid())
 			data.lightIndexBuffer.destroy();
+		if (data.tileLightCountBuffer.isValid())
+			data.tileLightCountBuffer.destroy();
+		if (data.tileFrustumBuffer.isValid())
+			data.tileFrustumBuffer.destroy();
+		if (data.lightBoundsBuffer.isValid())
+			data.lightBoundsBuffer.destroy();
+
+		if (data.hiZTexture.isValid()) {
+			for (auto& tex : data.hiZMipTextures) {
+				tex.destroy();
+			}
+			data.hiZMipTextures.clear();
+			data.hiZTexture.destroy();
+		}
 
 		if (data.colorFramebuffer != NULL_RESOURCE) {
 			m_renderer.destroyFramebuffer(data.colorFramebuffer);
@@ -179,19 +279,19 @@ namespace sa {
 		
 	}
 
-	void ForwardPlus::bindShadows(const RenderContext& context, const SceneCollection& sc, const MaterialShaderCollection& collection) {
+	void ForwardPlus::bindShadows(const RenderContext& context, const SceneCollection& sc, ResourceID descriptorSet) {
 		if (m_pShadowRenderLayer && m_pShadowRenderLayer->isActive()) {
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 5, sc.getShadowDataBuffer());
+			context.updateDescriptorSet(descriptorSet, 5, sc.getShadowDataBuffer());
 
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 7, m_pShadowRenderLayer->getPreferencesBuffer());
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(),
+			context.updateDescriptorSet(descriptorSet, 7, m_pShadowRenderLayer->getPreferencesBuffer());
+			context.updateDescriptorSet(descriptorSet,
 				8,
 				sc.getShadowTextures().data(),
 				sc.getShadowTextureCount(),
 				m_pShadowRenderLayer->getShadowSampler(),
 				0
 			);
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(),
+			context.updateDescriptorSet(descriptorSet,
 				9,
 				sc.getShadowCubeTextures().data(),
 				sc.getShadowCubeTextureCount(),
@@ -209,9 +309,183 @@ namespace sa {
 			if (!m_defaultShadowDataBuffer.isValid()) {
 				m_defaultShadowDataBuffer.create(BufferType::STORAGE);
 			}
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 5, m_defaultShadowDataBuffer);
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 7, m_defaultShadowPreferencesBuffer);
+			context.updateDescriptorSet(descriptorSet, 5, m_defaultShadowDataBuffer);
+			context.updateDescriptorSet(descriptorSet, 7, m_defaultShadowPreferencesBuffer);
+		}
+	}
+
+	void ForwardPlus::updateTextureTable(const RenderContext& context) {
+		TextureTable& textureTable = TextureTable::Get();
+		const std::vector<Texture>& textures = textureTable.getTextures();
+		const uint64_t revision = textureTable.getRevision();
+
+		const uint32_t frameIndex = context.getFrameIndex();
+		if (m_textureTableRevisions.size() <= frameIndex)
+			m_textureTableRevisions.resize(frameIndex + 1, UINT64_MAX);
+		if (m_textureTableRevisions[frameIndex] == revision)
+			return;
+
+		context.updateDescriptorSet(m_textureTableDescriptorSet, 0, textures, 0);
+		m_textureTableRevisions[frameIndex] = revision;
+	}
+
+	void ForwardPlus::buildHiZ(RenderContext& context, ForwardPlusRenderData& data) {
+		context.bindPipelineLayout(m_hiZReduceLayout);
+		context.bindPipeline(m_hiZReducePipeline);
+		const uint32_t frameIndex = context.getFrameIndex();
+		for (size_t i = 0; i < data.hiZMipTextures.size(); i++) {
+			if (i > 0) {
+				context.barrier(data.hiZTexture, Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ_WRITE);
+			}
+			const Extent mipExtent = data.hiZMipTextures[i].getExtent();
+			// The sets are cached by the textures they hold, so they survive resizes and are shared between frames
+			DescriptorSetResources resources;
+			resources.bind(0, i == 0 ? data.depthTexture.getTexture(frameIndex) : data.hiZMipTextures[i - 1].getTexture(frameIndex), m_nearestSampler);
+			resources.bind(1, data.hiZMipTextures[i].getTexture(frameIndex));
+			context.bindDescriptorSet(m_hiZReduceLayout.getCachedDescriptorSet(0, resources));
+			context.dispatch(
+				static_cast<uint32_t>(std::ceil(mipExtent.width / 16.f)),
+				static_cast<uint32_t>(std::ceil(mipExtent.height / 16.f)),
+				1);
+		}
+		Engine::GetEngineStatistics().dispatchCalls += data.hiZMipTextures.size();
+	}
+
+	void ForwardPlus::cullObjects(RenderContext& context, ForwardPlusRenderData& data, MaterialShaderCollection& collection, const OcclusionCullingPushConstants& pushConstants) {
+		if (pushConstants.objectCount == 0)
+			return;
+
+		const ResourceID descriptorSet = m_occlusionCullingLayout.allocateTransientDescriptorSet(0);
+
+		context.updateDescriptorSet(descriptorSet, 0, collection.getCullDataBuffer());
+		context.updateDescriptorSet(descriptorSet, 1, collection.getCulledDrawCommandBuffer());
+		context.updateDescriptorSet(descriptorSet, 2, collection.getInstanceIndexBuffer());
+		context.updateDescriptorSet(descriptorSet, 3, collection.getPreviousVisibilityBuffer());
+		context.updateDescriptorSet(descriptorSet, 4, collection.getVisibilityBuffer());
+		context.updateDescriptorSet(descriptorSet, 5, data.hiZTexture, m_nearestSampler);
+
+		context.bindPipelineLayout(m_occlusionCullingLayout);
+		context.bindPipeline(m_occlusionCullingPipeline);
+		context.bindDescriptorSet(descriptorSet);
+		context.pushConstant(ShaderStageFlagBits::COMPUTE, pushConstants);
+		context.dispatch((pushConstants.objectCount + OCCLUSION_CULLING_GROUP_SIZE - 1) / OCCLUSION_CULLING_GROUP_SIZE, 1, 1);
+		Engine::GetEngineStatistics().dispatchCalls++;
+	}
+
+	void ForwardPlus::renderDepthPrepass(RenderContext& context, ResourceID renderProgram, ForwardPlusRenderData& data, RenderTarget* pRenderTarget, SceneCollection& sc, InstanceList instanceList, const PerFrameBuffer& perFrame, const Rect& viewport) {
+		context.beginRenderProgram(renderProgram, data.depthFramebuffer, SubpassContents::DIRECT);
+		for (auto& collection : sc) {
+			if (!collection.readyDescriptorSets(context)) {
+				continue;
+			}
+			
+			collection.recreatePipelines(m_colorRenderProgram, m_depthPreRenderProgram, pRenderTarget->getExtent());
+
+			collection.bindDepthPipeline(context);
+
+			context.bindVertexBuffers(0, &collection.getVertexBuffer(), 1);
+			context.bindIndexBuffer(collection.getIndexBuffer());
+
+			context.setViewport(viewport);
+			context.setScissor(viewport);
+			context.setDepthBiasEnable(false);
+			context.setDepthBias(0.0f, 0.0f, 0.0f);
+			context.setCullMode(sa::CullModeFlagBits::BACK);
+
+			context.bindDescriptorSet(collection.getSceneDescriptorSetDepthPass());
+
+			context.pushConstant(ShaderStageFlagBits::VERTEX, perFrame);
+			drawCollection(context, collection, instanceList);
+		}
+		context.endRenderProgram(renderProgram);
+	}
+
+	void ForwardPlus::drawCollection(const RenderContext& context, const MaterialShaderCollection& collection, InstanceList instanceList) {
+		size_t drawCallCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
+		if (drawCallCount == 0)
+			return;
+
+		if (instanceList == InstanceList::ALL) {
+			context.drawIndexedIndirect(collection.getDrawCommandBuffer(), 0, drawCallCount, sizeof(DrawIndexedIndirectCommand));
+		}
+		else {
+			context.drawIndexedIndirect(collection.getCulledDrawCommandBuffer(), collection.getCulledDrawCommandOffset(instanceList), drawCallCount, sizeof(DrawIndexedIndirectCommand));
+		}
+		Engine::GetEngineStatistics().drawCalls += drawCallCount;
+		// Instance counts of culled draws are only known by the GPU, so this is an upper bound
+		Engine::GetEngineStatistics().triangleCount += collection.getTriangleCount();
+	}
+
+	void ForwardPlus::cullLights(RenderContext& context, ForwardPlusRenderData& data, SceneCamera* pCamera, SceneCollection& sc, Extent renderExtent) {
+		const glm::mat4 projection = pCamera->getProjectionMatrix();
+		const glm::mat4 inverseProjection = glm::inverse(projection);
+		const glm::uvec2 screenSize = { renderExtent.width, renderExtent.height };
+
+		// Tile frustums only depend on the projection and the rendered extent
+		const uint32_t frustumBufferIndex = data.tileFrustumBuffer.getBufferIndex();
+		context.updateDescriptorSet(data.tileFrustumDescriptorSet, 0, data.tileFrustumBuffer.getBuffer());
+		if (data.tileFrustumProjections[frustumBufferIndex] != projection || data.tileFrustumScreenSizes[frustumBufferIndex] != screenSize) {
+			TileFrustumPushConstants pushConstants = {};
+			pushConstants.inverseProjection = inverseProjection;
+			pushConstants.screenSize = screenSize;
+			pushConstants.tileCount = data.tileCount;
+
+			context.bindPipelineLayout(m_tileFrustumLayout);
+			context.bindPipeline(m_tileFrustumPipeline);
+			context.bindDescriptorSet(data.tileFrustumDescriptorSet);
+			context.pushConstant(ShaderStageFlagBits::COMPUTE, pushConstants);
+			context.dispatch(
+				static_cast<uint32_t>(std::ceil(data.tileCount.x / 16.f)),
+				static_cast<uint32_t>(std::ceil(data.tileCount.y / 16.f)),
+				1);
+			Engine::GetEngineStatistics().dispatchCalls++;
+
+			context.barrier(data.tileFrustumBuffer.getBuffer(), Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ);
+			data.tileFrustumProjections[frustumBufferIndex] = projection;
+			data.tileFrustumScreenSizes[frustumBufferIndex] = screenSize;
+		}
+
+		// Light bounds in view space
+		const uint32_t lightCount = sc.getLightCount();
+		data.lightBoundsBuffer.reserve(std::max(lightCount, 1U) * sizeof(glm::vec4), IGNORE_CONTENT);
+		if (lightCount > 0) {
+			context.updateDescriptorSet(data.lightBoundsDescriptorSet, 0, sc.getLightBuffer());
+			context.updateDescriptorSet(data.lightBoundsDescriptorSet, 1, data.lightBoundsBuffer.getBuffer());
+
+			context.bindPipelineLayout(m_lightBoundsLayout);
+			context.bindPipeline(m_lightBoundsPipeline);
+			context.bindDescriptorSet(data.lightBoundsDescriptorSet);
+			context.pushConstant(ShaderStageFlagBits::COMPUTE, pCamera->getViewMatrix());
+			context.dispatch((lightCount + 63) / 64, 1, 1);
+			Engine::GetEngineStatistics().dispatchCalls++;
+
+			context.barrier(data.lightBoundsBuffer.getBuffer(), Transition::COMPUTE_SHADER_WRITE, Transition::COMPUTE_SHADER_READ);
 		}
+
+		// Light culling
+		context.updateDescriptorSet(data.lightCullingDescriptorSet, 1, data.lightIndexBuffer.getBuffer());
+		context.updateDescriptorSet(data.lightCullingDescriptorSet, 2, data.lightBoundsBuffer.getBuffer());
+		context.updateDescriptorSet(data.lightCullingDescriptorSet, 3, data.tileFrustumBuffer.getBuffer());
+		context.updateDescriptorSet(data.lightCullingDescriptorSet, 4, data.tileLightCountBuffer.getBuffer());
+
+		LightCullingPushConstants pushConstants = {};
+		// Rows of the inverse projection that give view space z and w from depth
+		pushConstants.depthUnproject = { inverseProjection[2][2], inverseProjection[3][2], inverseProjection[2][3], inverseProjection[3][3] };
+		pushConstants.lightCount = lightCount;
+		pushConstants.tileCountX = data.tileCount.x;
+		pushConstants.screenSize = screenSize;
+
+		context.bindPipelineLayout(m_lightCullingLayout);
+		context.bindPipeline(m_lightCullingPipeline);
+		context.bindDescriptorSet(data.lightCullingDescriptorSet);
+		context.pushConstant(ShaderStageFlagBits::COMPUTE, pushConstants);
+
+		// Only the tiles covering the rendered extent, the others are never read
+		context.dispatch(
+			std::min((screenSize.x + TILE_SIZE - 1U) / TILE_SIZE, data.tileCount.x),
+			std::min((screenSize.y + TILE_SIZE - 1U) / TILE_SIZE, data.tileCount.y),
+			1);
+		Engine::GetEngineStatistics().dispatchCalls++;
 	}
 
 	ForwardPlus::ForwardPlus(const RenderPipeline& renderPipeline) : IRenderLayer() {
@@ -237,7 +511,9 @@ namespace sa {
 
 		createPreDepthPass();
 		createLightCullingShader();
+		createOcclusionCullingShaders();
 		createColorPass();
+		createTextureTable();
 
 		createSkyboxPipeline();
 
@@ -275,6 +551,22 @@ namespace sa {
 
 	void ForwardPlus::cleanup() {
 		m_lightCullingShader.destroy();
+		m_tileFrustumShader.destroy();
+		m_tileFrustumLayout.destroy();
+		m_renderer.destroyPipeline(m_tileFrustumPipeline);
+		m_lightBoundsShader.destroy();
+		m_lightBoundsLayout.destroy();
+		m_renderer.destroyPipeline(m_lightBoundsPipeline);
+
+		m_hiZReduceShader.destroy();
+		m_hiZReduceLayout.destroy();
+		m_renderer.destroyPipeline(m_hiZReducePipeline);
+		m_occlusionCullingShader.destroy();
+		m_occlusionCullingLayout.destroy();
+		m_renderer.destroyPipeline(m_occlusionCullingPipeline);
+
+		m_textureTableLayout.destroy();
+		m_textureTableDescriptorSet = NULL_RESOURCE;
 
 		m_debugHeatmapLayout.destroy();
 		m_debugHeatmapVertexShader.destroy();
@@ -287,7 +579,11 @@ namespace sa {
 
 	}
 
-	bool ForwardPlus::render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sc) {
+	const char* ForwardPlus::getName() const {
+		return "ForwardPlus";
+	}
+
+	bool ForwardPlus::addRenderPasses(RenderGraph& graph, const std::string& name, RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sc) {
 		SA_PROFILE_FUNCTION();
 		if (!pCamera)
 			return false;
@@ -300,20 +596,23 @@ namespace sa {
 		}
 		data.depthTexture.sync(context);
 		data.colorTexture.sync(context);
+		data.debugLightHeatmap.sync(context);
 
 		context.syncFramebuffer(data.colorFramebuffer);
 		context.syncFramebuffer(data.depthFramebuffer);
 		context.syncFramebuffer(data.debugLightHeatmapFramebuffer);
 
+		// Textures are allocated at the full extent, dynamic resolution only shrinks the part rendered to
+		const Extent renderExtent = pRenderTarget->getRenderExtent();
 		Rectf cameraViewport = pCamera->getViewport();
 		Rect viewport = {
 			{
-				static_cast<int32_t>(cameraViewport.offset.x * pRenderTarget->getExtent().width),
-				static_cast<int32_t>(cameraViewport.offset.y * pRenderTarget->getExtent().height)
+				static_cast<int32_t>(cameraViewport.offset.x * renderExtent.width),
+				static_cast<int32_t>(cameraViewport.offset.y * renderExtent.height)
 			},
 			{
-				static_cast<uint32_t>(cameraViewport.extent.x * pRenderTarget->getExtent().width),
-				static_cast<uint32_t>(cameraViewport.extent.y * pRenderTarget->getExtent().height)
+				static_cast<uint32_t>(cameraViewport.extent.x * renderExtent.width),
+				static_cast<uint32_t>(cameraViewport.extent.y * renderExtent.height)
 			}
 		};
 		if ((viewport.extent.height & viewport.extent.width) == 0) {
@@ -325,120 +624,210 @@ namespace sa {
 		perFrame.projMat = pCamera->getProjectionMatrix();
 		perFrame.viewPos = glm::vec4(pCamera->getPosition(), 1.0f);
 
-		
-
-		context.beginRenderProgram(m_depthPreRenderProgram, data.depthFramebuffer, SubpassContents::DIRECT);
-		for (auto& collection : sc) {
-			if (!collection.readyDescriptorSets(context)) {
-				continue;
+		const bool occlusionCulling = m_preferences.occlusionCulling;
+		OcclusionCullingPushConstants cullingPushConstants = {};
+		cullingPushConstants.viewProjection = perFrame.projMat * perFrame.viewMat;
+		cullingPushConstants.viewport = glm::vec4(viewport.offset.x, viewport.offset.y, viewport.extent.width, viewport.extent.height);
+
+		// Render programs transition their attachments themselves
+		const RenderGraphResource depth = graph.importTexture("Depth", data.depthTexture.getTexture(), Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
+		const RenderGraphResource color = graph.importTexture("SceneColor", data.colorTexture.getTexture(), Transition::RENDER_PROGRAM_OUTPUT);
+		const RenderGraphResource heatmap = graph.importTexture("Light heatmap", data.debugLightHeatmap.getTexture(), Transition::RENDER_PROGRAM_OUTPUT);
+		const RenderGraphResource lightIndices = graph.importBuffer("Light indices", data.lightIndexBuffer.getBuffer(), Transition::NONE);
+		const RenderGraphResource tileLightCounts = graph.importBuffer("Tile light counts", data.tileLightCountBuffer.getBuffer(), Transition::NONE);
+
+		graph.markOutput(color);
+		if (data.renderDebugHeatmap)
+			graph.markOutput(heatmap);
+
+		// Buffers written by occlusion culling, read by the draws
+		struct CulledCollection {
+			RenderGraphResource drawCommands;
+			RenderGraphResource instanceIndices;
+			RenderGraphResource visibility;
+		};
+		std::vector<CulledCollection> culledCollections;
+		if (occlusionCulling) {
+			data.hiZTexture.sync(context);
+			for (auto& tex : data.hiZMipTextures) {
+				tex.sync(context);
 			}
-			
-			collection.recreatePipelines(m_colorRenderProgram, m_depthPreRenderProgram, pRenderTarget->getExtent());
-
-			// Depth prepass
-			
-			collection.bindDepthPipeline(context);
-
-			context.bindVertexBuffers(0, &collection.getVertexBuffer(), 1);
-			context.bindIndexBuffer(collection.getIndexBuffer());
-
-			context.setViewport(viewport);
-			context.setScissor(viewport);
-			context.setDepthBiasEnable(false);
-			context.setDepthBias(0.0f, 0.0f, 0.0f);
-			context.setCullMode(sa::CullModeFlagBits::BACK);
-
-			context.bindDescriptorSet(collection.getSceneDescriptorSetDepthPass());
-
-
-			if (collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>() > 0) {
-				context.pushConstant(ShaderStageFlagBits::VERTEX, perFrame);
-				size_t drawCallCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
-				context.drawIndexedIndirect(collection.getDrawCommandBuffer(), 0, drawCallCount, sizeof(DrawIndexedIndirectCommand));
-				Engine::GetEngineStatistics().drawCalls += drawCallCount;
+			for (auto& collection : sc) {
+				if (!collection.readyDescriptorSets(context) || collection.getInstanceCount() == 0)
+					continue;
+				culledCollections.push_back({
+					graph.importBuffer("Culled draw commands", collection.getCulledDrawCommandBuffer(), Transition::NONE),
+					graph.importBuffer("Instance indices", collection.getInstanceIndexBuffer(), Transition::NONE),
+					graph.importBuffer("Visibility", collection.getVisibilityBuffer(), Transition::NONE)
+				});
 			}
 		}
+		auto writeCulledCollections = [culledCollections](RenderGraph::PassBuilder& builder) {
+			for (const auto& culled : culledCollections) {
+				builder.write(culled.drawCommands, Transition::COMPUTE_SHADER_READ_WRITE);
+				builder.write(culled.instanceIndices, Transition::COMPUTE_SHADER_WRITE);
+				builder.write(culled.visibility, Transition::COMPUTE_SHADER_WRITE);
+			}
+		};
+		auto readCulledCollections = [culledCollections](RenderGraph::PassBuilder& builder) {
+			for (const auto& culled : culledCollections) {
+				builder.read(culled.drawCommands, Transition::INDIRECT_READ);
+				builder.read(culled.instanceIndices, Transition::VERTEX_SHADER_READ);
+			}
+		};
 
-		context.endRenderProgram(m_depthPreRenderProgram);
-
-		
-		context.barrier(data.depthTexture, Transition::RENDER_PROGRAM_DEPTH_OUTPUT, Transition::COMPUTE_SHADER_READ);
-
-		context.updateDescriptorSet(data.lightCullingDescriptorSet, 1, data.lightIndexBuffer.getBuffer());
-		context.updateDescriptorSet(data.lightCullingDescriptorSet, 2, sc.getLightBuffer());
+		if (occlusionCulling) {
+			const RenderGraphResource hiZ = graph.importTexture("Hi-Z", data.hiZTexture.getTexture(), Transition::NONE);
+
+			// Phase 1, objects that were visible last frame
+			graph.addPass("Occlusion culling (last frame)", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+				builder.read(hiZ, Transition::COMPUTE_SHADER_READ_WRITE);
+				writeCulledCollections(builder);
+			}, [=, this, &data, &sc](RenderContext& context) mutable {
+				cullingPushConstants.phase = OCCLUSION_CULLING_PHASE_VISIBLE_LAST_FRAME;
+				for (auto& collection : sc) {
+					if (!collection.readyDescriptorSets(context)) {
+						continue;
+					}
+					cullingPushConstants.objectCount = collection.getInstanceCount();
+					cullingPushConstants.drawCommandCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
+					cullObjects(context, data, collection, cullingPushConstants);
+				}
+				return true;
+			});
+
+			graph.addPass("Depth prepass", RenderGraphQueue::GRAPHICS, [&](RenderGraph::PassBuilder& builder) {
+				readCulledCollections(builder);
+				builder.write(depth, Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
+			}, [=, this, &data, &sc](RenderContext& context) {
+				renderDepthPrepass(context, m_depthPreRenderProgram, data, pRenderTarget, sc, InstanceList::VISIBLE_LAST_FRAME, perFrame, viewport);
+				return true;
+			});
+
+			graph.addPass("Hi-Z", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+				builder.read(depth, Transition::COMPUTE_SHADER_READ);
+				builder.write(hiZ, Transition::COMPUTE_SHADER_READ_WRITE);
+			}, [=, this, &data](RenderContext& context) {
+				buildHiZ(context, data);
+				return true;
+			});
+
+			// Phase 2, test everything against the pyramid built from the first phase
+			graph.addPass("Occlusion culling (Hi-Z)", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+				builder.read(hiZ, Transition::COMPUTE_SHADER_READ_WRITE);
+				writeCulledCollections(builder);
+			}, [=, this, &data, &sc](RenderContext& context) mutable {
+				cullingPushConstants.phase = OCCLUSION_CULLING_PHASE_HIZ;
+				for (auto& collection : sc) {
+					if (!collection.readyDescriptorSets(context)) {
+						continue;
+					}
+					cullingPushConstants.objectCount = collection.getInstanceCount();
+					cullingPushConstants.drawCommandCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
+					cullObjects(context, data, collection, cullingPushConstants);
+				}
+				return true;
+			});
+
+			// Objects that became visible complete the depth used by light culling
+			graph.addPass("Depth prepass (newly visible)", RenderGraphQueue::GRAPHICS, [&](RenderGraph::PassBuilder& builder) {
+				readCulledCollections(builder);
+				builder.read(depth, Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
+				builder.write(depth, Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
+			}, [=, this, &data, &sc](RenderContext& context) {
+				renderDepthPrepass(context, m_depthPreLoadRenderProgram, data, pRenderTarget, sc, InstanceList::NEWLY_VISIBLE, perFrame, viewport);
+				return true;
+			});
+		}
+		else {
+			graph.addPass("Depth prepass", RenderGraphQueue::GRAPHICS, [&](RenderGraph::PassBuilder& builder) {
+				builder.write(depth, Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
+			}, [=, this, &data, &sc](RenderContext& context) {
+				renderDepthPrepass(context, m_depthPreRenderProgram, data, pRenderTarget, sc, InstanceList::ALL, perFrame, viewport);
+				return true;
+			});
+		}
 
-		// Light culling
-		context.bindPipelineLayout(m_lightCullingLayout);
-		context.bindPipeline(m_lightCullingPipeline);
-		context.bindDescriptorSet(data.lightCullingDescriptorSet);
+		graph.addPass("Light culling", RenderGraphQueue::COMPUTE, [&](RenderGraph::PassBuilder& builder) {
+			builder.read(depth, Transition::COMPUTE_SHADER_READ);
+			builder.write(lightIndices, Transition::COMPUTE_SHADER_WRITE);
+			builder.write(tileLightCounts, Transition::COMPUTE_SHADER_WRITE);
+		}, [=, this, &data, &sc](RenderContext& context) {
+			cullLights(context, data, pCamera, sc, renderExtent);
+			return true;
+		});
 
-		context.pushConstant(ShaderStageFlagBits::COMPUTE, pCamera->getProjectionMatrix());
-		context.pushConstant(ShaderStageFlagBits::COMPUTE, pCamera->getViewMatrix(), sizeof(Matrix4x4));
+		// Main color pass
+		graph.addPass("Color pass", RenderGraphQueue::GRAPHICS, [&](RenderGraph::PassBuilder& builder) {
+			if (occlusionCulling)
+				readCulledCollections(builder);
+			builder.read(depth, Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
+			builder.read(lightIndices, Transition::FRAGMENT_SHADER_READ);
+			builder.read(tileLightCounts, Transition::FRAGMENT_SHADER_READ);
+			builder.write(color, Transition::RENDER_PROGRAM_OUTPUT);
+		}, [=, this, &data, &sc](RenderContext& context) mutable {
+			updateTextureTable(context);
 
-		context.dispatch(data.tileCount.x, data.tileCount.y, 1);
-		Engine::GetEngineStatistics().dispatchCalls++;
+			context.beginRenderProgram(m_colorRenderProgram, data.colorFramebuffer, SubpassContents::DIRECT);
+			for (auto& collection : sc) {
+				if (!collection.readyDescriptorSets(context)) {
+					continue;
+				}
+				collection.bindColorPipeline(context);
 
-		context.barrier(data.depthTexture, Transition::COMPUTE_SHADER_READ, Transition::RENDER_PROGRAM_DEPTH_OUTPUT);
-		context.barrier(data.lightIndexBuffer, Transition::COMPUTE_SHADER_WRITE, Transition::FRAGMENT_SHADER_READ);
-		
-		// Main color pass
-		context.beginRenderProgram(m_colorRenderProgram, data.colorFramebuffer, SubpassContents::DIRECT);
-		for (auto& collection : sc) {
-			if (!collection.readyDescriptorSets(context)) {
-				continue;
-			}
-			collection.bindColorPipeline(context);
+				const ResourceID sceneDescriptorSet = collection.allocateSceneDescriptorSetColorPass(context);
 
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 1, sc.getLightBuffer());
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 4, data.lightIndexBuffer.getBuffer());
-			
-			bindShadows(context, sc, collection);
+				context.updateDescriptorSet(sceneDescriptorSet, 1, sc.getLightBuffer());
+				context.updateDescriptorSet(sceneDescriptorSet, 4, data.lightIndexBuffer.getBuffer());
+				
+				bindShadows(context, sc, sceneDescriptorSet);
 
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 10, m_skybox.cubemap, m_linearSampler);
+				context.updateDescriptorSet(sceneDescriptorSet, 10, m_skybox.cubemap, m_linearSampler);
 
-			context.updateDescriptorSet(collection.getSceneDescriptorSetColorPass(), 6, m_linearSampler);
+				context.updateDescriptorSet(sceneDescriptorSet, 6, m_linearSampler);
 
-			context.bindDescriptorSet(collection.getSceneDescriptorSetColorPass());
+				// Material pipeline layouts may differ in the scene set, which would disturb a table bound only once
+				context.bindDescriptorSets({ sceneDescriptorSet, m_textureTableDescriptorSet });
 
-			context.setViewport(viewport);
+				context.setViewport(viewport);
 
-			if (collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>() > 0) {
 				context.pushConstant(ShaderStageFlagBits::VERTEX | ShaderStageFlagBits::FRAGMENT, perFrame);
 				context.pushConstant(ShaderStageFlagBits::FRAGMENT, data.tileCount.x, sizeof(perFrame));
-				size_t drawCallCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
-				context.drawIndexedIndirect(collection.getDrawCommandBuffer(), 0, drawCallCount, sizeof(DrawIndexedIndirectCommand));
-				Engine::GetEngineStatistics().drawCalls += drawCallCount;
+				drawCollection(context, collection, occlusionCulling ? InstanceList::VISIBLE : InstanceList::ALL);
 			}
-		}
-		
-		//Skybox
-		context.bindPipelineLayout(m_skybox.pipelineLayout);
-		context.bindPipeline(m_skybox.pipeline);
-		context.setViewport(viewport);
-		context.setScissor(viewport);
-		
-		context.bindDescriptorSet(m_skybox.descriptorSet);
-
-		context.bindVertexBuffers(0, &m_skybox.vertexBuffer, 1);
-		context.bindIndexBuffer(m_skybox.indexBuffer);
-		
-		perFrame.viewMat = glm::mat4(glm::mat3(perFrame.viewMat));
-		context.pushConstants(ShaderStageFlagBits::VERTEX, 0, sizeof(glm::mat4) * 2, &perFrame);
-		
-		context.drawIndexed(m_skybox.indexBuffer.getElementCount<uint32_t>(), 1);
-		
+			
+			//Skybox
+			context.bindPipelineLayout(m_skybox.pipelineLayout);
+			context.bindPipeline(m_skybox.pipeline);
+			context.setViewport(viewport);
+			context.setScissor(viewport);
+			
+			context.bindDescriptorSet(m_skybox.descriptorSet);
 
-		//Finally render debug stuff
-		if (!DebugRenderer::Get().isInitialized())
-			DebugRenderer::Get().initialize(m_colorRenderProgram);
+			context.bindVertexBuffers(0, &m_skybox.vertexBuffer, 1);
+			context.bindIndexBuffer(m_skybox.indexBuffer);
+			
+			perFrame.viewMat = glm::mat4(glm::mat3(perFrame.viewMat));
+			context.pushConstants(ShaderStageFlagBits::VERTEX, 0, sizeof(glm::mat4) * 2, &perFrame);
+			
+			context.drawIndexed(m_skybox.indexBuffer.getElementCount<uint32_t>(), 1);
+			
 
-		DebugRenderer::Get().render(context, viewport.extent, *pCamera);
+			//Finally render debug stuff
+			if (!DebugRenderer::Get().isInitialized())
+				DebugRenderer::Get().initialize(m_colorRenderProgram);
 
-		context.endRenderProgram(m_colorRenderProgram);
+			DebugRenderer::Get().render(context, viewport.extent, *pCamera);
 
+			context.endRenderProgram(m_colorRenderProgram);
+			return true;
+		});
 
-		if(data.renderDebugHeatmap) {
-			data.debugLightHeatmap.sync(context);
+		// Culled unless the heatmap is shown
+		graph.addPass("Light heatmap", RenderGraphQueue::GRAPHICS, [&](RenderGraph::PassBuilder& builder) {
+			builder.read(tileLightCounts, Transition::FRAGMENT_SHADER_READ);
+			builder.write(heatmap, Transition::RENDER_PROGRAM_OUTPUT);
+		}, [=, this, &data](RenderContext& context) {
 			context.beginRenderProgram(m_debugLightHeatmapRenderProgram, data.debugLightHeatmapFramebuffer, SubpassContents::DIRECT);
 			context.bindPipelineLayout(m_debugHeatmapLayout);
 			context.bindPipeline(m_debugLightHeatmapPipeline);
@@ -453,20 +842,40 @@ namespace sa {
 			context.endRenderProgram(m_debugLightHeatmapRenderProgram);
 
 			Engine::GetEngineStatistics().drawCalls++;
-
-		}
+			return true;
+		});
 		
 		pRenderTarget->setOutputTexture(data.colorTexture, Transition::RENDER_PROGRAM_OUTPUT);
 		return true;
 	}
 
+	bool ForwardPlus::render(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sc) {
+		RenderGraph graph;
+		if (!addRenderPasses(graph, "ForwardPlus", context, pCamera, pRenderTarget, sc))
+			return false;
+		graph.compile();
+		return graph.execute(context);
+	}
+
 	bool ForwardPlus::postRender(RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget,
 		SceneCollection& sceneCollection)
 	{
 		ForwardPlusRenderData& data = getRenderTargetData(pRenderTarget->getID());
 		if (data.isInitialized) {
 			data.lightIndexBuffer.swap();
+			data.tileLightCountBuffer.swap();
+			data.tileFrustumBuffer.swap();
+			data.lightBoundsBuffer.swap();
 		}
 		return true;
 	}
+
+	uint32_t ForwardPlus::getTileLightCount(const UUID& renderTargetID, glm::uvec2 tile) {
+		ForwardPlusRenderData& data = getRenderTargetData(renderTargetID);
+		if (!data.isInitialized || tile.x >= data.tileCount.x || tile.y >= data.tileCount.y)
+			return 0;
+		// The current copy is the one for the next frame, the previous one was written last
+		const Buffer& buffer = data.tileLightCountBuffer.getBuffer(data.tileLightCountBuffer.getPreviousBufferIndex());
+		return buffer.at<uint32_t>(tile.y * data.tileCount.x + tile.x);
+	}
 }
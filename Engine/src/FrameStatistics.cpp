@@ -0,0 +1,253 @@
+#include "pch.h"
+#include "Tools/FrameStatistics.h"
+
+namespace sa {
+
+	static FramePercentiles computePercentiles(std::vector<float>& values) {
+		FramePercentiles percentiles = {};
+		if (values.empty())
+			return percentiles;
+
+		std::sort(values.begin(), values.end());
+		// nearest rank
+		auto rank = [&](float p) {
+			size_t index = (size_t)std::ceil(p * values.size());
+			return values[std::clamp<size_t>(index, 1, values.size()) - 1];
+		};
+		percentiles.p50 = rank(0.50f);
+		percentiles.p95 = rank(0.95f);
+		percentiles.p99 = rank(0.99f);
+		percentiles.max = values.back();
+		return percentiles;
+	}
+
+	size_t FrameStatistics::getRingIndex(size_t index) const {
+		return (m_first + index) % m_capacity;
+	}
+
+	uint32_t FrameStatistics::getOrRegisterCounter(const std::string& name) {
+		auto it = m_counterIndices.find(name);
+		if (it != m_counterIndices.end())
+			return it->second;
+
+		uint32_t index = m_counterNames.size();
+		m_counterNames.push_back(name);
+		m_counterIndices[name] = index;
+		m_currentCounterValues.push_back(0.0);
+		m_counterHistory.emplace_back(m_capacity, 0.0);
+		return index;
+	}
+
+	float FrameStatistics::getValue(const FrameRecord& record, FrameMetric metric) const {
+		switch (metric) {
+		case FrameMetric::CPU_TIME:
+			return record.cpuTime;
+		case FrameMetric::GPU_TIME:
+			return record.gpuTime;
+		case FrameMetric::DRAW_CALLS:
+			return (float)record.drawCalls;
+		case FrameMetric::TRIANGLES:
+			return (float)record.triangleCount;
+		case FrameMetric::UPLOADS:
+			return (float)record.uploadCount;
+		case FrameMetric::ALLOCATIONS:
+			return (float)record.allocationCount;
+		default:
+			throw std::runtime_error("Invalid frame metric");
+		}
+	}
+
+	FrameStatistics::FrameStatistics(size_t capacity)
+		: m_capacity(std::max<size_t>(capacity, 1))
+		, m_first(0)
+		, m_count(0)
+		, m_frameNumber(0)
+	{
+		m_frames.resize(m_capacity);
+	}
+
+	void FrameStatistics::setCapacity(size_t capacity) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_capacity = std::max<size_t>(capacity, 1);
+		m_frames.assign(m_capacity, {});
+		for (auto& history : m_counterHistory) {
+			history.assign(m_capacity, 0.0);
+		}
+		m_first = 0;
+		m_count = 0;
+	}
+
+	size_t FrameStatistics::getCapacity() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_capacity;
+	}
+
+	void FrameStatistics::recordFrame(FrameRecord record) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		record.frameNumber = m_frameNumber++;
+
+		size_t index;
+		if (m_count < m_capacity) {
+			index = getRingIndex(m_count);
+			m_count++;
+		}
+		else {
+			index = m_first;
+			m_first = (m_first + 1) % m_capacity;
+		}
+
+		m_frames[index] = record;
+		for (size_t i = 0; i < m_counterHistory.size(); i++) {
+			m_counterHistory[i][index] = m_currentCounterValues[i];
+			m_currentCounterValues[i] = 0.0;
+		}
+	}
+
+	void FrameStatistics::clear() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_first = 0;
+		m_count = 0;
+	}
+
+	size_t FrameStatistics::getFrameCount() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_count;
+	}
+
+	FrameRecord FrameStatistics::getFrame(size_t index) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (index >= m_count)
+			throw std::out_of_range("Frame index out of range: " + std::to_string(index));
+		return m_frames[getRingIndex(index)];
+	}
+
+	FrameRecord FrameStatistics::getLatestFrame() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_count == 0)
+			return {};
+		return m_frames[getRingIndex(m_count - 1)];
+	}
+
+	FramePercentiles FrameStatistics::getPercentiles(FrameMetric metric) const {
+		std::vector<float> values = getValues(metric);
+		return computePercentiles(values);
+	}
+
+	FramePercentiles FrameStatistics::getCounterPercentiles(const std::string& name) const {
+		std::vector<float> values = getCounterValues(name);
+		return computePercentiles(values);
+	}
+
+	std::vector<uint32_t> FrameStatistics::getFrameTimeHistogram(uint32_t bucketCount, float maxTime, FrameMetric metric) const {
+		std::vector<uint32_t> buckets(bucketCount, 0);
+		if (bucketCount == 0 || maxTime <= 0.0f)
+			return buckets;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < m_count; i++) {
+			float value = getValue(m_frames[getRingIndex(i)], metric);
+			if (std::isnan(value))
+				continue;
+			size_t bucket = (size_t)std::max(value / maxTime * bucketCount, 0.0f);
+			buckets[std::min<size_t>(bucket, bucketCount - 1)]++;
+		}
+		return buckets;
+	}
+
+	std::vector<float> FrameStatistics::getValues(FrameMetric metric) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<float> values;
+		values.reserve(m_count);
+		for (size_t i = 0; i < m_count; i++) {
+			float value = getValue(m_frames[getRingIndex(i)], metric);
+			if (!std::isnan(value))
+				values.push_back(value);
+		}
+		return values;
+	}
+
+	void FrameStatistics::addCounter(const std::string& name, double value) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_currentCounterValues[getOrRegisterCounter(name)] += value;
+	}
+
+	void FrameStatistics::setCounter(const std::string& name, double value) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_currentCounterValues[getOrRegisterCounter(name)] = value;
+	}
+
+	std::vector<std::string> FrameStatistics::getCounterNames() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_counterNames;
+	}
+
+	std::vector<float> FrameStatistics::getCounterValues(const std::string& name) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_counterIndices.find(name);
+		if (it == m_counterIndices.end())
+			return {};
+
+		const std::vector<double>& history = m_counterHistory[it->second];
+		std::vector<float> values(m_count);
+		for (size_t i = 0; i < m_count; i++) {
+			values[i] = (float)history[getRingIndex(i)];
+		}
+		return values;
+	}
+
+	bool FrameStatistics::exportCSV(const std::filesystem::path& path) const {
+		std::ofstream file(path);
+		if (!file.is_open()) {
+			SA_DEBUG_LOG_ERROR("Failed to open file ", path.generic_string(), " for writing frame statistics");
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		file << "frame,cpu_time_ms,gpu_time_ms,draw_calls,triangles,uploads,allocations";
+		for (const auto& name : m_counterNames) {
+			file << "," << name;
+		}
+		file << "\n";
+
+		for (size_t i = 0; i < m_count; i++) {
+			size_t index = getRingIndex(i);
+			const FrameRecord& record = m_frames[index];
+			file << record.frameNumber << ","
+				<< record.cpuTime * 1000.0f << ",";
+			// left empty on frames without a GPU result
+			if (!std::isnan(record.gpuTime))
+				file << record.gpuTime * 1000.0f;
+			file << ","
+				<< record.drawCalls << ","
+				<< record.triangleCount << ","
+				<< record.uploadCount << ","
+				<< record.allocationCount;
+			for (const auto& history : m_counterHistory) {
+				file << "," << history[index];
+			}
+			file << "\n";
+		}
+		SA_DEBUG_LOG_INFO("Exported ", m_count, " frames of statistics to ", path.generic_string());
+		return true;
+	}
+
+	const char* FrameStatistics::MetricName(FrameMetric metric) {
+		switch (metric) {
+		case FrameMetric::CPU_TIME:
+			return "CPU Time";
+		case FrameMetric::GPU_TIME:
+			return "GPU Time";
+		case FrameMetric::DRAW_CALLS:
+			return "Draw calls";
+		case FrameMetric::TRIANGLES:
+			return "Triangles";
+		case FrameMetric::UPLOADS:
+			return "Uploads";
+		case FrameMetric::ALLOCATIONS:
+			return "Allocations";
+		default:
+			return "";
+		}
+	}
+
+}
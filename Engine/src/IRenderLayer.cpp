@@ -17,4 +17,11 @@ namespace sa {
 		m_isActive = active;
 	}
 
+	bool BasicRenderLayer::addRenderPasses(RenderGraph& graph, const std::string& name, RenderContext& context, SceneCamera* pCamera, RenderTarget* pRenderTarget, SceneCollection& sceneCollection) {
+		graph.addOrderedPass(name, [=, this, &sceneCollection](RenderContext& context) {
+			return render(context, pCamera, pRenderTarget, sceneCollection);
+		});
+		return true;
+	}
+
 }
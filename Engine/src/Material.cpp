@@ -7,6 +7,7 @@
 #include "structs.h"
 
 #include "AssetManager.h"
+#include "Graphics/TextureTable.h"
 
 namespace sa {
 	const char* to_string(MaterialTextureType type) {
@@ -78,6 +79,18 @@ namespace sa {
 		return allLoaded;
 	}
 
+	uint32_t Material::getTextureSlot(MaterialTextureType type) const {
+		const auto it = m_textures.find(type);
+		if (it == m_textures.end() || it->second.empty())
+			return TEXTURE_TABLE_DEFAULT_SLOT;
+
+		const TextureAsset* asset = it->second.front().getAsset();
+		if (!asset || !asset->getTexture().isValid() || asset->getTableSlot() == UINT32_MAX)
+			return TEXTURE_TABLE_DEFAULT_SLOT;
+		
+		return asset->getTableSlot();
+	}
+
 	Material::Material(const AssetHeader& header, bool isCompiled)
 		: Asset(header, isCompiled)
 	{
@@ -169,6 +182,17 @@ namespace sa {
 		return m_allTextures;
 	}
 
+	Material::Values Material::getShaderValues() const {
+		Values shaderValues = values;
+		shaderValues.albedoMapFirst = getTextureSlot(MaterialTextureType::BASE_COLOR);
+		shaderValues.normalMapFirst = getTextureSlot(MaterialTextureType::NORMAL_CAMERA);
+		shaderValues.metalnessMapFirst = getTextureSlot(MaterialTextureType::METALNESS);
+		shaderValues.roughnessMapFirst = getTextureSlot(MaterialTextureType::DIFFUSE_ROUGHNESS);
+		shaderValues.emissiveMapFirst = getTextureSlot(MaterialTextureType::EMISSIVE);
+		shaderValues.occlusionMapFirst = getTextureSlot(MaterialTextureType::AMBIENT_OCCLUSION);
+		return shaderValues;
+	}
+
 	std::unordered_map<MaterialTextureType, std::vector<AssetHolder<TextureAsset>>>& Material::getTextures() {
 		return m_textures;
 	}
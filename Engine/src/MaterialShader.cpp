@@ -10,21 +10,67 @@ namespace sa {
             throw std::runtime_error("Invalid sources");
         }
         m_sourceFiles = sourceFiles;
+        m_code.clear();
         for (auto& source : m_sourceFiles) {
-            std::filesystem::path path = std::filesystem::current_path();
-            std::filesystem::current_path(Engine::GetShaderDirectory());
+            std::filesystem::path path = source.filePath;
+            if (path.is_relative())
+                path = Engine::GetShaderDirectory() / path;
+            
             std::vector<uint32_t> code = CompileGLSLFromFile(
-                source.filePath.generic_string().c_str(),
+                path.generic_string().c_str(),
                 source.stage,
                 "main",
                 sa::Engine::GetShaderDirectory().generic_string().c_str());
 
             m_code.push_back(code);
-            std::filesystem::current_path(path);
         }
         create();
     }
 
+    size_t MaterialShader::PrebuildShaderCache(const std::filesystem::path& directory) {
+        static const std::unordered_map<std::string, ShaderStageFlagBits> extensionStages = {
+            { ".vert", ShaderStageFlagBits::VERTEX },
+            { ".frag", ShaderStageFlagBits::FRAGMENT },
+            { ".geom", ShaderStageFlagBits::GEOMETRY },
+            { ".tesc", ShaderStageFlagBits::TESSELLATION_CONTROL },
+            { ".tese", ShaderStageFlagBits::TESSELLATION_EVALUATION },
+            { ".comp", ShaderStageFlagBits::COMPUTE },
+        };
+
+        std::vector<ShaderSourceFile> sources;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+            if (!entry.is_regular_file())
+                continue;
+            auto it = extensionStages.find(entry.path().extension().generic_string());
+            if (it == extensionStages.end())
+                continue;
+            sources.push_back({ std::filesystem::absolute(entry.path()), it->second });
+        }
+
+        std::atomic_size_t compiledCount = 0;
+        const std::string includeDirectory = Engine::GetShaderDirectory().generic_string();
+
+        tf::Taskflow taskflow;
+        taskflow.for_each(sources.begin(), sources.end(), [&](const ShaderSourceFile& source) {
+            try {
+                std::vector<uint32_t> code = CompileGLSLFromFile(source.filePath.generic_string().c_str(), source.stage, "main", includeDirectory.c_str());
+                compiledCount++;
+            }
+            catch (const std::exception& e) {
+                SA_DEBUG_LOG_WARNING("Failed to prebuild shader ", source.filePath.generic_string(), ": ", e.what());
+            }
+        });
+        tf::Executor& executor = Asset::GetTaskExecutor();
+        // A worker blocking on the taskflow would keep its thread from the compile tasks
+        if (executor.this_worker_id() >= 0)
+            executor.run_and_wait(taskflow);
+        else
+            executor.run(taskflow).wait();
+
+        SA_DEBUG_LOG_INFO("Prebuilt ", compiledCount.load(), " of ", sources.size(), " shaders in ", directory.generic_string());
+        return compiledCount;
+    }
+
     void MaterialShader::create(const std::vector<std::vector<uint32_t>>& sourceCode) {
         m_code = sourceCode;
         create();
@@ -12,6 +12,8 @@
 #include "AssetManager.h"
 
 namespace sa {
+	static std::atomic<uint64_t> s_lastModelDataRevision = 0;
+
 	bool searchForFile(const std::filesystem::path& directory, const std::filesystem::path& filename, std::filesystem::path& outPath) {
 		outPath = directory / filename;
 		if (std::filesystem::exists(outPath)) {
@@ -291,10 +293,19 @@ namespace sa {
 		return importer.IsExtensionSupported(extension);
 	}
 
+	uint64_t ModelAsset::getDataRevision() const {
+		return m_dataRevision;
+	}
+
+	void ModelAsset::markDataChanged() {
+		m_dataRevision = ++s_lastModelDataRevision;
+	}
+
 	bool ModelAsset::onLoad(JsonObject& metaData, AssetLoadFlags flags) {
 		sa::Clock clock;
 		data.meshes.clear();
 		bool sucess = loadAssimpModel(getAssetPath());
+		markDataChanged();
 		SA_DEBUG_LOG_INFO("Finished loading ", getAssetPath(), " in: ", clock.getElapsedTime<std::chrono::milliseconds>(), " ms");
 		return sucess;
 	}
@@ -325,6 +336,7 @@ namespace sa {
 				addDependency(*pProgress);
 			
 		}
+		markDataChanged();
 
 		return true;
 	}
@@ -361,12 +373,14 @@ namespace sa {
 	bool ModelAsset::onUnload() {
 		data.meshes.clear();
 		data.meshes.shrink_to_fit();
+		markDataChanged();
 		return true;
 	}
 	
 	ModelAsset* ModelAsset::clone(const std::string& name, const std::filesystem::path& assetDir) const {
 		ModelAsset* clone = sa::AssetManager::Get().createAsset<ModelAsset>(name, assetDir);
 		clone->data = data;
+		clone->markDataChanged();
 		return clone;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "ECS/Components/PhysicsAggregate.h"
+
+#include "ECS/Entity.h"
+#include "Scene.h"
+
+namespace comp {
+	PhysicsAggregate::PhysicsAggregate(bool selfCollision)
+		: selfCollision(selfCollision)
+	{
+	}
+
+	void PhysicsAggregate::serialize(sa::Serializer& s) {
+		s.value("selfCollision", selfCollision);
+	}
+
+	void PhysicsAggregate::deserialize(void* pDoc) {
+		simdjson::ondemand::object& obj = *(simdjson::ondemand::object*)pDoc;
+		bool isSelfColliding = obj["selfCollision"];
+		selfCollision = isSelfColliding;
+	}
+
+	void PhysicsAggregate::onConstruct(sa::Entity* e) {
+		e->getScene()->invalidatePhysicsAggregate(*e);
+	}
+
+	void PhysicsAggregate::onUpdate(sa::Entity* e) {
+		e->getScene()->invalidatePhysicsAggregate(*e);
+	}
+
+	void PhysicsAggregate::onDestroy(sa::Entity* e) {
+		e->getScene()->invalidatePhysicsAggregate(*e);
+	}
+
+}
@@ -0,0 +1,34 @@
+#include "pch.h"
+#include "PhysicsCpuDispatcher.h"
+
+#include "Tools/Profiler.h"
+
+namespace sa {
+
+	PhysicsCpuDispatcher::PhysicsCpuDispatcher(tf::Executor& executor, uint32_t workerCount)
+		: m_executor(executor)
+	{
+		setWorkerCount(workerCount);
+	}
+
+	void PhysicsCpuDispatcher::submitTask(physx::PxBaseTask& task) {
+		physx::PxBaseTask* pTask = &task;
+		m_executor.silent_async([pTask]() {
+			SA_PROFILE_SCOPE(pTask->getName());
+			pTask->run();
+			pTask->release();
+		});
+	}
+
+	uint32_t PhysicsCpuDispatcher::getWorkerCount() const {
+		return m_workerCount;
+	}
+
+	void PhysicsCpuDispatcher::setWorkerCount(uint32_t workerCount) {
+		const uint32_t executorWorkerCount = static_cast<uint32_t>(m_executor.num_workers());
+		if (workerCount == 0 || workerCount > executorWorkerCount)
+			workerCount = executorWorkerCount;
+		m_workerCount = std::max(workerCount, 1U);
+	}
+
+}
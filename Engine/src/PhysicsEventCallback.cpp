@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "PhysicsEventCallback.h"
+
+#include "ECS/Components/RigidBody.h"
+
+namespace sa {
+
+	entt::entity PhysicsEventCallback::getEntity(const physx::PxActor* pActor, bool mayBeReleased) const {
+		if (mayBeReleased) {
+			auto it = m_releasedActors.find(pActor);
+			if (it != m_releasedActors.end())
+				return it->second;
+		}
+		return comp::RigidBody::GetEntity(pActor);
+	}
+
+	void PhysicsEventCallback::onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pPairs, physx::PxU32 pairCount) {
+		using namespace physx;
+		const entt::entity entity0 = getEntity(pairHeader.actors[0], pairHeader.flags & PxContactPairHeaderFlag::eREMOVED_ACTOR_0);
+		const entt::entity entity1 = getEntity(pairHeader.actors[1], pairHeader.flags & PxContactPairHeaderFlag::eREMOVED_ACTOR_1);
+
+		PxContactPairPoint points[PHYSICS_MAX_CONTACT_POINTS];
+		for (PxU32 i = 0; i < pairCount; i++) {
+			const PxContactPair& pair = pPairs[i];
+			// A removed shape ends its touch, so the other side sees an end for every begin
+			const bool isRemoved = pair.flags & (PxContactPairFlag::eREMOVED_SHAPE_0 | PxContactPairFlag::eREMOVED_SHAPE_1);
+
+			ContactRecord& record = m_contacts.emplace_back();
+			record.entity0 = entity0;
+			record.entity1 = entity1;
+			record.state = (isRemoved || (pair.events & PxPairFlag::eNOTIFY_TOUCH_LOST)) ? TouchState::END : TouchState::BEGIN;
+			record.position = Vector3(0);
+			record.normal = Vector3(0);
+			record.impulse = 0.0f;
+
+			if (isRemoved)
+				continue;
+			const PxU32 pointCount = pair.extractContacts(points, PHYSICS_MAX_CONTACT_POINTS);
+			if (pointCount == 0)
+				continue;
+			PxVec3 position(0.0f);
+			for (PxU32 j = 0; j < pointCount; j++) {
+				position += points[j].position;
+				record.impulse += points[j].impulse.magnitude();
+			}
+			record.position = PhysicsSystem::toVector(position / static_cast<float>(pointCount));
+			record.normal = PhysicsSystem::toVector(points[0].normal);
+		}
+	}
+
+	void PhysicsEventCallback::onTrigger(physx::PxTriggerPair* pPairs, physx::PxU32 count) {
+		using namespace physx;
+		for (PxU32 i = 0; i < count; i++) {
+			const PxTriggerPair& pair = pPairs[i];
+			const bool isTriggerRemoved = pair.flags & PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER;
+			const bool isOtherRemoved = pair.flags & PxTriggerPairFlag::eREMOVED_SHAPE_OTHER;
+			m_triggers.push_back({
+				getEntity(pair.triggerActor, isTriggerRemoved),
+				getEntity(pair.otherActor, isOtherRemoved),
+				(isTriggerRemoved || isOtherRemoved || pair.status == PxPairFlag::eNOTIFY_TOUCH_LOST) ? TouchState::END : TouchState::BEGIN
+			});
+		}
+	}
+
+	std::vector<ContactRecord>& PhysicsEventCallback::getContacts() {
+		return m_contacts;
+	}
+
+	std::vector<TriggerRecord>& PhysicsEventCallback::getTriggers() {
+		return m_triggers;
+	}
+
+	void PhysicsEventCallback::clear() {
+		m_contacts.clear();
+		m_triggers.clear();
+	}
+
+	void PhysicsEventCallback::onActorReleased(const physx::PxActor* pActor) {
+		m_releasedActors[pActor] = comp::RigidBody::GetEntity(pActor);
+	}
+
+	void PhysicsEventCallback::clearReleasedActors() {
+		m_releasedActors.clear();
+	}
+
+}
@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "PhysicsQuery.h"
+
+#include "PhysicsSystem.h"
+#include "ECS/Components/RigidBody.h"
+#include "Assets/Asset.h"
+
+#include "Tools/Profiler.h"
+
+namespace sa {
+
+	class IgnoreEntityFilterCallback : public physx::PxQueryFilterCallback {
+	private:
+		entt::entity m_ignoredEntity;
+	public:
+		IgnoreEntityFilterCallback(entt::entity ignoredEntity)
+			: m_ignoredEntity(ignoredEntity)
+		{
+		}
+
+		virtual physx::PxQueryHitType::Enum preFilter(const physx::PxFilterData& filterData, const physx::PxShape* pShape, const physx::PxRigidActor* pActor, physx::PxHitFlags& queryFlags) override {
+			if (comp::RigidBody::GetEntity(pActor) == m_ignoredEntity)
+				return physx::PxQueryHitType::eNONE;
+			// Turned into touches by eNO_BLOCK when every hit is reported
+			return physx::PxQueryHitType::eBLOCK;
+		}
+
+		virtual physx::PxQueryHitType::Enum postFilter(const physx::PxFilterData& filterData, const physx::PxQueryHit& hit) override {
+			return physx::PxQueryHitType::eBLOCK;
+		}
+	};
+
+	static physx::PxQueryFilterData GetFilterData(const QueryFilter& filter, bool reportAllHits) {
+		physx::PxQueryFlags flags;
+		if (filter.includeStatic)
+			flags |= physx::PxQueryFlag::eSTATIC;
+		if (filter.includeDynamic)
+			flags |= physx::PxQueryFlag::eDYNAMIC;
+		if (filter.ignoredEntity != entt::null)
+			flags |= physx::PxQueryFlag::ePREFILTER;
+		if (reportAllHits)
+			flags |= physx::PxQueryFlag::eNO_BLOCK;
+
+		physx::PxFilterData data;
+		if (filter.layerMask != 0xFFFFFFFF)
+			data.word0 = filter.layerMask;
+		return physx::PxQueryFilterData(data, flags);
+	}
+
+	static physx::PxGeometryHolder GetGeometry(const QueryShape& shape) {
+		switch (shape.type) {
+		case QueryShapeType::BOX:
+			return physx::PxBoxGeometry(PhysicsSystem::toPxVec(shape.halfExtents));
+		case QueryShapeType::CAPSULE:
+			return physx::PxCapsuleGeometry(shape.radius, shape.halfExtents.x);
+		default:
+			return physx::PxSphereGeometry(shape.radius);
+		}
+	}
+
+	static physx::PxTransform GetPose(const Vector3& position, const glm::quat& rotation) {
+		return physx::PxTransform(PhysicsSystem::toPxVec(position), physx::PxQuat(rotation.x, rotation.y, rotation.z, rotation.w));
+	}
+
+	template<typename HitType>
+	static QueryHit ToQueryHit(const HitType& hit) {
+		QueryHit queryHit;
+		queryHit.entity = comp::RigidBody::GetEntity(hit.actor);
+		queryHit.position = PhysicsSystem::toVector(hit.position);
+		queryHit.normal = PhysicsSystem::toVector(hit.normal);
+		queryHit.distance = hit.distance;
+		return queryHit;
+	}
+
+	static QueryHit ToQueryHit(const physx::PxOverlapHit& hit) {
+		QueryHit queryHit;
+		queryHit.entity = comp::RigidBody::GetEntity(hit.actor);
+		queryHit.position = PhysicsSystem::toVector(hit.actor->getGlobalPose().p);
+		return queryHit;
+	}
+
+	template<typename HitType>
+	static uint32_t WriteHits(const physx::PxHitBuffer<HitType>& buffer, QueryHit* pHits) {
+		if (buffer.hasBlock) {
+			pHits[0] = ToQueryHit(buffer.block);
+			return 1U;
+		}
+		for (uint32_t i = 0; i < buffer.nbTouches; i++) {
+			pHits[i] = ToQueryHit(buffer.touches[i]);
+		}
+		// Touches come in no particular order
+		std::sort(pHits, pHits + buffer.nbTouches, [](const QueryHit& first, const QueryHit& second) {
+			return first.distance < second.distance;
+		});
+		return buffer.nbTouches;
+	}
+
+	static uint32_t ExecuteRaycast(physx::PxScene* pScene, const RaycastQuery& query, QueryHit* pHits) {
+		const physx::PxVec3 direction = PhysicsSystem::toPxVec(query.direction).getNormalized();
+		if (direction.isZero() || query.maxHits == 0)
+			return 0U;
+
+		thread_local std::vector<physx::PxRaycastHit> s_touches;
+		const bool reportAllHits = query.maxHits > 1;
+		if (reportAllHits)
+			s_touches.resize(std::max<size_t>(s_touches.size(), query.maxHits));
+
+		physx::PxRaycastBuffer buffer(reportAllHits ? s_touches.data() : nullptr, reportAllHits ? query.maxHits : 0U);
+		IgnoreEntityFilterCallback filterCallback(query.filter.ignoredEntity);
+		pScene->raycast(PhysicsSystem::toPxVec(query.origin), direction, query.maxDistance, buffer,
+			physx::PxHitFlag::eDEFAULT, GetFilterData(query.filter, reportAllHits), &filterCallback);
+		return WriteHits(buffer, pHits);
+	}
+
+	static uint32_t ExecuteSweep(physx::PxScene* pScene, const SweepQuery& query, QueryHit* pHits) {
+		const physx::PxVec3 direction = PhysicsSystem::toPxVec(query.direction).getNormalized();
+		if (direction.isZero() || query.maxHits == 0)
+			return 0U;
+
+		thread_local std::vector<physx::PxSweepHit> s_touches;
+		const bool reportAllHits = query.maxHits > 1;
+		if (reportAllHits)
+			s_touches.resize(std::max<size_t>(s_touches.size(), query.maxHits));
+
+		physx::PxSweepBuffer buffer(reportAllHits ? s_touches.data() : nullptr, reportAllHits ? query.maxHits : 0U);
+		IgnoreEntityFilterCallback filterCallback(query.filter.ignoredEntity);
+		pScene->sweep(GetGeometry(query.shape).any(), GetPose(query.origin, query.rotation), direction, query.maxDistance, buffer,
+			physx::PxHitFlag::eDEFAULT, GetFilterData(query.filter, reportAllHits), &filterCallback);
+		return WriteHits(buffer, pHits);
+	}
+
+	static uint32_t ExecuteOverlap(physx::PxScene* pScene, const OverlapQuery& query, QueryHit* pHits) {
+		if (query.maxHits == 0)
+			return 0U;
+
+		thread_local std::vector<physx::PxOverlapHit> s_touches;
+		s_touches.resize(std::max<size_t>(s_touches.size(), query.maxHits));
+
+		// Overlaps have no blocking hit, every hit is a touch
+		physx::PxOverlapBuffer buffer(s_touches.data(), query.maxHits);
+		IgnoreEntityFilterCallback filterCallback(query.filter.ignoredEntity);
+		pScene->overlap(GetGeometry(query.shape).any(), GetPose(query.position, query.rotation), buffer,
+			GetFilterData(query.filter, true), &filterCallback);
+		return WriteHits(buffer, pHits);
+	}
+
+	void PhysicsQueryBatch::prepareResults() {
+		uint32_t hitCount = 0;
+		auto reserveHits = [&](auto& queries, std::vector<QueryResult>& results) {
+			results.resize(queries.size());
+			for (size_t i = 0; i < queries.size(); i++) {
+				results[i].firstHit = hitCount;
+				results[i].hitCount = 0;
+				hitCount += queries[i].maxHits;
+			}
+		};
+		reserveHits(m_raycasts, m_raycastResults);
+		reserveHits(m_sweeps, m_sweepResults);
+		reserveHits(m_overlaps, m_overlapResults);
+		m_hits.resize(hitCount);
+	}
+
+	void PhysicsQueryBatch::executeQuery(physx::PxScene* pScene, uint32_t index) {
+		if (index < m_raycasts.size()) {
+			QueryResult& result = m_raycastResults[index];
+			result.hitCount = ExecuteRaycast(pScene, m_raycasts[index], m_hits.data() + result.firstHit);
+			return;
+		}
+		index -= static_cast<uint32_t>(m_raycasts.size());
+		if (index < m_sweeps.size()) {
+			QueryResult& result = m_sweepResults[index];
+			result.hitCount = ExecuteSweep(pScene, m_sweeps[index], m_hits.data() + result.firstHit);
+			return;
+		}
+		index -= static_cast<uint32_t>(m_sweeps.size());
+		QueryResult& result = m_overlapResults[index];
+		result.hitCount = ExecuteOverlap(pScene, m_overlaps[index], m_hits.data() + result.firstHit);
+	}
+
+	uint32_t PhysicsQueryBatch::addRaycast(const RaycastQuery& query) {
+		m_raycasts.push_back(query);
+		return static_cast<uint32_t>(m_raycasts.size() - 1);
+	}
+
+	uint32_t PhysicsQueryBatch::addSweep(const SweepQuery& query) {
+		m_sweeps.push_back(query);
+		return static_cast<uint32_t>(m_sweeps.size() - 1);
+	}
+
+	uint32_t PhysicsQueryBatch::addOverlap(const OverlapQuery& query) {
+		m_overlaps.push_back(query);
+		return static_cast<uint32_t>(m_overlaps.size() - 1);
+	}
+
+	void PhysicsQueryBatch::clear() {
+		m_raycasts.clear();
+		m_sweeps.clear();
+		m_overlaps.clear();
+		m_raycastResults.clear();
+		m_sweepResults.clear();
+		m_overlapResults.clear();
+		m_hits.clear();
+	}
+
+	uint32_t PhysicsQueryBatch::getQueryCount() const {
+		return static_cast<uint32_t>(m_raycasts.size() + m_sweeps.size() + m_overlaps.size());
+	}
+
+	void PhysicsQueryBatch::execute(physx::PxScene* pScene, bool parallel) {
+		SA_PROFILE_FUNCTION();
+		prepareResults();
+
+		const uint32_t queryCount = getQueryCount();
+		if (parallel && queryCount >= PHYSICS_QUERY_MIN_PARALLEL_COUNT) {
+			tf::Taskflow taskflow;
+			taskflow.for_each_index(0U, queryCount, 1U, [&](uint32_t i) {
+				executeQuery(pScene, i);
+			});
+			tf::Executor& executor = Asset::GetTaskExecutor();
+			// Scripts and systems may run the batch from a task, a worker blocking on it would keep its thread from the queries
+			if (executor.this_worker_id() >= 0)
+				executor.run_and_wait(taskflow);
+			else
+				executor.run(taskflow).wait();
+			return;
+		}
+
+		for (uint32_t i = 0; i < queryCount; i++) {
+			executeQuery(pScene, i);
+		}
+	}
+
+	const std::vector<QueryResult>& PhysicsQueryBatch::getRaycastResults() const {
+		return m_raycastResults;
+	}
+
+	const std::vector<QueryResult>& PhysicsQueryBatch::getSweepResults() const {
+		return m_sweepResults;
+	}
+
+	const std::vector<QueryResult>& PhysicsQueryBatch::getOverlapResults() const {
+		return m_overlapResults;
+	}
+
+	const QueryHit* PhysicsQueryBatch::getHits(const QueryResult& result) const {
+		return m_hits.data() + result.firstHit;
+	}
+
+}
@@ -1,5 +1,8 @@
 #include "pch.h"
 #include "PhysicsSystem.h"
+#include "PhysicsCpuDispatcher.h"
+
+#include "Assets/Asset.h"
 
 #include <Tools/Logger.hpp>
 
@@ -21,6 +24,87 @@ class AllocatorCallback : public physx::PxAllocatorCallback {
 };
 
 namespace sa {
+	static int32_t Quantize(float value) {
+		return static_cast<int32_t>(std::round(value * PHYSICS_SHAPE_KEY_PRECISION));
+	}
+
+	// Same collisions as PxDefaultSimulationFilterShader, but touching pairs are reported to the scene's event callback
+	static physx::PxFilterFlags SimulationFilterShader(
+		physx::PxFilterObjectAttributes attributes0, physx::PxFilterData filterData0,
+		physx::PxFilterObjectAttributes attributes1, physx::PxFilterData filterData1,
+		physx::PxPairFlags& pairFlags, const void* pConstantBlock, physx::PxU32 constantBlockSize)
+	{
+		using namespace physx;
+		if (PxFilterObjectIsTrigger(attributes0) || PxFilterObjectIsTrigger(attributes1)) {
+			pairFlags = PxPairFlag::eTRIGGER_DEFAULT;
+			return PxFilterFlag::eDEFAULT;
+		}
+		// Only the start and end of a touch, persisting contacts would be reported every step
+		pairFlags = PxPairFlag::eCONTACT_DEFAULT
+			| PxPairFlag::eNOTIFY_TOUCH_FOUND
+			| PxPairFlag::eNOTIFY_TOUCH_LOST
+			| PxPairFlag::eNOTIFY_CONTACT_POINTS;
+		return PxFilterFlag::eDEFAULT;
+	}
+
+	static void SetTrigger(physx::PxShape* pShape) {
+		// A shape can not both collide and be a trigger, and raycasts and sweeps should not hit trigger volumes
+		pShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
+		pShape->setFlag(physx::PxShapeFlag::eSCENE_QUERY_SHAPE, false);
+		pShape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
+	}
+
+	size_t ShapeKeyHasher::operator()(const ShapeKey& key) const {
+		size_t hash = std::hash<uint32_t>()(key.geometryType);
+		auto combine = [&](size_t value) {
+			hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		};
+		for (int32_t parameter : key.parameters)
+			combine(std::hash<int32_t>()(parameter));
+		for (int32_t offset : key.offset)
+			combine(std::hash<int32_t>()(offset));
+		combine(std::hash<physx::PxMaterial*>()(key.pMaterial));
+		combine(std::hash<bool>()(key.isTrigger));
+		return hash;
+	}
+
+	bool PhysicsSystem::GetShapeKey(const physx::PxGeometry& geometry, physx::PxMaterial* pMaterial, const Vector3& offset, bool isTrigger, ShapeKey* pKey) {
+		ShapeKey& key = *pKey;
+		key.geometryType = static_cast<uint32_t>(geometry.getType());
+		key.pMaterial = pMaterial;
+		key.isTrigger = isTrigger;
+		key.offset[0] = Quantize(offset.x);
+		key.offset[1] = Quantize(offset.y);
+		key.offset[2] = Quantize(offset.z);
+
+		switch (geometry.getType()) {
+		case physx::PxGeometryType::eBOX: {
+			const physx::PxBoxGeometry& box = static_cast<const physx::PxBoxGeometry&>(geometry);
+			key.parameters[0] = Quantize(box.halfExtents.x);
+			key.parameters[1] = Quantize(box.halfExtents.y);
+			key.parameters[2] = Quantize(box.halfExtents.z);
+			return true;
+		}
+		case physx::PxGeometryType::eSPHERE: {
+			const physx::PxSphereGeometry& sphere = static_cast<const physx::PxSphereGeometry&>(geometry);
+			key.parameters[0] = Quantize(sphere.radius);
+			key.parameters[1] = 0;
+			key.parameters[2] = 0;
+			return true;
+		}
+		case physx::PxGeometryType::eCAPSULE: {
+			const physx::PxCapsuleGeometry& capsule = static_cast<const physx::PxCapsuleGeometry&>(geometry);
+			key.parameters[0] = Quantize(capsule.radius);
+			key.parameters[1] = Quantize(capsule.halfHeight);
+			key.parameters[2] = 0;
+			return true;
+		}
+		default:
+			// Meshes and the rest are not shared
+			return false;
+		}
+	}
+
 	PhysicsSystem::PhysicsSystem() {
 		static AllocatorCallback s_defaultAllocator;
 		static ErrorCallback s_defaultErrorCallback;
@@ -52,15 +136,19 @@ namespace sa {
 			throw std::runtime_error("PxCreatePhysics failed!");
 		}
 
-		m_pCpuDispatcher = physx::PxDefaultCpuDispatcherCreate(4);
+		m_pCpuDispatcher = new PhysicsCpuDispatcher(Asset::GetTaskExecutor());
 
 
 		m_pDefaultMaterial = m_pPhysics->createMaterial(0.5f, 0.5f, 0.1f);
 	}
 
 	PhysicsSystem::~PhysicsSystem() {
+		for (auto& [key, pShape] : m_shapes) {
+			pShape->release();
+		}
+		m_shapes.clear();
 		m_pDefaultMaterial->release();
-		m_pCpuDispatcher->release();
+		delete m_pCpuDispatcher;
 		m_pPhysics->release();
 
 #ifdef _DEBUG
@@ -82,10 +170,19 @@ namespace sa {
 		physx::PxSceneDesc desc(m_pPhysics->getTolerancesScale());
 		desc.gravity = physx::PxVec3(0.0f, -9.82f, 0.0f);
 		desc.cpuDispatcher = m_pCpuDispatcher;
-		desc.filterShader = physx::PxDefaultSimulationFilterShader;
+		desc.filterShader = SimulationFilterShader;
 		desc.flags = physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS;
 		return m_pPhysics->createScene(desc);
 	}
+
+	void PhysicsSystem::setWorkerCount(uint32_t workerCount) {
+		m_pCpuDispatcher->setWorkerCount(workerCount);
+	}
+
+	uint32_t PhysicsSystem::getWorkerCount() const {
+		return m_pCpuDispatcher->getWorkerCount();
+	}
+
 	physx::PxRigidActor* PhysicsSystem::createRigidBody(bool isSatic, physx::PxTransform transform) {
 		if (isSatic)
 			return m_pPhysics->createRigidStatic(transform);
@@ -96,40 +193,68 @@ namespace sa {
 		return m_pPhysics->createMaterial(staticFriction, dynamicFriction, restitution);
 	}
 
-	physx::PxShape* PhysicsSystem::createShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial) {
+	physx::PxAggregate* PhysicsSystem::createAggregate(uint32_t maxActorCount, bool selfCollision) {
+		return m_pPhysics->createAggregate(std::min(maxActorCount, PHYSICS_MAX_AGGREGATE_SIZE), selfCollision);
+	}
+
+	physx::PxShape* PhysicsSystem::createShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial, const Vector3& offset, bool isTrigger) {
 		if (!pMaterial)
 			pMaterial = m_pDefaultMaterial;
-		size_t hashedValue;
-		switch (pGeometry->getType()) {
-		case physx::PxGeometryType::eBOX: {
-			physx::PxBoxGeometry* pBox = (physx::PxBoxGeometry*)pGeometry;
-			std::string str(32, 0);
-			sprintf_s(str.data(), str.size(), "Box%.3f%.3f%.3f", pBox->halfExtents.x, pBox->halfExtents.y, pBox->halfExtents.z);
-			hashedValue = std::hash<std::string>()(str);
-			break;
-		}
-		case physx::PxGeometryType::eSPHERE: {
-			physx::PxSphereGeometry* pSphere = (physx::PxSphereGeometry*)pGeometry;
-			std::string str(17, 0);
-			sprintf_s(str.data(), str.size(), "Sphere%.3f", pSphere->radius);
-			hashedValue = std::hash<std::string>()(str);
-			break;
-		}
-		default:
-			break;
+
+		ShapeKey key;
+		if (!GetShapeKey(*pGeometry, pMaterial, offset, isTrigger, &key)) {
+			physx::PxShape* pShape = createExclusiveShape(pGeometry, pMaterial, isTrigger);
+			pShape->setLocalPose(physx::PxTransform(toPxVec(offset)));
+			return pShape;
 		}
-		if (m_shapes.count(hashedValue)) {
-			return m_shapes.at(hashedValue);
+
+		auto it = m_shapes.find(key);
+		if (it != m_shapes.end()) {
+			it->second->acquireReference();
+			return it->second;
 		}
-		m_shapes[hashedValue] = m_pPhysics->createShape(*pGeometry, *pMaterial);
 
-		return m_shapes[hashedValue];
+		physx::PxShape* pShape = m_pPhysics->createShape(*pGeometry, *pMaterial);
+		pShape->setLocalPose(physx::PxTransform(toPxVec(offset)));
+		pShape->setQueryFilterData(physx::PxFilterData(PHYSICS_DEFAULT_QUERY_LAYER, 0, 0, 0));
+		if (isTrigger)
+			SetTrigger(pShape);
+		// One reference for the cache and one for the caller
+		pShape->acquireReference();
+		m_shapes[key] = pShape;
+		return pShape;
 	}
 
-	physx::PxShape* PhysicsSystem::createExclusiveShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial) {
+	physx::PxShape* PhysicsSystem::createExclusiveShape(const physx::PxGeometry* pGeometry, physx::PxMaterial* pMaterial, bool isTrigger) {
 		if (!pMaterial)
 			pMaterial = m_pDefaultMaterial;
-		return m_pPhysics->createShape(*pGeometry, *pMaterial, true);
+		physx::PxShape* pShape = m_pPhysics->createShape(*pGeometry, *pMaterial, true);
+		pShape->setQueryFilterData(physx::PxFilterData(PHYSICS_DEFAULT_QUERY_LAYER, 0, 0, 0));
+		if (isTrigger)
+			SetTrigger(pShape);
+		return pShape;
+	}
+
+	void PhysicsSystem::releaseShape(physx::PxShape* pShape) {
+		if (!pShape)
+			return;
+		if (pShape->isExclusive()) {
+			pShape->release();
+			return;
+		}
+
+		pShape->release();
+		if (pShape->getReferenceCount() > 1)
+			return;
+
+		// Only the reference of the cache is left
+		physx::PxMaterial* pMaterial = nullptr;
+		pShape->getMaterials(&pMaterial, 1);
+		const bool isTrigger = pShape->getFlags() & physx::PxShapeFlag::eTRIGGER_SHAPE;
+		ShapeKey key;
+		if (GetShapeKey(pShape->getGeometry().any(), pMaterial, toVector(pShape->getLocalPose().p), isTrigger, &key))
+			m_shapes.erase(key);
+		pShape->release();
 	}
 
 	Vector3 PhysicsSystem::toVector(physx::PxVec3 vec) {
@@ -0,0 +1,399 @@
+#include "pch.h"
+#include "Graphics/RenderGraph.h"
+
+#include "Renderer.hpp"
+
+#include "Tools/Profiler.h"
+
+namespace sa {
+
+	static bool isWriteTransition(Transition transition) {
+		switch (transition) {
+		case Transition::RENDER_PROGRAM_OUTPUT:
+		case Transition::RENDER_PROGRAM_DEPTH_OUTPUT:
+		case Transition::COMPUTE_SHADER_WRITE:
+		case Transition::COMPUTE_SHADER_READ_WRITE:
+		case Transition::FRAGMENT_SHADER_WRITE:
+		case Transition::FRAGMENT_SHADER_READ_WRITE:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Render programs synchronize their attachments with their own subpass dependencies
+	static bool isAttachmentTransition(Transition transition) {
+		return transition == Transition::RENDER_PROGRAM_OUTPUT || transition == Transition::RENDER_PROGRAM_DEPTH_OUTPUT;
+	}
+
+	// A read and a write of the same resource in one pass become one access
+	static Transition mergeTransitions(Transition first, Transition second) {
+		if (first == second)
+			return first;
+		if ((first == Transition::COMPUTE_SHADER_READ && second == Transition::COMPUTE_SHADER_WRITE) ||
+			(first == Transition::COMPUTE_SHADER_WRITE && second == Transition::COMPUTE_SHADER_READ))
+			return Transition::COMPUTE_SHADER_READ_WRITE;
+		if ((first == Transition::FRAGMENT_SHADER_READ && second == Transition::FRAGMENT_SHADER_WRITE) ||
+			(first == Transition::FRAGMENT_SHADER_WRITE && second == Transition::FRAGMENT_SHADER_READ))
+			return Transition::FRAGMENT_SHADER_READ_WRITE;
+		return isWriteTransition(second) ? second : first;
+	}
+
+	RenderGraph::PassBuilder::PassBuilder(RenderGraph* pGraph, Pass* pPass)
+		: m_pGraph(pGraph)
+		, m_pPass(pPass)
+	{
+	}
+
+	RenderGraphResource RenderGraph::PassBuilder::read(RenderGraphResource resource, Transition transition) {
+		if (resource >= m_pGraph->m_resources.size())
+			throw std::runtime_error("Render graph pass " + m_pPass->name + " reads an invalid resource");
+		for (auto& access : m_pPass->accesses) {
+			if (access.resource == resource) {
+				access.transition = mergeTransitions(access.transition, transition);
+				access.isRead = true;
+				return resource;
+			}
+		}
+		m_pPass->accesses.push_back({ resource, transition, true, false });
+		return resource;
+	}
+
+	RenderGraphResource RenderGraph::PassBuilder::write(RenderGraphResource resource, Transition transition) {
+		if (resource >= m_pGraph->m_resources.size())
+			throw std::runtime_error("Render graph pass " + m_pPass->name + " writes an invalid resource");
+		for (auto& access : m_pPass->accesses) {
+			if (access.resource == resource) {
+				access.transition = mergeTransitions(access.transition, transition);
+				access.isWrite = true;
+				return resource;
+			}
+		}
+		m_pPass->accesses.push_back({ resource, transition, false, true });
+		return resource;
+	}
+
+	void RenderGraph::PassBuilder::setSideEffects() {
+		m_pPass->hasSideEffects = true;
+	}
+
+	void RenderGraph::sortPasses() {
+		// Two passes depend on each other if they touch the same resource and at least one of them writes it
+		const size_t passCount = m_passes.size();
+		std::vector<std::vector<uint32_t>> dependents(passCount);
+		std::vector<uint32_t> dependencyCount(passCount, 0);
+		for (uint32_t j = 0; j < passCount; j++) {
+			for (uint32_t i = 0; i < j; i++) {
+				bool dependent = m_passes[i].isOrdered || m_passes[j].isOrdered;
+				for (size_t a = 0; a < m_passes[i].accesses.size() && !dependent; a++) {
+					for (const auto& access : m_passes[j].accesses) {
+						const Access& other = m_passes[i].accesses[a];
+						if (other.resource == access.resource && (other.isWrite || access.isWrite)) {
+							dependent = true;
+							break;
+						}
+					}
+				}
+				if (dependent) {
+					dependents[i].push_back(j);
+					dependencyCount[j]++;
+				}
+			}
+		}
+
+		// Passes keep the order they were added in, except compute passes which start as soon as they can
+		m_executionOrder.clear();
+		m_executionOrder.reserve(passCount);
+		std::vector<uint32_t> ready;
+		for (uint32_t i = 0; i < passCount; i++) {
+			if (dependencyCount[i] == 0)
+				ready.push_back(i);
+		}
+		while (!ready.empty()) {
+			auto next = std::min_element(ready.begin(), ready.end(), [&](uint32_t a, uint32_t b) {
+				bool aCompute = m_passes[a].queue == RenderGraphQueue::COMPUTE;
+				bool bCompute = m_passes[b].queue == RenderGraphQueue::COMPUTE;
+				if (aCompute != bCompute)
+					return aCompute;
+				return a < b;
+			});
+			uint32_t pass = *next;
+			ready.erase(next);
+			m_executionOrder.push_back(pass);
+
+			for (uint32_t dependent : dependents[pass]) {
+				if (--dependencyCount[dependent] == 0)
+					ready.push_back(dependent);
+			}
+		}
+	}
+
+	void RenderGraph::cullPasses() {
+		std::vector<bool> isNeeded(m_resources.size(), false);
+		for (size_t i = 0; i < m_resources.size(); i++) {
+			isNeeded[i] = m_resources[i].isOutput;
+		}
+
+		for (auto it = m_executionOrder.rbegin(); it != m_executionOrder.rend(); it++) {
+			Pass& pass = m_passes[*it];
+			bool isUsed = pass.hasSideEffects || pass.isOrdered;
+			for (const auto& access : pass.accesses) {
+				if (access.isWrite && isNeeded[access.resource]) {
+					isUsed = true;
+					break;
+				}
+			}
+			pass.isCulled = !isUsed;
+			if (pass.isCulled)
+				continue;
+
+			for (const auto& access : pass.accesses) {
+				if (access.isRead)
+					isNeeded[access.resource] = true;
+			}
+		}
+	}
+
+	void RenderGraph::allocateTransientTextures() {
+		// Lifetimes are positions in the execution order, textures only used by culled passes are never placed
+		std::vector<TransientTextureRequest> requests;
+		std::vector<RenderGraphResource> requestResources;
+		for (uint32_t position = 0; position < m_executionOrder.size(); position++) {
+			const Pass& pass = m_passes[m_executionOrder[position]];
+			if (pass.isCulled)
+				continue;
+			for (const auto& access : pass.accesses) {
+				if (!m_resources[access.resource].isTransient)
+					continue;
+				auto it = std::find(requestResources.begin(), requestResources.end(), access.resource);
+				if (it == requestResources.end()) {
+					requestResources.push_back(access.resource);
+					requests.push_back({ m_resources[access.resource].transientDesc, position, position });
+				}
+				else {
+					requests[it - requestResources.begin()].lastUse = position;
+				}
+			}
+		}
+
+		for (auto& resource : m_resources) {
+			if (resource.isTransient) {
+				resource.pTexture = nullptr;
+				resource.pTransientTexture = nullptr;
+			}
+		}
+		if (requests.empty())
+			return;
+
+		std::vector<const TransientTexture*> textures(requests.size());
+		Renderer::Get().allocateTransientTextures(requests.data(), static_cast<uint32_t>(requests.size()), textures.data());
+		for (size_t i = 0; i < requests.size(); i++) {
+			Resource& resource = m_resources[requestResources[i]];
+			resource.pTransientTexture = textures[i];
+			resource.pTexture = &textures[i]->texture;
+		}
+	}
+
+	void RenderGraph::planBarriers() {
+		struct State {
+			Transition transition;
+			bool isWritten;
+		};
+		std::vector<State> states(m_resources.size());
+		for (size_t i = 0; i < m_resources.size(); i++) {
+			states[i] = { m_resources[i].initialState, isWriteTransition(m_resources[i].initialState) };
+		}
+
+		m_barrierCount = 0;
+		for (uint32_t index : m_executionOrder) {
+			Pass& pass = m_passes[index];
+			pass.textureBarriers.clear();
+			pass.bufferBarriers.clear();
+			if (pass.isCulled)
+				continue;
+
+			for (const auto& access : pass.accesses) {
+				const Resource& resource = m_resources[access.resource];
+				State& state = states[access.resource];
+
+				bool needsBarrier = state.transition != access.transition
+					|| (state.isWritten && !isAttachmentTransition(access.transition));
+				// Buffers have no layout, nothing to wait for before their first use
+				if (resource.pBuffer && state.transition == Transition::NONE)
+					needsBarrier = false;
+
+				if (needsBarrier) {
+					if (resource.pTexture)
+						pass.textureBarriers.push_back({ resource.pTexture, state.transition, access.transition });
+					else
+						pass.bufferBarriers.push_back({ resource.pBuffer, state.transition, access.transition });
+				}
+				state.transition = access.transition;
+				state.isWritten = access.isWrite;
+			}
+
+			if (!pass.textureBarriers.empty() || !pass.bufferBarriers.empty())
+				m_barrierCount++;
+		}
+	}
+
+	RenderGraph::RenderGraph()
+		: m_isCompiled(false)
+		, m_barrierCount(0)
+	{
+	}
+
+	RenderGraphResource RenderGraph::importTexture(const std::string& name, const Texture& texture, Transition currentState) {
+		const ImageView& view = texture.getView();
+		auto key = std::make_tuple(texture.getImageHandle(), view.getBaseMipLevel(), view.getBaseArrayLayer());
+		auto it = m_importedTextures.find(key);
+		if (it != m_importedTextures.end()) {
+			m_namedResources[name] = it->second;
+			return it->second;
+		}
+
+		RenderGraphResource resource = static_cast<RenderGraphResource>(m_resources.size());
+		m_resources.push_back({
+			.name = name,
+			.pTexture = &texture,
+			.initialState = currentState
+		});
+		m_importedTextures[key] = resource;
+		m_namedResources[name] = resource;
+		m_isCompiled = false;
+		return resource;
+	}
+
+	RenderGraphResource RenderGraph::importBuffer(const std::string& name, const Buffer& buffer, Transition currentState) {
+		const void* key = static_cast<const DeviceBuffer*>(buffer);
+		auto it = m_importedBuffers.find(key);
+		if (it != m_importedBuffers.end()) {
+			m_namedResources[name] = it->second;
+			return it->second;
+		}
+
+		RenderGraphResource resource = static_cast<RenderGraphResource>(m_resources.size());
+		m_resources.push_back({
+			.name = name,
+			.pBuffer = &buffer,
+			.initialState = currentState
+		});
+		m_importedBuffers[key] = resource;
+		m_namedResources[name] = resource;
+		m_isCompiled = false;
+		return resource;
+	}
+
+	RenderGraphResource RenderGraph::createTexture(const std::string& name, const TransientTextureDesc& desc) {
+		RenderGraphResource resource = static_cast<RenderGraphResource>(m_resources.size());
+		m_resources.push_back({
+			.name = name,
+			.initialState = Transition::ALIASED,
+			.isTransient = true,
+			.transientDesc = desc
+		});
+		m_namedResources[name] = resource;
+		m_isCompiled = false;
+		return resource;
+	}
+
+	RenderGraphResource RenderGraph::getResource(const std::string& name) const {
+		auto it = m_namedResources.find(name);
+		if (it == m_namedResources.end())
+			return RENDER_GRAPH_INVALID_RESOURCE;
+		return it->second;
+	}
+
+	const Texture& RenderGraph::getTexture(RenderGraphResource resource) const {
+		if (resource >= m_resources.size() || !m_resources[resource].pTexture)
+			throw std::runtime_error("Render graph resource has no texture");
+		return *m_resources[resource].pTexture;
+	}
+
+	const std::vector<Texture>& RenderGraph::getMipLevelTextures(RenderGraphResource resource) const {
+		if (resource >= m_resources.size() || !m_resources[resource].pTransientTexture)
+			throw std::runtime_error("Render graph resource is not a placed transient texture");
+		return m_resources[resource].pTransientTexture->mipLevelTextures;
+	}
+
+	void RenderGraph::markOutput(RenderGraphResource resource) {
+		if (resource >= m_resources.size())
+			throw std::runtime_error("Invalid render graph resource");
+		m_resources[resource].isOutput = true;
+		m_isCompiled = false;
+	}
+
+	void RenderGraph::addPass(const std::string& name, RenderGraphQueue queue, const std::function<void(PassBuilder&)>& setup, const ExecuteFunction& execute) {
+		Pass& pass = m_passes.emplace_back();
+		pass.name = name;
+		pass.queue = queue;
+		pass.execute = execute;
+
+		PassBuilder builder(this, &pass);
+		setup(builder);
+		m_isCompiled = false;
+	}
+
+	void RenderGraph::addOrderedPass(const std::string& name, const ExecuteFunction& execute) {
+		Pass& pass = m_passes.emplace_back();
+		pass.name = name;
+		pass.queue = RenderGraphQueue::GRAPHICS;
+		pass.isOrdered = true;
+		pass.execute = execute;
+		m_isCompiled = false;
+	}
+
+	void RenderGraph::compile() {
+		SA_PROFILE_FUNCTION();
+		sortPasses();
+		cullPasses();
+		allocateTransientTextures();
+		planBarriers();
+		m_isCompiled = true;
+	}
+
+	bool RenderGraph::execute(RenderContext& context) {
+		SA_PROFILE_FUNCTION();
+		if (!m_isCompiled)
+			compile();
+
+		for (uint32_t index : m_executionOrder) {
+			Pass& pass = m_passes[index];
+			if (pass.isCulled)
+				continue;
+
+			context.barriers(pass.textureBarriers, pass.bufferBarriers);
+
+			uint32_t gpuScope = context.beginGpuScope(pass.name.c_str());
+			bool result = pass.execute(context);
+			context.endGpuScope(gpuScope);
+			if (!result)
+				return false;
+		}
+		return true;
+	}
+
+	void RenderGraph::clear() {
+		m_resources.clear();
+		m_passes.clear();
+		m_executionOrder.clear();
+		m_importedTextures.clear();
+		m_importedBuffers.clear();
+		m_namedResources.clear();
+		m_isCompiled = false;
+		m_barrierCount = 0;
+	}
+
+	uint32_t RenderGraph::getPassCount() const {
+		return static_cast<uint32_t>(m_passes.size());
+	}
+
+	uint32_t RenderGraph::getCulledPassCount() const {
+		return static_cast<uint32_t>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.isCulled; }));
+	}
+
+	uint32_t RenderGraph::getBarrierCount() const {
+		return m_barrierCount;
+	}
+
+}
@@ -16,6 +16,10 @@ namespace sa {
 
 	void RenderPipeline::addLayer(BasicRenderLayer* pLayer) {
 		m_renderLayers.push_back(pLayer);
+
+		const std::string name = pLayer->getName();
+		m_layerScopeNames.push_back({ name + "::preRender", name + "::render", name + "::postRender" });
+
 		pLayer->init();
 	}
 
@@ -38,10 +42,14 @@ namespace sa {
 	void RenderPipeline::preRender(RenderContext& context, SceneCollection& sceneCollection) {
 		SA_PROFILE_FUNCTION();
 		
-		for (auto& layer : m_renderLayers) {
-			if (!layer->isActive())
+		for (size_t i = 0; i < m_renderLayers.size(); i++) {
+			BasicRenderLayer* pLayer = m_renderLayers[i];
+			if (!pLayer->isActive())
 				continue;
-			if (!layer->preRender(context, sceneCollection))
+			uint32_t gpuScope = context.beginGpuScope(m_layerScopeNames[i].preRender.c_str());
+			bool result = pLayer->preRender(context, sceneCollection);
+			context.endGpuScope(gpuScope);
+			if (!result)
 				return;
 		}
 
@@ -52,17 +60,32 @@ namespace sa {
 		if (!pRenderTarget->isActive())
 			return;
 
-		for (auto& layer : m_renderLayers) {
-			if (!layer->isActive())
+		m_renderGraph.clear();
+		bool isComplete = true;
+		for (size_t i = 0; i < m_renderLayers.size(); i++) {
+			BasicRenderLayer* pLayer = m_renderLayers[i];
+			if (!pLayer->isActive())
 				continue;
-			if (!layer->render(context, pCamera, pRenderTarget, sceneCollection))
-				return;
+			if (!pLayer->addRenderPasses(m_renderGraph, m_layerScopeNames[i].render, context, pCamera, pRenderTarget, sceneCollection)) {
+				isComplete = false;
+				break;
+			}
 		}
+		// A graph missing the passes of the failed layer would read resources nothing wrote
+		if (!isComplete)
+			return;
+		m_renderGraph.compile();
+		if (!m_renderGraph.execute(context))
+			return;
 
-		for (auto& layer : m_renderLayers) {
-			if(!layer->isActive())
+		for (size_t i = 0; i < m_renderLayers.size(); i++) {
+			BasicRenderLayer* pLayer = m_renderLayers[i];
+			if(!pLayer->isActive())
 				continue;
-			if (!layer->postRender(context, pCamera, pRenderTarget, sceneCollection))
+			uint32_t gpuScope = context.beginGpuScope(m_layerScopeNames[i].postRender.c_str());
+			bool result = pLayer->postRender(context, pCamera, pRenderTarget, sceneCollection);
+			context.endGpuScope(gpuScope);
+			if (!result)
 				return;
 		}
 
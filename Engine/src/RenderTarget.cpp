@@ -95,6 +95,30 @@ namespace sa {
 		return m_extent;
 	}
 
+	Extent RenderTarget::getRenderExtent() const {
+		const float scale = m_dynamicResolution.getScale();
+		return {
+			std::clamp(static_cast<uint32_t>(m_extent.width * scale + 0.5f), 1U, m_extent.width),
+			std::clamp(static_cast<uint32_t>(m_extent.height * scale + 0.5f), 1U, m_extent.height)
+		};
+	}
+
+	glm::vec2 RenderTarget::getOutputUVScale() const {
+		const Extent renderExtent = getRenderExtent();
+		return {
+			static_cast<float>(renderExtent.width) / m_extent.width,
+			static_cast<float>(renderExtent.height) / m_extent.height
+		};
+	}
+
+	DynamicResolution& RenderTarget::getDynamicResolution() {
+		return m_dynamicResolution;
+	}
+
+	const DynamicResolution& RenderTarget::getDynamicResolution() const {
+		return m_dynamicResolution;
+	}
+
 	const DynamicTexture* RenderTarget::getOutputTextureDynamic() const {
 		return m_pOutputTexture;
 	}
@@ -4,6 +4,28 @@
 #include "ECS/Entity.h"
 #include "Scene.h"
 namespace comp {
+	void* RigidBody::ToUserData(entt::entity entity) {
+		return reinterpret_cast<void*>(static_cast<uintptr_t>(entt::to_integral(entity)));
+	}
+
+	entt::entity RigidBody::GetEntity(const physx::PxActor* pActor) {
+		return static_cast<entt::entity>(reinterpret_cast<uintptr_t>(pActor->userData));
+	}
+
+	void RigidBody::InvalidateBody(physx::PxScene* pScene, const physx::PxActor* pActor) {
+		if (pScene && pScene->userData)
+			static_cast<sa::Scene*>(pScene->userData)->invalidatePhysicsBody(GetEntity(pActor));
+	}
+
+	void RigidBody::ReleaseActor(physx::PxScene* pScene, physx::PxRigidActor* pActor, bool wakeOnLostTouch) {
+		if (pScene && pScene->userData)
+			static_cast<sa::Scene*>(pScene->userData)->m_physicsEvents.onActorReleased(pActor);
+		// Releasing takes the actor out of its aggregate, removing it first would put it back in the scene
+		if (pScene && !pActor->getAggregate())
+			pScene->removeActor(*pActor, wakeOnLostTouch);
+		pActor->release();
+	}
+
 	RigidBody::RigidBody(bool isStatic)
 		: m_isStatic(isStatic)
 	{
@@ -11,11 +33,10 @@ namespace comp {
 
 	RigidBody& RigidBody::operator=(const RigidBody& other) {
 		// copy actor
-		sa::Entity* userData = nullptr;
+		void* userData = nullptr;
 		if (other.isStatic() != isStatic()) {
-			m_pActor->getScene()->removeActor(*m_pActor);
-			userData = (sa::Entity*)m_pActor->userData;
-			m_pActor->release();
+			userData = m_pActor->userData;
+			ReleaseActor(m_pActor->getScene(), m_pActor, true);
 			m_pActor = nullptr;
 
 
@@ -23,6 +44,7 @@ namespace comp {
 
 			m_pActor->userData = userData;
 			other.m_pActor->getScene()->addActor(*m_pActor);
+			InvalidateBody(m_pActor->getScene(), m_pActor);
 		}
 		else {
 			m_pActor->setGlobalPose(other.m_pActor->getGlobalPose());
@@ -96,14 +118,9 @@ namespace comp {
 		oldShapes.resize(shapeCount);
 		m_pActor->getShapes(oldShapes.data(), oldShapes.size());
 		
+		physx::PxScene* pScene = pOldActor->getScene();
 
-		sa::Entity* e = static_cast<sa::Entity*>(m_pActor->userData);
-
-		comp::Transform* transform = e->getComponent<comp::Transform>();
-		if (!transform)
-			transform = e->addComponent<comp::Transform>();
-
-		m_pActor = sa::PhysicsSystem::get().createRigidBody(m_isStatic, *transform);
+		m_pActor = sa::PhysicsSystem::get().createRigidBody(m_isStatic, pOldActor->getGlobalPose());
 		m_pActor->userData = pOldActor->userData;
 
 		for (const auto& pShape : oldShapes) {
@@ -111,10 +128,10 @@ namespace comp {
 		}
 
 		if (pOldActor) {
-			e->getScene()->m_pPhysicsScene->removeActor(*pOldActor, false);
-			pOldActor->release();
+			ReleaseActor(pScene, pOldActor, false);
 		}
-		e->getScene()->m_pPhysicsScene->addActor(*m_pActor);
+		pScene->addActor(*m_pActor);
+		InvalidateBody(pScene, m_pActor);
 	
 		setMass(oldMass);
 	}
@@ -159,8 +176,13 @@ namespace comp {
 			SA_DEBUG_LOG_ERROR("Failed to create rigidbody actor");
 			return;
 		}
-		m_pActor->userData = new sa::Entity(*e);
+		m_pActor->userData = ToUserData(*e);
 		e->getScene()->m_pPhysicsScene->addActor(*m_pActor);
+		e->getScene()->invalidatePhysicsBody(*e);
+
+		m_previousPose = *transform;
+		m_currentPose = m_previousPose;
+		m_writtenPose = m_previousPose;
 	}
 
 	void RigidBody::onUpdate(sa::Entity* e) {
@@ -186,24 +208,21 @@ namespace comp {
 			transform = e->addComponent<comp::Transform>();
 
 		m_pActor = sa::PhysicsSystem::get().createRigidBody(m_isStatic, *transform);
-		m_pActor->userData = new sa::Entity(*e);
+		m_pActor->userData = ToUserData(*e);
 		
 		for (const auto& pShape : oldShapes) {
 			m_pActor->attachShape(*pShape);
 		}
 
 		if (pOldActor) {
-			delete pOldActor->userData;
-			e->getScene()->m_pPhysicsScene->removeActor(*pOldActor, false);
-			pOldActor->release();
+			ReleaseActor(e->getScene()->m_pPhysicsScene, pOldActor, false);
 		}
 		e->getScene()->m_pPhysicsScene->addActor(*m_pActor);
 	}
 
 	void RigidBody::onDestroy(sa::Entity* e) {
-		delete m_pActor->userData;
-		e->getScene()->m_pPhysicsScene->removeActor(*m_pActor);
-		m_pActor->release();
+		e->getScene()->invalidatePhysicsBody(*e);
+		ReleaseActor(e->getScene()->m_pPhysicsScene, m_pActor, true);
 	}
 
 }
\ No newline at end of file
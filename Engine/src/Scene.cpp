@@ -2,8 +2,40 @@
 #include "Scene.h"
 
 #include "ECS/Components.h"
+#include "Tools/Clock.h"
+
+// Start of every physics snapshot, snapshots of another layout are refused
+#define PHYSICS_SNAPSHOT_MAGIC 0x53505341U
+#define PHYSICS_SNAPSHOT_VERSION 1U
 
 namespace sa {
+
+	struct PhysicsSnapshotHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t bodyCount;
+		float accumulator;
+	};
+
+	enum PhysicsBodyStateFlagBits : uint32_t {
+		BODY_DYNAMIC = 1,
+		BODY_KINEMATIC = 2,
+		BODY_SLEEPING = 4,
+		BODY_HAS_KINEMATIC_TARGET = 8,
+	};
+
+	// Written as is, a snapshot is only meant to be read back by the same build
+	struct PhysicsBodyState {
+		entt::entity entity;
+		uint32_t flags;
+		physx::PxTransform pose;
+		// Kept so interpolation carries on from where it was
+		physx::PxTransform previousPose;
+		physx::PxTransform kinematicTarget;
+		physx::PxVec3 linearVelocity;
+		physx::PxVec3 angularVelocity;
+		float wakeCounter;
+	};
 	void Scene::registerComponentCallBacks() {
 		registerComponentCallBack<comp::Name>();
 		registerComponentCallBack<comp::Transform>();
@@ -12,28 +44,461 @@ namespace sa {
 		registerComponentCallBack<comp::RigidBody>();
 		registerComponentCallBack<comp::BoxCollider>();
 		registerComponentCallBack<comp::SphereCollider>();
+		registerComponentCallBack<comp::PhysicsAggregate>();
 		registerComponentCallBack<comp::Camera>();
 	}
 
 
-	void Scene::updatePhysics(float dt) {
-		// Physics
+	static bool PosesEqual(const physx::PxTransform& first, const physx::PxTransform& second) {
+		return first.p == second.p &&
+			first.q.x == second.q.x && first.q.y == second.q.y && first.q.z == second.q.z && first.q.w == second.q.w;
+	}
+
+	void Scene::pushEditedTransforms() {
+		// Only transforms edited since they were last written from the simulation are pushed
 		m_reg.view<comp::RigidBody, comp::Transform>().each([&](comp::RigidBody& rb, const comp::Transform& transform) {
+			const physx::PxTransform pose = transform;
+			if (PosesEqual(pose, rb.m_writtenPose))
+				return;
 			rb.setGlobalPose(transform);
+			rb.m_previousPose = pose;
+			rb.m_currentPose = pose;
+			rb.m_writtenPose = pose;
 		});
+	}
 
-		m_pPhysicsScene->simulate(dt);
-		m_pPhysicsScene->fetchResults(true);
+	void Scene::simulatePhysicsStep(float step) {
+		Clock clock;
+		m_pPhysicsScene->simulate(step);
+		m_physicsSimulateTime = clock.getElapsedTime();
+	}
 
-		uint32_t actorCount = -1;
+	void Scene::fetchPhysicsStep() {
+		Clock clock;
+		m_pPhysicsScene->fetchResults(true);
+		const float stepTime = m_physicsSimulateTime + clock.getElapsedTime();
+		m_physicsEvents.clearReleasedActors();
+		m_physicsStepCount++;
+
+		// Results are gathered into packed arrays first, so reading PhysX and writing components do not interleave
+		m_bodiesMovedInLastStep.clear();
+		m_posesMovedInLastStep.clear();
+		uint32_t actorCount = 0;
 		physx::PxActor** ppActors = m_pPhysicsScene->getActiveActors(actorCount);
+		m_bodiesMovedInLastStep.reserve(actorCount);
+		m_posesMovedInLastStep.reserve(actorCount);
 		for (uint32_t i = 0U; i < actorCount; i++) {
 			physx::PxActor* pActor = ppActors[i];
 			if (physx::PxRigidActor* rigidActor = pActor->is<physx::PxRigidActor>()) {
-				comp::Transform* transform = ((Entity*)pActor->userData)->getComponent<comp::Transform>();
-				*transform = rigidActor->getGlobalPose();
+				m_bodiesMovedInLastStep.push_back(comp::RigidBody::GetEntity(rigidActor));
+				m_posesMovedInLastStep.push_back(rigidActor->getGlobalPose());
+			}
+		}
+
+		auto& rigidBodies = m_reg.storage<comp::RigidBody>();
+		for (size_t i = 0; i < m_bodiesMovedInLastStep.size(); i++) {
+			if (!rigidBodies.contains(m_bodiesMovedInLastStep[i]))
+				continue;
+			comp::RigidBody& rb = rigidBodies.get(m_bodiesMovedInLastStep[i]);
+			rb.m_previousPose = rb.m_currentPose;
+			rb.m_currentPose = m_posesMovedInLastStep[i];
+			rb.m_lastMovedStep = m_physicsStepCount;
+		}
+		m_bodiesToWrite.insert(m_bodiesToWrite.end(), m_bodiesMovedInLastStep.begin(), m_bodiesMovedInLastStep.end());
+
+		physx::PxSimulationStatistics stats;
+		m_pPhysicsScene->getSimulationStatistics(stats);
+		m_physicsStatistics.stepCount = m_physicsStepCount;
+		m_physicsStatistics.activeActorCount = actorCount;
+		m_physicsStatistics.activeDynamicBodyCount = stats.nbActiveDynamicBodies;
+		m_physicsStatistics.broadphasePairCount = stats.nbDiscreteContactPairsTotal;
+		m_physicsStatistics.newPairCount = stats.nbNewPairs;
+		m_physicsStatistics.lostPairCount = stats.nbLostPairs;
+		m_physicsStatistics.stepTime = stepTime;
+		m_physicsStatistics.totalStepTime += stepTime;
+	}
+
+	void Scene::beginPhysicsStep(float dt) {
+		SA_PROFILE_FUNCTION();
+		pushEditedTransforms();
+		updatePhysicsAggregates();
+
+		const float step = m_physicsSettings.fixedTimeStep;
+		m_physicsAccumulator = std::min(m_physicsAccumulator + dt, step * m_physicsSettings.maxSubSteps);
+		const uint32_t stepCount = static_cast<uint32_t>(m_physicsAccumulator / step);
+		if (stepCount == 0)
+			return;
+		m_physicsAccumulator -= step * stepCount;
+
+		// Only the last step overlaps with the rest of the frame, the ones before it have to finish first
+		for (uint32_t i = 1; i < stepCount; i++) {
+			simulatePhysicsStep(step);
+			fetchPhysicsStep();
+		}
+		simulatePhysicsStep(step);
+		m_isPhysicsSimulating = true;
+	}
+
+	void Scene::releasePhysicsAggregates() {
+		// Releasing an aggregate puts its actors back into the scene on their own
+		for (auto& [root, group] : m_physicsAggregateGroups) {
+			for (physx::PxAggregate* pAggregate : group.aggregates) {
+				pAggregate->release();
 			}
 		}
+		m_physicsAggregateGroups.clear();
+		m_aggregatedBodies.clear();
+	}
+
+	void Scene::releasePhysicsAggregateGroup(entt::entity root) {
+		auto it = m_physicsAggregateGroups.find(root);
+		if (it == m_physicsAggregateGroups.end())
+			return;
+		for (physx::PxAggregate* pAggregate : it->second.aggregates) {
+			pAggregate->release();
+		}
+		m_physicsAggregateGroups.erase(it);
+		std::erase_if(m_aggregatedBodies, [&](const auto& pair) { return pair.second == root; });
+	}
+
+	void Scene::updatePhysicsAggregates() {
+		SA_PROFILE_FUNCTION();
+		for (const Entity& entity : m_hierarchy.takeChangedEntities()) {
+			if (!entity.isNull() && m_reg.valid(entity))
+				m_dirtyAggregateRoots.insert(findHierarchyRoot(entity));
+		}
+
+		std::unordered_set<entt::entity> touchedRoots;
+		if (m_physicsAggregatesDirty) {
+			m_physicsAggregatesDirty = false;
+			releasePhysicsAggregates();
+			m_reg.view<comp::RigidBody>().each([&](entt::entity e, const comp::RigidBody&) {
+				updateAggregatedBody(e, touchedRoots);
+			});
+		}
+		else {
+			for (entt::entity root : m_dirtyAggregateRoots) {
+				if (!m_reg.valid(root))
+					continue;
+				// A group whose self collision changed has to be recreated, its bodies are added back below
+				const Entity rootEntity(this, root);
+				auto releaseChangedGroup = [&](const Entity& entity) {
+					auto it = m_physicsAggregateGroups.find(entity);
+					if (it == m_physicsAggregateGroups.end())
+						return;
+					bool selfCollision = false;
+					if (findAggregateRoot(entity, &selfCollision) != it->first || it->second.selfCollision != selfCollision)
+						releasePhysicsAggregateGroup(entity);
+				};
+				releaseChangedGroup(rootEntity);
+				m_hierarchy.forEachChild(rootEntity, [&](const Entity& child, const Entity&) {
+					releaseChangedGroup(child);
+				});
+
+				updateAggregatedBody(root, touchedRoots);
+				m_hierarchy.forEachChild(rootEntity, [&](const Entity& child, const Entity&) {
+					updateAggregatedBody(child, touchedRoots);
+				});
+			}
+			for (entt::entity e : m_dirtyAggregateBodies) {
+				updateAggregatedBody(e, touchedRoots);
+			}
+		}
+		m_dirtyAggregateRoots.clear();
+		m_dirtyAggregateBodies.clear();
+
+		// Groups that lost bodies may be left with empty aggregates
+		for (entt::entity root : touchedRoots) {
+			auto it = m_physicsAggregateGroups.find(root);
+			if (it == m_physicsAggregateGroups.end())
+				continue;
+			std::erase_if(it->second.aggregates, [](physx::PxAggregate* pAggregate) {
+				if (pAggregate->getNbActors() > 0)
+					return false;
+				pAggregate->release();
+				return true;
+			});
+			if (it->second.aggregates.empty())
+				m_physicsAggregateGroups.erase(it);
+		}
+	}
+
+	void Scene::updateAggregatedBody(entt::entity entity, std::unordered_set<entt::entity>& touchedRoots) {
+		auto it = m_aggregatedBodies.find(entity);
+		const entt::entity currentRoot = it != m_aggregatedBodies.end() ? it->second : entt::null;
+
+		comp::RigidBody* rb = m_reg.valid(entity) ? m_reg.try_get<comp::RigidBody>(entity) : nullptr;
+		physx::PxRigidActor* pActor = rb ? rb->m_pActor : nullptr;
+		bool selfCollision = false;
+		const entt::entity root = pActor ? findAggregateRoot(Entity(this, entity), &selfCollision) : entt::null;
+		physx::PxAggregate* pCurrentAggregate = pActor ? pActor->getAggregate() : nullptr;
+		// Bodies that stay in their group are not touched, moving an actor ends and begins all of its touches
+		if (root == currentRoot && (pCurrentAggregate != nullptr) == (root != entt::null))
+			return;
+
+		if (currentRoot != entt::null)
+			touchedRoots.insert(currentRoot);
+		// Leaving the aggregate puts the actor back into the scene
+		if (pCurrentAggregate)
+			pCurrentAggregate->removeActor(*pActor);
+		if (root == entt::null) {
+			if (it != m_aggregatedBodies.end())
+				m_aggregatedBodies.erase(it);
+			return;
+		}
+		m_aggregatedBodies[entity] = root;
+
+		PhysicsAggregateGroup& group = m_physicsAggregateGroups[root];
+		if (group.aggregates.empty())
+			group.selfCollision = selfCollision;
+		physx::PxAggregate* pAggregate = nullptr;
+		for (physx::PxAggregate* pGroupAggregate : group.aggregates) {
+			if (pGroupAggregate->getNbActors() < pGroupAggregate->getMaxNbActors()) {
+				pAggregate = pGroupAggregate;
+				break;
+			}
+		}
+		if (!pAggregate) {
+			pAggregate = PhysicsSystem::get().createAggregate(PHYSICS_MAX_AGGREGATE_SIZE, group.selfCollision);
+			m_pPhysicsScene->addAggregate(*pAggregate);
+			group.aggregates.push_back(pAggregate);
+		}
+		// Actors have to leave the scene before they can join an aggregate
+		m_pPhysicsScene->removeActor(*pActor, false);
+		pAggregate->addActor(*pActor);
+	}
+
+	entt::entity Scene::findAggregateRoot(const Entity& entity, bool* pSelfCollision) const {
+		Entity root;
+		Entity hierarchyRoot = entity;
+		for (Entity current = entity; !current.isNull(); current = m_hierarchy.hasParent(current) ? m_hierarchy.getParent(current) : Entity()) {
+			// Walking up, so a group nested in another one ends up in the outer group
+			if (const comp::PhysicsAggregate* pAggregate = m_reg.try_get<comp::PhysicsAggregate>(current)) {
+				root = current;
+				*pSelfCollision = pAggregate->selfCollision;
+			}
+			hierarchyRoot = current;
+		}
+		if (root.isNull() && m_physicsSettings.aggregateHierarchies && m_hierarchy.hasChildren(hierarchyRoot)) {
+			root = hierarchyRoot;
+			*pSelfCollision = m_physicsSettings.aggregateSelfCollision;
+		}
+		if (root.isNull())
+			return entt::null;
+		return root;
+	}
+
+	Entity Scene::findHierarchyRoot(const Entity& entity) const {
+		Entity root = entity;
+		while (m_hierarchy.hasParent(root)) {
+			root = m_hierarchy.getParent(root);
+		}
+		return root;
+	}
+
+	void Scene::invalidatePhysicsBody(entt::entity entity) {
+		m_dirtyAggregateBodies.push_back(entity);
+	}
+
+	void Scene::invalidatePhysicsAggregates() {
+		m_physicsAggregatesDirty = true;
+	}
+
+	void Scene::invalidatePhysicsAggregate(const Entity& entity) {
+		m_dirtyAggregateRoots.insert(findHierarchyRoot(entity));
+	}
+
+	const PhysicsStatistics& Scene::getPhysicsStatistics() const {
+		return m_physicsStatistics;
+	}
+
+	void Scene::capturePhysicsState(ByteStream& dataOutStream) {
+		SA_PROFILE_FUNCTION();
+		waitForPhysicsStep();
+
+		auto& rigidBodies = m_reg.storage<comp::RigidBody>();
+		std::vector<PhysicsBodyState> states;
+		states.reserve(rigidBodies.size());
+		for (auto [e, rb] : rigidBodies.each()) {
+			if (!rb.m_pActor)
+				continue;
+			PhysicsBodyState& state = states.emplace_back();
+			state.entity = e;
+			state.flags = 0;
+			state.pose = rb.m_pActor->getGlobalPose();
+			state.previousPose = rb.m_previousPose;
+			state.kinematicTarget = state.pose;
+			state.linearVelocity = physx::PxVec3(0.0f);
+			state.angularVelocity = physx::PxVec3(0.0f);
+			state.wakeCounter = 0.0f;
+
+			physx::PxRigidDynamic* pDynamic = rb.m_pActor->is<physx::PxRigidDynamic>();
+			if (!pDynamic)
+				continue;
+			state.flags |= BODY_DYNAMIC;
+			if (pDynamic->getRigidBodyFlags() & physx::PxRigidBodyFlag::eKINEMATIC) {
+				state.flags |= BODY_KINEMATIC;
+				if (pDynamic->getKinematicTarget(state.kinematicTarget))
+					state.flags |= BODY_HAS_KINEMATIC_TARGET;
+				continue;
+			}
+			if (pDynamic->isSleeping())
+				state.flags |= BODY_SLEEPING;
+			state.linearVelocity = pDynamic->getLinearVelocity();
+			state.angularVelocity = pDynamic->getAngularVelocity();
+			state.wakeCounter = pDynamic->getWakeCounter();
+		}
+
+		PhysicsSnapshotHeader header = {};
+		header.magic = PHYSICS_SNAPSHOT_MAGIC;
+		header.version = PHYSICS_SNAPSHOT_VERSION;
+		header.bodyCount = static_cast<uint32_t>(states.size());
+		header.accumulator = m_physicsAccumulator;
+		dataOutStream.write(header);
+		dataOutStream.write(reinterpret_cast<const byte_t*>(states.data()), states.size() * sizeof(PhysicsBodyState));
+	}
+
+	void Scene::restorePhysicsState(ByteStream& dataInStream) {
+		SA_PROFILE_FUNCTION();
+		PhysicsSnapshotHeader header;
+		if (dataInStream.size() - dataInStream.tellg() < sizeof(header)) {
+			throw std::runtime_error("Physics snapshot is of an unknown format");
+		}
+		dataInStream.read(&header);
+		// The count is checked against what is left, a truncated or corrupt snapshot can not size the read
+		const size_t remainingSize = dataInStream.size() - dataInStream.tellg();
+		if (header.magic != PHYSICS_SNAPSHOT_MAGIC || header.version != PHYSICS_SNAPSHOT_VERSION || header.bodyCount > remainingSize / sizeof(PhysicsBodyState)) {
+			throw std::runtime_error("Physics snapshot is of an unknown format");
+		}
+		std::vector<PhysicsBodyState> states(header.bodyCount);
+		dataInStream.read(reinterpret_cast<byte_t*>(states.data()), states.size() * sizeof(PhysicsBodyState));
+
+		// Whatever the running step produced is replaced, so nothing of it may be written or sent afterwards
+		waitForPhysicsStep();
+		m_bodiesToWrite.clear();
+		m_bodiesMovedInLastStep.clear();
+		m_posesMovedInLastStep.clear();
+		m_physicsEvents.clear();
+		m_physicsAccumulator = header.accumulator;
+
+		auto& rigidBodies = m_reg.storage<comp::RigidBody>();
+		auto& transforms = m_reg.storage<comp::Transform>();
+		for (const PhysicsBodyState& state : states) {
+			if (!rigidBodies.contains(state.entity))
+				continue;
+			comp::RigidBody& rb = rigidBodies.get(state.entity);
+			if (!rb.m_pActor)
+				continue;
+
+			rb.m_pActor->setGlobalPose(state.pose, false);
+			physx::PxRigidDynamic* pDynamic = rb.m_pActor->is<physx::PxRigidDynamic>();
+			// A body made static or kinematic since the capture only gets its pose back
+			if (pDynamic && (state.flags & BODY_DYNAMIC)) {
+				const bool isKinematic = pDynamic->getRigidBodyFlags() & physx::PxRigidBodyFlag::eKINEMATIC;
+				if (isKinematic && (state.flags & BODY_HAS_KINEMATIC_TARGET)) {
+					pDynamic->setKinematicTarget(state.kinematicTarget);
+				}
+				else if (!isKinematic && !(state.flags & BODY_KINEMATIC)) {
+					if (state.flags & BODY_SLEEPING) {
+						pDynamic->putToSleep();
+					}
+					else {
+						pDynamic->setLinearVelocity(state.linearVelocity, false);
+						pDynamic->setAngularVelocity(state.angularVelocity, false);
+						pDynamic->setWakeCounter(state.wakeCounter);
+					}
+				}
+			}
+
+			rb.m_previousPose = state.previousPose;
+			rb.m_currentPose = state.pose;
+			rb.m_writtenPose = state.pose;
+			// The pose is written below, a step count from before the restore must not interpolate it again
+			rb.m_lastMovedStep = 0;
+			if (transforms.contains(state.entity)) {
+				comp::Transform& transform = transforms.get(state.entity);
+				transform = state.pose;
+				rb.m_writtenPose = transform;
+			}
+		}
+	}
+
+	void Scene::syncPhysics() {
+		SA_PROFILE_FUNCTION();
+		if (m_isPhysicsSimulating) {
+			fetchPhysicsStep();
+			m_isPhysicsSimulating = false;
+		}
+
+		// Transforms written while the step was running are applied now that the scene can be written to
+		pushEditedTransforms();
+
+		const float alpha = m_physicsSettings.interpolate ? m_physicsAccumulator / m_physicsSettings.fixedTimeStep : 1.0f;
+		interpolateBodies(m_bodiesToWrite, alpha);
+		// Bodies moved by the last step are interpolated again next sync, the ones that stopped end up at their last pose
+		m_bodiesToWrite = m_bodiesMovedInLastStep;
+
+		dispatchPhysicsEvents();
+	}
+
+	void Scene::dispatchPhysicsEvents() {
+		SA_PROFILE_FUNCTION();
+		// Entities destroyed since the step are replaced with null, so the other side still gets its end event.
+		// Records with no valid side left are dropped
+		auto validOrNull = [&](entt::entity& entity) {
+			if (!m_reg.valid(entity))
+				entity = entt::null;
+			return entity != entt::null;
+		};
+		std::vector<ContactRecord>& contacts = m_physicsEvents.getContacts();
+		std::erase_if(contacts, [&](ContactRecord& contact) {
+			const bool isValid0 = validOrNull(contact.entity0);
+			const bool isValid1 = validOrNull(contact.entity1);
+			return !isValid0 && !isValid1;
+		});
+		std::vector<TriggerRecord>& triggers = m_physicsEvents.getTriggers();
+		std::erase_if(triggers, [&](TriggerRecord& record) {
+			const bool isTriggerValid = validOrNull(record.trigger);
+			const bool isOtherValid = validOrNull(record.other);
+			return !isTriggerValid && !isOtherValid;
+		});
+
+		if (!contacts.empty())
+			trigger<scene_event::Contacts>(scene_event::Contacts{ this, contacts });
+		if (!triggers.empty())
+			trigger<scene_event::Triggers>(scene_event::Triggers{ this, triggers });
+		m_physicsEvents.clear();
+	}
+
+	void Scene::waitForPhysicsStep() {
+		if (m_isPhysicsSimulating) {
+			fetchPhysicsStep();
+			m_isPhysicsSimulating = false;
+		}
+	}
+
+	void Scene::interpolateBodies(const std::vector<entt::entity>& bodies, float alpha) {
+		auto& rigidBodies = m_reg.storage<comp::RigidBody>();
+		auto& transforms = m_reg.storage<comp::Transform>();
+		for (entt::entity e : bodies) {
+			// The entity may have been destroyed since the step that moved it
+			if (!rigidBodies.contains(e) || !transforms.contains(e))
+				continue;
+			comp::RigidBody* rb = &rigidBodies.get(e);
+			comp::Transform* transform = &transforms.get(e);
+
+			// Kinematic bodies follow their transform, bodies that did not move in the last step are at rest
+			if (rb->m_lastMovedStep != m_physicsStepCount || rb->isKinematic()) {
+				*transform = rb->m_currentPose;
+			}
+			else {
+				const comp::Transform previous = rb->m_previousPose;
+				const comp::Transform current = rb->m_currentPose;
+				transform->position = glm::mix((glm::vec3)previous.position, (glm::vec3)current.position, alpha);
+				transform->rotation = glm::slerp(previous.rotation, current.rotation, alpha);
+			}
+			rb->m_writtenPose = *transform;
+		}
 	}
 
 	void Scene::updateChildPositions() {
@@ -71,14 +536,24 @@ namespace sa {
 	Scene::Scene(const AssetHeader& header, bool isCompiled)
 		: Asset(header, isCompiled)
 		, m_scriptManager(*this)
-		, m_dynamicSceneCollection(sa::SceneCollection::CollectionMode::CONTINUOUS)
 		, m_runtime(false)
 		, m_pPhysicsScene(PhysicsSystem::get().createScene())
+		, m_physicsAccumulator(0.0f)
+		, m_physicsStepCount(0)
+		, m_physicsSimulateTime(0.0f)
+		, m_isPhysicsSimulating(false)
+		, m_physicsAggregatesDirty(true)
 	{
+		// Lets components reach the scene from their actors
+		m_pPhysicsScene->userData = this;
+		m_pPhysicsScene->setSimulationEventCallback(&m_physicsEvents);
 		registerComponentCallBacks();
 	}
 
 	Scene::~Scene() {
+		if (m_isPhysicsSimulating)
+			m_pPhysicsScene->fetchResults(true);
+		releasePhysicsAggregates();
 		if(m_pPhysicsScene)
 			m_pPhysicsScene->release();
 	}
@@ -130,6 +605,15 @@ namespace sa {
 	}
 
 	bool Scene::onUnload() {
+		if (m_isPhysicsSimulating) {
+			m_pPhysicsScene->fetchResults(true);
+			m_isPhysicsSimulating = false;
+		}
+		releasePhysicsAggregates();
+		m_physicsAggregatesDirty = true;
+		m_bodiesToWrite.clear();
+		m_bodiesMovedInLastStep.clear();
+		m_posesMovedInLastStep.clear();
 		m_reg.clear();
 		decltype(m_reg) reg;
 		m_reg.swap(reg);
@@ -141,20 +625,25 @@ namespace sa {
 
 	void Scene::onRuntimeStart() {
 		m_runtime = true;
+		m_physicsAccumulator = 0.0f;
 		m_scriptManager.applyChanges();
 		trigger<scene_event::SceneStart>();
 	}
 
 	void Scene::onRuntimeStop()	{
-		if(m_runtime) 
+		if (m_runtime) {
+			syncPhysics();
 			trigger<scene_event::SceneStop>();
+		}
 		m_runtime = false;
 	}
 
 	void Scene::runtimeUpdate(float dt) {
 		SA_PROFILE_FUNCTION();
 
-		updatePhysics(dt);
+		// The step started last frame is fetched here, the next one runs alongside scripts and rendering
+		syncPhysics();
+		beginPhysicsStep(dt);
 
 		m_scriptManager.applyChanges();
 		// Scripts
@@ -177,14 +666,15 @@ namespace sa {
 	}
 
 	void Scene::render(RenderContext& context, RenderPipeline& renderPipeline, RenderTarget& mainRenderTarget) {
-		m_dynamicSceneCollection.clear();
-		m_dynamicSceneCollection.collect(this);
-		m_dynamicSceneCollection.makeRenderReady();
-		renderPipeline.preRender(context, m_dynamicSceneCollection);
+		SceneCollection& dynamicSceneCollection = getDynamicSceneCollection();
+		dynamicSceneCollection.clear();
+		dynamicSceneCollection.collect(this);
+		dynamicSceneCollection.makeRenderReady();
+		renderPipeline.preRender(context, dynamicSceneCollection);
 
 		bool renderedToMainRenderTarget = false;
 		forEach<comp::Camera>([&](comp::Camera& camera) {
-			m_dynamicSceneCollection.makeRenderReady(camera.sceneCollection, nullptr);
+			dynamicSceneCollection.makeRenderReady(camera.sceneCollection, nullptr);
 			RenderTarget* pRenderTarget = camera.getRenderTarget().getAsset();
 			if (pRenderTarget) {
 				renderPipeline.render(context, &camera.camera, pRenderTarget, camera.sceneCollection);
@@ -324,8 +814,38 @@ namespace sa {
 		return m_hierarchy;
 	}
 
+	const PhysicsSettings& Scene::getPhysicsSettings() const {
+		return m_physicsSettings;
+	}
+
+	void Scene::executeQueries(PhysicsQueryBatch& batch, bool parallel) const {
+		batch.execute(m_pPhysicsScene, parallel);
+	}
+
+	bool Scene::raycast(const Vector3& origin, const Vector3& direction, float maxDistance, QueryHit* pHit, const QueryFilter& filter) const {
+		PhysicsQueryBatch batch;
+		batch.addRaycast({ origin, direction, maxDistance, 1U, filter });
+		batch.execute(m_pPhysicsScene);
+
+		const QueryResult& result = batch.getRaycastResults()[0];
+		if (result.hitCount == 0)
+			return false;
+		if (pHit)
+			*pHit = batch.getHits(result)[0];
+		return true;
+	}
+
+	void Scene::setPhysicsSettings(const PhysicsSettings& settings) {
+		m_physicsSettings = settings;
+		m_physicsAggregatesDirty = true;
+		m_physicsSettings.fixedTimeStep = std::max(m_physicsSettings.fixedTimeStep, 0.0001f);
+		m_physicsSettings.maxSubSteps = std::max(m_physicsSettings.maxSubSteps, 1U);
+	}
+
 	SceneCollection& Scene::getDynamicSceneCollection() {
-		return m_dynamicSceneCollection;
+		if (!m_pDynamicSceneCollection)
+			m_pDynamicSceneCollection = std::make_unique<SceneCollection>(SceneCollection::CollectionMode::CONTINUOUS);
+		return *m_pDynamicSceneCollection;
 	}
 
 	void Scene::forEachComponentType(std::function<void(ComponentType)> function) {
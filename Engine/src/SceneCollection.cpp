@@ -3,6 +3,8 @@
 
 #include "Scene.h"
 
+#include <numeric>
+
 namespace sa {
 	MaterialShaderCollection::MaterialShaderCollection(MaterialShader* pMaterialShader) {
 		m_materialShaderID = pMaterialShader->getID();
@@ -21,6 +23,11 @@ namespace sa {
 		m_materialBuffer.create(BufferType::STORAGE);
 		m_materialIndicesBuffer.create(BufferType::STORAGE);
 
+		m_instanceIndexBuffer.create(BufferType::STORAGE);
+		m_cullDataBuffer.create(BufferType::STORAGE);
+		m_culledDrawCommandBuffer.create(BufferType::INDIRECT);
+		m_visibilityBuffer.create(BufferType::STORAGE);
+
 		m_currentExtent = { 0, 0 };
 
 		m_updatedDescriptorSets = false;
@@ -71,6 +78,7 @@ namespace sa {
 		m_objectCount--;
 		if(m_objects[modelIndex].empty()) { // if erased every object using this model
 			m_models.erase(modelIt); // remove model
+			m_boundingSpheres.erase(pModelAsset);
 			for(const auto& index : m_meshes[modelIndex]) {
 				const Mesh& mesh = pModelAsset->data.meshes[index];
 				m_vertexCount -= mesh.vertices.size();
@@ -86,8 +94,9 @@ namespace sa {
 	void MaterialShaderCollection::clear() {
 		m_models.clear();
 		m_meshes.clear();  // frees memory
-		m_objects.clear(); // frees memory
-		m_textures.clear();
+		for (auto& objects : m_objects) {
+			objects.clear(); // keeps capacity, reused by addMesh
+		}
 		m_materials.clear();
 		m_materialData.clear();
 		m_materialIndices.clear();
@@ -98,12 +107,10 @@ namespace sa {
 		m_uniqueMeshCount = 0;
 
 		// Clear Dynamic buffers
+		// Geometry, draw commands and materials are kept, makeRenderReady rewrites them only if they changed
 		m_objectBuffer.clear();
-		m_indirectIndexedBuffer.clear();
-		m_vertexBuffer.clear();
-		m_indexBuffer.clear();
-		m_materialBuffer.clear();
-		m_materialIndicesBuffer.clear();
+		m_cullDataBuffer.clear();
+		m_culledDrawCommandBuffer.clear();
 	}
 
 	void MaterialShaderCollection::swap() {
@@ -113,45 +120,92 @@ namespace sa {
 		m_objectBuffer.swap();
 		m_materialBuffer.swap();
 		m_materialIndicesBuffer.swap();
+		m_instanceIndexBuffer.swap();
+		m_cullDataBuffer.swap();
+		m_culledDrawCommandBuffer.swap();
+		m_visibilityBuffer.swap();
 		m_updatedDescriptorSets = false;
 	}
 
+	const glm::vec4& MaterialShaderCollection::getBoundingSphere(const ModelAsset* pModelAsset) {
+		BoundingSphere& boundingSphere = m_boundingSpheres[pModelAsset];
+		const uint64_t revision = pModelAsset->getDataRevision();
+		if (boundingSphere.modelRevision == revision)
+			return boundingSphere.sphere;
+		boundingSphere.modelRevision = revision;
+
+		// Sphere around the bounding box of every mesh, not minimal but cheap
+		glm::vec3 min(FLT_MAX);
+		glm::vec3 max(-FLT_MAX);
+		for (const auto& mesh : pModelAsset->data.meshes) {
+			for (const auto& vertex : mesh.vertices) {
+				min = glm::min(min, glm::vec3(vertex.position));
+				max = glm::max(max, glm::vec3(vertex.position));
+			}
+		}
+		if (min.x > max.x) {
+			return boundingSphere.sphere = glm::vec4(0.0f);
+		}
+
+		glm::vec3 center = (min + max) * 0.5f;
+		float radius = 0.0f;
+		for (const auto& mesh : pModelAsset->data.meshes) {
+			for (const auto& vertex : mesh.vertices) {
+				radius = std::max(radius, glm::distance(center, glm::vec3(vertex.position)));
+			}
+		}
+		return boundingSphere.sphere = glm::vec4(center, radius);
+	}
+
 	void MaterialShaderCollection::makeRenderReady() {
 		makeRenderReady(*this, nullptr);
 	}
 
 	void MaterialShaderCollection::makeRenderReady(MaterialShaderCollection& subset, glm::vec3* pViewFrustumPoints) {
-		
-		// reserve dynamic buffers
-		subset.m_objectBuffer.reserve(m_objectCount * sizeof(ObjectData), IGNORE_CONTENT);
-		subset.m_indirectIndexedBuffer.reserve(m_uniqueMeshCount * sizeof(DrawIndexedIndirectCommand), IGNORE_CONTENT);
-		subset.m_vertexBuffer.reserve(m_vertexCount * sizeof(VertexNormalUV), IGNORE_CONTENT);
-		subset.m_indexBuffer.reserve(m_indexCount * sizeof(uint32_t), IGNORE_CONTENT);
-		subset.m_materialBuffer.reserve(m_uniqueMeshCount * sizeof(Material::Values), IGNORE_CONTENT);
-		subset.m_materialIndicesBuffer.reserve(m_uniqueMeshCount * sizeof(int32_t), IGNORE_CONTENT);
-
+		SA_PROFILE_FUNCTION();
 
+		// Group objects by model, each mesh of the model is drawn once with an instance per object
+		m_drawGroups.clear();
 		uint32_t firstInstance = 0;
-
-		int32_t materialCount = 0;
-		uint32_t meshCount = 0;
-
 		for (size_t i = 0; i < m_models.size(); i++) {
-			ModelAsset* pModelAsset = m_models.at(i);
+			const ModelAsset* pModelAsset = m_models[i];
 			if (!pModelAsset->isLoaded())
 				continue;
-			for (const auto& entity : m_objects[i]) {
-				// TODO decouple from scene
-				auto pTransform = entity.getComponent<comp::Transform>();
-				if (!pTransform) {
-					subset.m_objectBuffer << glm::mat4(1);
+			uint32_t instanceCount = m_objects[i].size();
+			for (const auto& meshIndex : m_meshes[i]) {
+				// A reactive collection may still hold meshes of the data before a reload
+				if (meshIndex >= pModelAsset->data.meshes.size())
 					continue;
-				}
-				subset.m_objectBuffer << pTransform->getMatrix();
+				m_drawGroups.push_back({ pModelAsset, pModelAsset->getDataRevision(), meshIndex, firstInstance, instanceCount });
 			}
-			ModelData* pModel = &m_models[i]->data;
-			for (const auto& meshIndex : m_meshes[i]) {
-				const Mesh& mesh = pModel->meshes[meshIndex];
+			firstInstance += instanceCount;
+		}
+		subset.m_instanceCount = firstInstance;
+
+		// Geometry only has to be rebuilt when the membership of the groups changed since this buffer was last written
+		if (subset.m_builtDrawGroups.size() != subset.m_indirectIndexedBuffer.getBufferCount())
+			subset.m_builtDrawGroups.resize(subset.m_indirectIndexedBuffer.getBufferCount());
+		std::vector<DrawGroup>& builtDrawGroups = subset.m_builtDrawGroups[subset.m_indirectIndexedBuffer.getBufferIndex()];
+		
+		if (builtDrawGroups != m_drawGroups) {
+			SA_PROFILE_SCOPE("Rebuild draw groups");
+			subset.m_indirectIndexedBuffer.clear();
+			subset.m_vertexBuffer.clear();
+			subset.m_indexBuffer.clear();
+			subset.m_indirectIndexedBuffer.reserve(m_drawGroups.size() * sizeof(DrawIndexedIndirectCommand), IGNORE_CONTENT);
+			// Counted from the groups, the counts kept by addMesh are stale once a model is reloaded in place
+			size_t vertexCount = 0;
+			size_t indexCount = 0;
+			for (const auto& group : m_drawGroups) {
+				const Mesh& mesh = group.pModelAsset->data.meshes[group.meshIndex];
+				vertexCount += mesh.vertices.size();
+				indexCount += mesh.indices.size();
+			}
+			subset.m_vertexBuffer.reserve(vertexCount * sizeof(VertexNormalUV), IGNORE_CONTENT);
+			subset.m_indexBuffer.reserve(indexCount * sizeof(uint32_t), IGNORE_CONTENT);
+
+			for (const auto& group : m_drawGroups) {
+				const Mesh& mesh = group.pModelAsset->data.meshes[group.meshIndex];
 				uint32_t vertexOffset = subset.m_vertexBuffer.getElementCount<VertexNormalUV>();
 				// Push mesh into buffers
 				subset.m_vertexBuffer << mesh.vertices;
@@ -162,46 +216,110 @@ namespace sa {
 				DrawIndexedIndirectCommand cmd = {};
 				cmd.firstIndex = firstIndex;
 				cmd.indexCount = mesh.indices.size();
-				cmd.firstInstance = firstInstance;
-				cmd.instanceCount = m_objects[i].size();
+				cmd.firstInstance = group.firstInstance;
+				cmd.instanceCount = group.instanceCount;
 				cmd.vertexOffset = vertexOffset;
 				subset.m_indirectIndexedBuffer << cmd;
+			}
+
+			// Instances map directly to objects when drawn without culling, the remaining lists are written by the culling passes
+			std::vector<uint32_t> instanceIndices(subset.m_instanceCount);
+			std::iota(instanceIndices.begin(), instanceIndices.end(), 0U);
+			subset.m_instanceIndexBuffer.clear();
+			subset.m_instanceIndexBuffer.reserve(subset.m_instanceCount * INSTANCE_LIST_COUNT * sizeof(uint32_t), IGNORE_CONTENT);
+			subset.m_instanceIndexBuffer.write(instanceIndices);
 
-				//Material
-				sa::Material* pMaterial = mesh.material.getAsset();
-				if (pMaterial) {
-					auto it = std::find(subset.m_materials.begin(), subset.m_materials.end(), pMaterial);
-					if (it == subset.m_materials.end()) {
-						uint32_t textureOffset = subset.m_textures.size();
-						const std::vector<Texture>& matTextures = pMaterial->fetchTextures();
-						subset.m_textures.insert(subset.m_textures.end(), matTextures.begin(), matTextures.end());
-
-						Material::Values values = pMaterial->values;
-						values.albedoMapFirst += textureOffset;
-						values.normalMapFirst += textureOffset;
-						values.metalnessMapFirst += textureOffset;
-						values.roughnessMapFirst += textureOffset;
-						values.emissiveMapFirst += textureOffset;
-						values.occlusionMapFirst += textureOffset;
-
-						subset.m_materials.push_back(pMaterial);
-						subset.m_materialData.push_back(values);
-						subset.m_materialIndices.push_back(materialCount);
-						materialCount++;
-					}
-					else {
-						subset.m_materialIndices.push_back(std::distance(subset.m_materials.begin(), it));
-					}
+			builtDrawGroups = m_drawGroups;
+		}
+
+		// Culled draw commands start empty every frame, the culling passes count the visible instances
+		const size_t drawCommandCount = subset.m_indirectIndexedBuffer.getElementCount<DrawIndexedIndirectCommand>();
+		subset.m_culledDrawCommandBuffer.clear();
+		subset.m_culledDrawCommandBuffer.reserve((INSTANCE_LIST_COUNT - 1) * drawCommandCount * sizeof(DrawIndexedIndirectCommand), IGNORE_CONTENT);
+		for (uint32_t list = 1; list < INSTANCE_LIST_COUNT; list++) {
+			for (size_t i = 0; i < drawCommandCount; i++) {
+				DrawIndexedIndirectCommand cmd = subset.m_indirectIndexedBuffer.at<DrawIndexedIndirectCommand>(i);
+				cmd.firstInstance += list * subset.m_instanceCount;
+				cmd.instanceCount = 0;
+				subset.m_culledDrawCommandBuffer << cmd;
+			}
+		}
+		// Flags of objects added this frame are garbage, which at worst draws them in the first phase
+		subset.m_visibilityBuffer.reserve(subset.m_instanceCount * sizeof(uint32_t));
+
+		// Object transforms and bounds are written every frame, in the same order as the instances
+		subset.m_objectBuffer.clear();
+		subset.m_objectBuffer.reserve(m_objectCount * sizeof(ObjectData), IGNORE_CONTENT);
+		subset.m_cullDataBuffer.clear();
+		subset.m_cullDataBuffer.reserve(m_objectCount * sizeof(ObjectCullData), IGNORE_CONTENT);
+		uint32_t firstCommand = 0;
+		for (size_t i = 0; i < m_models.size(); i++) {
+			if (!m_models[i]->isLoaded())
+				continue;
+			const glm::vec4& boundingSphere = getBoundingSphere(m_models[i]);
+			const uint32_t commandCount = m_meshes[i].size();
+			for (const auto& entity : m_objects[i]) {
+				// TODO decouple from scene
+				auto pTransform = entity.getComponent<comp::Transform>();
+				glm::mat4 worldMat = pTransform ? pTransform->getMatrix() : glm::mat4(1);
+				subset.m_objectBuffer << worldMat;
+
+				float scale = std::max({ glm::length(glm::vec3(worldMat[0])), glm::length(glm::vec3(worldMat[1])), glm::length(glm::vec3(worldMat[2])) });
+				ObjectCullData cullData = {};
+				cullData.boundingSphere = glm::vec4(glm::vec3(worldMat * glm::vec4(glm::vec3(boundingSphere), 1.0f)), boundingSphere.w * scale);
+				cullData.firstCommand = firstCommand;
+				cullData.commandCount = commandCount;
+				subset.m_cullDataBuffer << cullData;
+			}
+			firstCommand += commandCount;
+		}
+
+		// Materials may be edited at any time, so their values are gathered every frame but only uploaded when
+		// a material or one of its texture slots changed since this buffer was last written
+		subset.m_materials.clear();
+		subset.m_materialData.clear();
+		subset.m_materialIndices.clear();
+		subset.m_triangleCount = 0;
+		int32_t materialCount = 0;
+		for (const auto& group : m_drawGroups) {
+			const Mesh& mesh = group.pModelAsset->data.meshes[group.meshIndex];
+			subset.m_triangleCount += (mesh.indices.size() / 3) * group.instanceCount;
+
+			sa::Material* pMaterial = mesh.material.getAsset();
+			if (pMaterial) {
+				auto it = std::find(subset.m_materials.begin(), subset.m_materials.end(), pMaterial);
+				if (it == subset.m_materials.end()) {
+					subset.m_materialData.push_back(pMaterial->getShaderValues());
+					subset.m_materials.push_back(pMaterial);
+					subset.m_materialIndices.push_back(materialCount);
+					materialCount++;
 				}
 				else {
-					subset.m_materialIndices.push_back(-1); // Default Material in shader
+					subset.m_materialIndices.push_back(std::distance(subset.m_materials.begin(), it));
 				}
-				meshCount++;
 			}
-			firstInstance += m_objects[i].size();
+			else {
+				subset.m_materialIndices.push_back(-1); // Default Material in shader
+			}
+		}
+		if (subset.m_writtenMaterialData.size() != subset.m_materialBuffer.getBufferCount())
+			subset.m_writtenMaterialData.resize(subset.m_materialBuffer.getBufferCount());
+		if (subset.m_writtenMaterialIndices.size() != subset.m_materialIndicesBuffer.getBufferCount())
+			subset.m_writtenMaterialIndices.resize(subset.m_materialIndicesBuffer.getBufferCount());
+
+		std::vector<Material::Values>& writtenMaterialData = subset.m_writtenMaterialData[subset.m_materialBuffer.getBufferIndex()];
+		if (writtenMaterialData != subset.m_materialData) {
+			subset.m_materialBuffer.clear();
+			subset.m_materialBuffer.write(subset.m_materialData);
+			writtenMaterialData = subset.m_materialData;
+		}
+
+		std::vector<uint32_t>& writtenMaterialIndices = subset.m_writtenMaterialIndices[subset.m_materialIndicesBuffer.getBufferIndex()];
+		if (writtenMaterialIndices != subset.m_materialIndices) {
+			subset.m_materialIndicesBuffer.clear();
+			subset.m_materialIndicesBuffer.write(subset.m_materialIndices);
+			writtenMaterialIndices = subset.m_materialIndices;
 		}
-		subset.m_materialBuffer.write(subset.m_materialData);
-		subset.m_materialIndicesBuffer.write(subset.m_materialIndices);
 	}
 
 	bool MaterialShaderCollection::readyDescriptorSets(RenderContext& context) {
@@ -209,31 +327,33 @@ namespace sa {
 		if (!pMaterialShader || !pMaterialShader->isLoaded())
 			return false;
 
-		if (m_sceneDescriptorSetColorPass == NULL_RESOURCE || !pMaterialShader->getColorPipelineLayout().hasAllocatedDescriptorSet(m_sceneDescriptorSetColorPass)) {
-			m_sceneDescriptorSetColorPass = pMaterialShader->getColorPipelineLayout().allocateDescriptorSet(SET_PER_FRAME);
-			SA_DEBUG_LOG_INFO("Scene descriptor set allocated for color pass, MaterialShader UUID: ", pMaterialShader->getID());
-		}
-
 		if (m_sceneDescriptorSetDepthPass == NULL_RESOURCE || !pMaterialShader->getDepthPipelineLayout().hasAllocatedDescriptorSet(m_sceneDescriptorSetDepthPass)) {
 			m_sceneDescriptorSetDepthPass = pMaterialShader->getDepthPipelineLayout().allocateDescriptorSet(SET_PER_FRAME);
 			SA_DEBUG_LOG_INFO("Scene descriptor set allocated for depth pass, MaterialShader UUID: ", pMaterialShader->getID());
 		}
 
 		if (!m_updatedDescriptorSets) {
-			context.updateDescriptorSet(getSceneDescriptorSetColorPass(), 0, getObjectBuffer());
-		
-			context.updateDescriptorSet(getSceneDescriptorSetColorPass(), 2, getMaterialBuffer());
-			context.updateDescriptorSet(getSceneDescriptorSetColorPass(), 3, getMaterialIndicesBuffer());
-		
-			context.updateDescriptorSet(getSceneDescriptorSetColorPass(), 32, getTextures(), 0);
-
 			context.updateDescriptorSet(getSceneDescriptorSetDepthPass(), 0, getObjectBuffer());
+			context.updateDescriptorSet(getSceneDescriptorSetDepthPass(), 11, getInstanceIndexBuffer());
 			m_updatedDescriptorSets = true;
 		}
 
 		return true;
 	}
 
+	ResourceID MaterialShaderCollection::allocateSceneDescriptorSetColorPass(RenderContext& context) const {
+		// A fresh set per pass, so the lights and shadows of one render target never overwrite a set another one recorded
+		const ResourceID descriptorSet = getMaterialShader()->getColorPipelineLayout().allocateTransientDescriptorSet(SET_PER_FRAME);
+
+		context.updateDescriptorSet(descriptorSet, 0, getObjectBuffer());
+
+		context.updateDescriptorSet(descriptorSet, 2, getMaterialBuffer());
+		context.updateDescriptorSet(descriptorSet, 3, getMaterialIndicesBuffer());
+
+		context.updateDescriptorSet(descriptorSet, 11, getInstanceIndexBuffer());
+		return descriptorSet;
+	}
+
 	void MaterialShaderCollection::recreatePipelines(ResourceID colorRenderProgram, ResourceID depthRenderProgram, Extent extent) {
 		const auto pMaterialShader = getMaterialShader();
 		if (!pMaterialShader)
@@ -293,12 +413,39 @@ namespace sa {
 		return m_materialIndicesBuffer.getBuffer();
 	}
 
-	const std::vector<Texture>& MaterialShaderCollection::getTextures() const {
-		return m_textures;
+	size_t MaterialShaderCollection::getTriangleCount() const {
+		return m_triangleCount;
+	}
+
+	uint32_t MaterialShaderCollection::getInstanceCount() const {
+		return m_instanceCount;
+	}
+
+	const Buffer& MaterialShaderCollection::getInstanceIndexBuffer() const {
+		return m_instanceIndexBuffer.getBuffer();
+	}
+
+	const Buffer& MaterialShaderCollection::getCullDataBuffer() const {
+		return m_cullDataBuffer.getBuffer();
+	}
+
+	const Buffer& MaterialShaderCollection::getCulledDrawCommandBuffer() const {
+		return m_culledDrawCommandBuffer.getBuffer();
+	}
+
+	uint32_t MaterialShaderCollection::getCulledDrawCommandOffset(InstanceList list) const {
+		if (list == InstanceList::ALL)
+			throw std::runtime_error("InstanceList::ALL is drawn with the draw command buffer");
+		const size_t drawCommandCount = m_indirectIndexedBuffer.getElementCount<DrawIndexedIndirectCommand>();
+		return static_cast<uint32_t>(((uint32_t)list - 1) * drawCommandCount * sizeof(DrawIndexedIndirectCommand));
 	}
 
-	ResourceID MaterialShaderCollection::getSceneDescriptorSetColorPass() const {
-		return m_sceneDescriptorSetColorPass;
+	const Buffer& MaterialShaderCollection::getVisibilityBuffer() const {
+		return m_visibilityBuffer.getBuffer();
+	}
+
+	const Buffer& MaterialShaderCollection::getPreviousVisibilityBuffer() {
+		return m_visibilityBuffer.getBuffer(m_visibilityBuffer.getPreviousBufferIndex());
 	}
 
 	ResourceID MaterialShaderCollection::getSceneDescriptorSetDepthPass() const {
@@ -562,6 +709,7 @@ namespace sa {
 		subset.m_lightBuffer.clear();
 		subset.m_lightBuffer.write(static_cast<uint32_t>(m_lights.size()));
 		subset.m_lightBuffer.append(m_lights, 16);
+		subset.m_lightCount = static_cast<uint32_t>(m_lights.size());
 
 		//subset.m_shadows = m_shadows;
 
@@ -598,6 +746,10 @@ namespace sa {
 		return m_lightBuffer.getBuffer();
 	}
 
+	uint32_t SceneCollection::getLightCount() const {
+		return m_lightCount;
+	}
+
 	std::vector<ShadowData>::iterator SceneCollection::iterateShadowsBegin() {
 		return m_shadows.data.begin();
 	}
@@ -28,6 +28,10 @@ namespace sa {
 		: m_dispatcher(dispatcher)
 	{
 		SA_PROFILE_FUNCTION();
+
+		// Physics events come in batches, every script is called once per batch instead of once per pair
+		m_dispatcher.sink<scene_event::Contacts>().connect<&ScriptManager::onContacts>(this);
+		m_dispatcher.sink<scene_event::Triggers>().connect<&ScriptManager::onTriggers>(this);
 		
 		LuaAccessable::getState().open_libraries();
 
@@ -41,9 +45,88 @@ namespace sa {
 	}
 
 	ScriptManager::~ScriptManager() {
+		m_dispatcher.sink<scene_event::Contacts>().disconnect(this);
+		m_dispatcher.sink<scene_event::Triggers>().disconnect(this);
 		m_systemScripts.clear();
 	}
 
+	sol::table* ScriptManager::getEventTable(EventTables& tables, entt::entity entity, const char* callbackName) {
+		auto it = tables.find(entity);
+		if (it == tables.end()) {
+			// Most bodies have no scripts, they are looked up once per batch
+			bool isListening = false;
+			auto scriptsIt = m_entityScripts.find(entity);
+			if (scriptsIt != m_entityScripts.end()) {
+				for (auto& [name, script] : scriptsIt->second) {
+					const sol::object function = script.env[callbackName];
+					isListening |= function.get_type() == sol::type::function;
+				}
+			}
+			it = tables.emplace(entity, isListening ? LuaAccessable::getState().create_table() : sol::table()).first;
+		}
+		return it->second.valid() ? &it->second : nullptr;
+	}
+
+	void ScriptManager::callEventTables(const EventTables& tables, const char* callbackName) {
+		// Gathered first, a callback may add or remove scripts
+		std::vector<std::pair<sol::environment, sol::table>> calls;
+		for (auto& [entity, table] : tables) {
+			if (!table.valid())
+				continue;
+			for (auto& [name, script] : m_entityScripts[entity]) {
+				calls.emplace_back(script.env, table);
+			}
+		}
+		for (auto& [env, table] : calls) {
+			TryCall(env, callbackName, table);
+		}
+	}
+
+	void ScriptManager::onContacts(const scene_event::Contacts& e) {
+		SA_PROFILE_FUNCTION();
+		sol::state& lua = LuaAccessable::getState();
+		// Each script gets all contacts of its entity in one call, as { other, position, normal, impulse, type }
+		EventTables tables;
+		auto addContact = [&](entt::entity self, entt::entity other, const ContactRecord& contact, float normalSign) {
+			sol::table* pTable = getEventTable(tables, self, scene_event::Contacts::CallbackName);
+			if (!pTable)
+				return;
+			pTable->add(lua.create_table_with(
+				"other", Entity(e.pScene, other),
+				"position", contact.position,
+				"normal", Vector3(contact.normal * normalSign),
+				"impulse", contact.impulse,
+				"type", contact.state == TouchState::BEGIN ? "begin" : "end"));
+		};
+		for (const ContactRecord& contact : e.contacts) {
+			// The normal each side sees points away from the other entity
+			addContact(contact.entity0, contact.entity1, contact, 1.0f);
+			addContact(contact.entity1, contact.entity0, contact, -1.0f);
+		}
+		callEventTables(tables, scene_event::Contacts::CallbackName);
+	}
+
+	void ScriptManager::onTriggers(const scene_event::Triggers& e) {
+		SA_PROFILE_FUNCTION();
+		sol::state& lua = LuaAccessable::getState();
+		// Both the trigger and the entity entering it are called, with { trigger, other, type }
+		EventTables tables;
+		auto addTrigger = [&](entt::entity self, const TriggerRecord& record) {
+			sol::table* pTable = getEventTable(tables, self, scene_event::Triggers::CallbackName);
+			if (!pTable)
+				return;
+			pTable->add(lua.create_table_with(
+				"trigger", Entity(e.pScene, record.trigger),
+				"other", Entity(e.pScene, record.other),
+				"type", record.state == TouchState::BEGIN ? "enter" : "exit"));
+		};
+		for (const TriggerRecord& record : e.triggers) {
+			addTrigger(record.trigger, record);
+			addTrigger(record.other, record);
+		}
+		callEventTables(tables, scene_event::Triggers::CallbackName);
+	}
+
 
 	void ScriptManager::loadSystemScript(const std::string& path) {
 		SA_PROFILE_FUNCTION();
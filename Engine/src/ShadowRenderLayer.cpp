@@ -50,6 +50,14 @@ namespace sa {
 				data.depthFramebuffers[i] = NULL_RESOURCE;
 			}
 		}
+		for (auto& layerContexts : data.layerContextSets) {
+			for (uint32_t i = 0; i < data.layerCount; i++) {
+				layerContexts[i].destroy();
+			}
+		}
+		data.layerContextSets.clear();
+		data.usedLayerContextSets = 0;
+		data.layerCount = 0;
 		data.isInitialized = false;
 	}
 
@@ -99,21 +107,18 @@ namespace sa {
 		for (uint32_t i = 0; i < count; i++) {
 			data.depthFramebuffers[i] = m_renderer.createFramebuffer(m_depthRenderProgram, &data.depthTextureLayers[i], 1, data.depthTexture.getExtent());
 		}
+		data.layerCount = count;
 		data.isInitialized = true;
 	}
 
-	void ShadowRenderLayer::renderMaterialCollection(RenderContext& context, MaterialShaderCollection& collection, ShadowData& data, const ShadowRenderData& renderData, uint32_t layer) {
-		MaterialShader* pMaterialShader = collection.getMaterialShader();
-		if (!pMaterialShader)
-			return;
-		MaterialShadowPipeline& materialPipeline = m_materialShaderPipelines[pMaterialShader->getID()];
-		if (!materialPipeline.isInitialized)
-			initMaterialShadowPipeline(pMaterialShader, materialPipeline);
+	size_t ShadowRenderLayer::renderMaterialCollection(RenderContext& context, MaterialShaderCollection& collection, const ShadowData& data, const ShadowRenderData& renderData, uint32_t layer) {
+		const MaterialShadowPipeline& materialPipeline = m_materialShaderPipelines.at(collection.getMaterialShader()->getID());
 
+		size_t drawCallCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
+		if (drawCallCount == 0)
+			return 0;
 
 		const auto& prefs = getPreferences();
-
-		context.beginRenderProgram(m_depthRenderProgram, renderData.depthFramebuffers[layer], SubpassContents::DIRECT);
 		
 		context.bindPipelineLayout(materialPipeline.pipelineLayout);
 		context.bindPipeline(materialPipeline.pipeline);
@@ -140,17 +145,85 @@ namespace sa {
 		perFrame.projMat = data.lightProjMatrices[layer];
 		perFrame.viewPos = data.lightPosition;
 
-		if (collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>() > 0) {
-			context.pushConstant(ShaderStageFlagBits::VERTEX | ShaderStageFlagBits::FRAGMENT, perFrame);
-			uint32_t linearizeDepth = data.lightType == LightType::POINT ? 1u : 0u;
-			context.pushConstant(ShaderStageFlagBits::FRAGMENT, linearizeDepth, sizeof(perFrame));
-			size_t drawCallCount = collection.getDrawCommandBuffer().getElementCount<DrawIndexedIndirectCommand>();
-			context.drawIndexedIndirect(collection.getDrawCommandBuffer(), 0, drawCallCount, sizeof(DrawIndexedIndirectCommand));
-			Engine::GetEngineStatistics().drawCalls += drawCallCount;
+		context.pushConstant(ShaderStageFlagBits::VERTEX | ShaderStageFlagBits::FRAGMENT, perFrame);
+		uint32_t linearizeDepth = data.lightType == LightType::POINT ? 1u : 0u;
+		context.pushConstant(ShaderStageFlagBits::FRAGMENT, linearizeDepth, sizeof(perFrame));
+		context.drawIndexedIndirect(collection.getDrawCommandBuffer(), 0, drawCallCount, sizeof(DrawIndexedIndirectCommand));
+		return drawCallCount;
+	}
+
+	void ShadowRenderLayer::renderShadowLayers(RenderContext& context, const ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection, uint32_t layerCount) {
+		SA_PROFILE_FUNCTION();
+		// Everything that may create resources or write descriptor sets happens here, before any worker starts recording
+		std::vector<MaterialShaderCollection*> collections;
+		for (auto& collection : sceneCollection) {
+			MaterialShader* pMaterialShader = collection.getMaterialShader();
+			if (!pMaterialShader)
+				continue;
+
+			if (!collection.readyDescriptorSets(context)) {
+				continue;
+			}
+
+			if (!collection.arePipelinesReady()) {
+				continue;
+			}
+
+			MaterialShadowPipeline& materialPipeline = m_materialShaderPipelines[pMaterialShader->getID()];
+			if (!materialPipeline.isInitialized)
+				initMaterialShadowPipeline(pMaterialShader, materialPipeline);
+
+			collections.push_back(&collection);
+		}
 
+		layerCount = std::min(layerCount, renderData.layerCount);
+		std::array<size_t, ShadowPreferences::MaxCascadeCount> drawCallCounts = {};
+		size_t triangleCount = 0;
+		for (MaterialShaderCollection* pCollection : collections) {
+			triangleCount += pCollection->getTriangleCount();
+		}
+
+		if (renderData.usedLayerContextSets == renderData.layerContextSets.size()) {
+			auto& layerContexts = renderData.layerContextSets.emplace_back();
+			for (uint32_t i = 0; i < renderData.layerCount; i++) {
+				layerContexts[i] = m_renderer.createSubContext(renderData.depthFramebuffers[i], m_depthRenderProgram, 0, m_contextPools[i]);
+			}
+		}
+		auto& layerContexts = renderData.layerContextSets[renderData.usedLayerContextSets++];
+
+		auto recordLayer = [&](uint32_t layer) {
+			SA_PROFILE_SCOPE("Record shadow layer " + std::to_string(layer));
+			SubContext& subContext = layerContexts[layer];
+			subContext.begin(context, renderData.depthFramebuffers[layer], ContextUsageFlagBits::ONE_TIME_SUBMIT | ContextUsageFlagBits::RENDER_PROGRAM_CONTINUE);
+			for (MaterialShaderCollection* pCollection : collections) {
+				drawCallCounts[layer] += renderMaterialCollection(subContext, *pCollection, data, renderData, layer);
+			}
+			subContext.end();
+		};
+
+		if (layerCount > 1) {
+			tf::Taskflow taskflow;
+			taskflow.for_each_index(0U, layerCount, 1U, recordLayer);
+			tf::Executor& executor = Asset::GetTaskExecutor();
+			// A worker blocking on the taskflow would keep its thread from recording
+			if (executor.this_worker_id() >= 0)
+				executor.run_and_wait(taskflow);
+			else
+				executor.run(taskflow).wait();
+		}
+		else if (layerCount == 1) {
+			recordLayer(0);
+		}
+
+		// Execute in layer order so the primary context is identical regardless of which worker finished first
+		for (uint32_t i = 0; i < layerCount; i++) {
+			context.beginRenderProgram(m_depthRenderProgram, renderData.depthFramebuffers[i], SubpassContents::SUB_CONTEXT);
+			context.executeSubContext(layerContexts[i]);
+			context.syncFramebuffer(renderData.depthFramebuffers[i]);
+			context.endRenderProgram(m_depthRenderProgram);
+			Engine::GetEngineStatistics().drawCalls += drawCallCounts[i];
+			Engine::GetEngineStatistics().triangleCount += triangleCount;
 		}
-		context.syncFramebuffer(renderData.depthFramebuffers[layer]);
-		context.endRenderProgram(m_depthRenderProgram);
 	}
 
 	void ShadowRenderLayer::updateCascadeSplits(float near, float far) {
@@ -234,23 +307,9 @@ namespace sa {
 	}
 
 
-	void ShadowRenderLayer::renderCascadedShadowMaps(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection) {
+	void ShadowRenderLayer::renderCascadedShadowMaps(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection) {
 		const auto& prefs = getPreferences();
-
-		const int cascadeCount = prefs.cascadeCount;
-		
-		for (auto& collection : sceneCollection) {
-			if (!collection.readyDescriptorSets(context)) {
-				continue;
-			}
-
-			if (!collection.arePipelinesReady()) {
-				continue;
-			}
-			for (uint32_t i = 0; i < cascadeCount; i++) {
-				renderMaterialCollection(context, collection, data, renderData, i);
-			}
-		}
+		renderShadowLayers(context, data, renderData, sceneCollection, prefs.cascadeCount);
 	}
 
 	void ShadowRenderLayer::createSampler() {
@@ -268,7 +327,7 @@ namespace sa {
 		m_shadowSampler = m_renderer.createSampler(info);
 	}
 
-	void ShadowRenderLayer::renderCubeMapShadows(RenderContext& context, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection) {
+	void ShadowRenderLayer::renderCubeMapShadows(RenderContext& context, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection) {
 		static const std::array<glm::vec3, 6> faces = {
 			glm::vec3(-1, 0, 0),	// +X
 			glm::vec3(1, 0, 0),		// -X
@@ -301,23 +360,12 @@ namespace sa {
 
 			data.lightProjMatrices[i] = projMat;
 			data.lightViewMatrices[i] = camera.getViewMatrix();
-
-			for (auto& collection : sceneCollection) {
-				if (!collection.readyDescriptorSets(context)) {
-					continue;
-				}
-
-				if (!collection.arePipelinesReady()) {
-					continue;
-				}
-				renderMaterialCollection(context, collection, data, renderData, i);
-			}
-
 		}
 
+		renderShadowLayers(context, data, renderData, sceneCollection, static_cast<uint32_t>(faces.size()));
 	}
 
-	void ShadowRenderLayer::renderSingleDirectedShadow(RenderContext& context, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection) {
+	void ShadowRenderLayer::renderSingleDirectedShadow(RenderContext& context, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection) {
 		
 		SceneCamera camera;
 		camera.setProjectionMode(ProjectionMode::ePerspective);
@@ -333,20 +381,11 @@ namespace sa {
 		
 		data.lightViewMatrices[0] = camera.getViewMatrix();
 
-		for (auto& collection : sceneCollection) {
-			if (!collection.readyDescriptorSets(context)) {
-				continue;
-			}
-
-			if (!collection.arePipelinesReady()) {
-				continue;
-			}
-			renderMaterialCollection(context, collection, data, renderData, 0);
-		}
+		renderShadowLayers(context, data, renderData, sceneCollection, 1);
 	}
 
 
-	void ShadowRenderLayer::renderShadowMap(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, const ShadowRenderData& renderData, SceneCollection& sceneCollection) {
+	void ShadowRenderLayer::renderShadowMap(RenderContext& context, const SceneCamera& sceneCamera, ShadowData& data, ShadowRenderData& renderData, SceneCollection& sceneCollection) {
 		
 		switch(data.lightType) {
 		case LightType::DIRECTIONAL:
@@ -371,6 +410,13 @@ namespace sa {
 		//m_depthFormat = sa::Format::D16_UNORM;
 		m_depthFormat = m_renderer.getDefaultDepthFormat();
 		
+		if (!m_hasContextPools) {
+			for (auto& contextPool : m_contextPools) {
+				contextPool = m_renderer.createContextPool();
+			}
+			m_hasContextPools = true;
+		}
+
 		if (m_depthRenderProgram != NULL_RESOURCE) {
 			m_renderer.destroyRenderProgram(m_depthRenderProgram);
 			m_depthRenderProgram = NULL_RESOURCE;
@@ -404,6 +450,18 @@ namespace sa {
 			m_renderer.destroyRenderProgram(m_depthRenderProgram);
 			m_depthRenderProgram = NULL_RESOURCE;
 		}
+
+		if (m_hasContextPools) {
+			m_hasContextPools = false;
+			for (auto& contextPool : m_contextPools) {
+				m_renderer.destroyContextPool(contextPool);
+				contextPool = NULL_RESOURCE;
+			}
+		}
+	}
+
+	const char* ShadowRenderLayer::getName() const {
+		return "ShadowRenderLayer";
 	}
 	
 	void ShadowRenderLayer::onRenderTargetResize(UUID renderTargetID, Extent oldExtent, Extent newExtent) {
@@ -471,6 +529,11 @@ namespace sa {
 
 	bool ShadowRenderLayer::preRender(RenderContext& context, SceneCollection& sceneCollection) {
 		SA_PROFILE_FUNCTION();
+		// Called once per frame before any camera renders, each shadow map render this frame takes the next unused context set
+		forEachRenderData([](ShadowRenderData& renderData) {
+			renderData.usedLayerContextSets = 0;
+		});
+
 		for (auto it = sceneCollection.iterateShadowsBegin(); it != sceneCollection.iterateShadowsEnd(); it++) {
 			sa::ShadowData& data = *it;
 			if (data.lightType == LightType::DIRECTIONAL)
@@ -13,6 +13,7 @@ namespace comp {
 	void SphereCollider::serialize(sa::Serializer& s) {
 		s.value("radius", radius);
 		s.value("offset", (glm::vec3)offset);
+		s.value("isTrigger", isTrigger);
 	}
 	
 	void SphereCollider::deserialize(void* pDoc) {
@@ -21,6 +22,10 @@ namespace comp {
 		radius = (float)obj["radius"].get_double();
 		object member = obj["offset"];
 		offset = sa::Serializer::DeserializeVec3(&member);
+
+		auto field = obj.find_field("isTrigger");
+		if (field.error() != simdjson::NO_SUCH_FIELD)
+			isTrigger = field.get_bool().value();
 	}
 
 
@@ -30,15 +35,9 @@ namespace comp {
 		if (!rb)
 			rb = e->addComponent<comp::RigidBody>();
 
+		// A copied collider still points at the shape of the original, clones get it back from the shape cache
 		PxSphereGeometry sphere(radius);
-		if (offset.x + offset.y + offset.z > 0.01f) {
-			pShape = sa::PhysicsSystem::get().createExclusiveShape(&sphere);
-			PxTransform transform(sa::PhysicsSystem::toPxVec(offset));
-			pShape->setLocalPose(transform);
-		}
-		else {
-			pShape = sa::PhysicsSystem::get().createShape(&sphere);
-		}
+		pShape = sa::PhysicsSystem::get().createShape(&sphere, pMaterial, offset, isTrigger);
 
 		rb->m_pActor->attachShape(*pShape);
 	}
@@ -49,18 +48,12 @@ namespace comp {
 		if (!rb)
 			rb = e->addComponent<comp::RigidBody>();
 		rb->m_pActor->detachShape(*pShape);
+		sa::PhysicsSystem::get().releaseShape(pShape);
 
 		radius = std::max(radius, 0.01f);
 
 		PxSphereGeometry sphere(radius);
-		if (offset.x + offset.y + offset.z > 0.01f) {
-			pShape = sa::PhysicsSystem::get().createExclusiveShape(&sphere);
-			PxTransform transform(sa::PhysicsSystem::toPxVec(offset));
-			pShape->setLocalPose(transform);
-		}
-		else {
-			pShape = sa::PhysicsSystem::get().createShape(&sphere);
-		}
+		pShape = sa::PhysicsSystem::get().createShape(&sphere, pMaterial, offset, isTrigger);
 
 		rb->m_pActor->attachShape(*pShape);
 	}
@@ -70,6 +63,8 @@ namespace comp {
 		comp::RigidBody* rb = e->getComponent<comp::RigidBody>();
 		if (rb) 
 			rb->m_pActor->detachShape(*pShape);
+		sa::PhysicsSystem::get().releaseShape(pShape);
+		pShape = nullptr;
 	}
 
 
@@ -3,19 +3,28 @@
 
 #include "Tools/Logger.hpp"
 #include "AssetManager.h"
+#include "Graphics/TextureTable.h"
 
 
 namespace sa {
 
+    void TextureAsset::updateTableSlot() {
+        if (m_tableSlot == UINT32_MAX)
+            m_tableSlot = TextureTable::Get().insert(m_texture);
+        else
+            TextureTable::Get().update(m_tableSlot, m_texture);
+    }
+
     bool TextureAsset::onLoad(JsonObject& metaData, AssetLoadFlags flags) {
         setCompletionCount(2);
         
-        if (m_texture.isValid())
-            m_texture.destroy();
+        // The table slot keeps pointing at the old image until the new one is in
+        TextureTable::Get().retire(m_texture);
 
         Image img(getAssetPath().generic_string().c_str());
         incrementProgress();
         m_texture.create2D(img, true);
+        updateTableSlot();
         incrementProgress();
         return true;
     }
@@ -27,12 +36,13 @@ namespace sa {
         dataInStream.read(static_cast<byte_t*>(m_dataBuffer.data()), m_dataBuffer.size());
         incrementProgress();
 
-        if (m_texture.isValid())
-            m_texture.destroy();
+        // The table slot keeps pointing at the old image until the new one is in
+        TextureTable::Get().retire(m_texture);
 
         Image img(m_dataBuffer.data(), m_dataBuffer.size());
         incrementProgress();
         m_texture.create2D(img, true);
+        updateTableSlot();
         incrementProgress();
         AssetHeader header = getHeader();
         header.size = m_dataBuffer.size(); // update size
@@ -55,7 +65,13 @@ namespace sa {
     bool TextureAsset::onUnload() {
         m_dataBuffer.clear();
         m_dataBuffer.shrink_to_fit();
-        m_texture.destroy();
+        if (m_tableSlot != UINT32_MAX) {
+            TextureTable::Get().remove(m_tableSlot);
+            m_tableSlot = UINT32_MAX;
+        }
+        // Frames in flight may still sample it through the table
+        TextureTable::Get().retire(m_texture);
+        m_texture = Texture();
         return true;
     }
 
@@ -70,10 +86,15 @@ namespace sa {
             Image img(getAssetPath().generic_string().c_str());
             clone->m_texture.create2D(img, true);
         }
+        clone->updateTableSlot();
         return clone;
     }
 
     const Texture& TextureAsset::getTexture() const {
         return m_texture;
     }
+
+    uint32_t TextureAsset::getTableSlot() const {
+        return m_tableSlot;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "pch.h"
+#include "Graphics/TextureTable.h"
+
+#include "AssetManager.h"
+
+namespace sa {
+
+	TextureTable::TextureTable()
+		: m_isDirty(true)
+		, m_revision(0)
+		, m_frameCount(0)
+	{
+		m_pendingTextures.reserve(TEXTURE_TABLE_CAPACITY);
+		m_pendingTextures.push_back(*AssetManager::Get().loadDefaultTexture());
+	}
+
+	TextureTable& TextureTable::Get() {
+		static TextureTable instance;
+		return instance;
+	}
+
+	uint32_t TextureTable::insert(const Texture& texture) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		uint32_t slot;
+		if (!m_freeSlots.empty()) {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			m_pendingTextures[slot] = texture;
+		}
+		else {
+			if (m_pendingTextures.size() >= TEXTURE_TABLE_CAPACITY) {
+				SA_DEBUG_LOG_WARNING("Texture table is full, using default texture");
+				return TEXTURE_TABLE_DEFAULT_SLOT;
+			}
+			slot = m_pendingTextures.size();
+			m_pendingTextures.push_back(texture);
+		}
+		m_isDirty = true;
+		return slot;
+	}
+
+	void TextureTable::update(uint32_t slot, const Texture& texture) {
+		if (slot == TEXTURE_TABLE_DEFAULT_SLOT)
+			return;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingTextures.at(slot) = texture;
+		m_isDirty = true;
+	}
+
+	void TextureTable::remove(uint32_t slot) {
+		if (slot == TEXTURE_TABLE_DEFAULT_SLOT)
+			return;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// keep the slot pointing at a valid image until it is reused
+		m_pendingTextures.at(slot) = m_pendingTextures[TEXTURE_TABLE_DEFAULT_SLOT];
+		m_freeSlots.push_back(slot);
+		m_isDirty = true;
+	}
+
+	void TextureTable::retire(const Texture& texture) {
+		if (!texture.isValid())
+			return;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_retiredTextures.push_back({ texture, m_frameCount });
+	}
+
+	void TextureTable::beginFrame() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_frameCount++;
+		std::erase_if(m_retiredTextures, [&](RetiredTexture& retired) {
+			if (retired.frame + TEXTURE_TABLE_RETIRE_FRAMES > m_frameCount)
+				return false;
+			retired.texture.destroy();
+			return true;
+		});
+	}
+
+	const std::vector<Texture>& TextureTable::getTextures() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_isDirty) {
+			m_textures = m_pendingTextures;
+			m_isDirty = false;
+			m_revision++;
+		}
+		return m_textures;
+	}
+
+	uint64_t TextureTable::getRevision() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_revision;
+	}
+
+	void TextureTable::clear() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingTextures.resize(1);
+		m_freeSlots.clear();
+		m_isDirty = true;
+		// Only called once rendering has stopped
+		for (auto& retired : m_retiredTextures) {
+			retired.texture.destroy();
+		}
+		m_retiredTextures.clear();
+	}
+
+}
@@ -63,10 +63,17 @@ namespace sa {
 		SA_DEBUG_LOG_INFO("Resized window renderer");
 	}
 
-	void WindowRenderer::render(RenderContext& context, const Texture& texture) {
+	void WindowRenderer::render(RenderContext& context, const RenderTarget& renderTarget) {
 		SA_PROFILE_FUNCTION();
+		const Texture& texture = renderTarget.getOutputTexture();
 		assert(texture.isValid() && "Texture must be valid");
 
+		PushConstants pushConstants = {};
+		pushConstants.uvScale = renderTarget.getOutputUVScale();
+		pushConstants.sharpness = 0.0f;
+		if (pushConstants.uvScale.x < 1.0f || pushConstants.uvScale.y < 1.0f)
+			pushConstants.sharpness = renderTarget.getDynamicResolution().getSettings().sharpness;
+
 		// render texture to swapchain
 		context.updateDescriptorSet(m_swapchainDescriptorSet, 0, texture, m_sampler);
 		context.beginRenderProgram(m_swapchainRenderProgram, m_swapchainFramebuffer, SubpassContents::DIRECT);
@@ -77,6 +84,7 @@ namespace sa {
 		viewport.extent = m_pWindow->getCurrentExtent();
 		context.setViewport(viewport);
 		context.bindDescriptorSet(m_swapchainDescriptorSet);
+		context.pushConstant(ShaderStageFlagBits::FRAGMENT, pushConstants);
 		context.draw(6, 1);
 		context.endRenderProgram(m_swapchainRenderProgram);
 		Engine::GetEngineStatistics().drawCalls++;
@@ -343,6 +343,9 @@ namespace ImGui {
 		if (ImGui::DragFloat3("Offset##BoxCollider", (float*)&bc->offset)) {
 			bc->onUpdate(&entity);
 		}
+		if (ImGui::Checkbox("Is Trigger##BoxCollider", &bc->isTrigger)) {
+			bc->onUpdate(&entity);
+		}
 
 	}
 
@@ -353,6 +356,15 @@ namespace ImGui {
 		if (ImGui::DragFloat3("Offset##SphereCollider", (float*)&sc->offset)) {
 			sc->onUpdate(&entity);
 		}
+		if (ImGui::Checkbox("Is Trigger##SphereCollider", &sc->isTrigger)) {
+			sc->onUpdate(&entity);
+		}
+	}
+
+	void Component(sa::Entity entity, comp::PhysicsAggregate* aggregate) {
+		if (ImGui::Checkbox("Self Collision##PhysicsAggregate", &aggregate->selfCollision)) {
+			aggregate->onUpdate(&entity);
+		}
 	}
 
 	void Component(sa::Entity entity, comp::Camera* camera) {
@@ -712,7 +724,8 @@ namespace ImGui {
 		float aspect = (float)pRenderTarget->getExtent().height / pRenderTarget->getExtent().width;
 		size.y = size.x * aspect;
 
-		Image(pRenderTarget->getOutputTexture(), size);
+		glm::vec2 uvScale = pRenderTarget->getOutputUVScale();
+		Image(pRenderTarget->getOutputTexture(), size, { 0, 0 }, { uvScale.x, uvScale.y });
 
 		return false;
 	}
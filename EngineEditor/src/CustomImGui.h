@@ -59,6 +59,7 @@ namespace ImGui {
 	void Component(sa::Entity entity, comp::RigidBody* rb);
 	void Component(sa::Entity entity, comp::BoxCollider* bc);
 	void Component(sa::Entity entity, comp::SphereCollider* sc);
+	void Component(sa::Entity entity, comp::PhysicsAggregate* aggregate);
 	void Component(sa::Entity entity, comp::Camera* camera);
 
 	template<typename T>
@@ -10,6 +10,7 @@
 
 #include "AssetManager.h"
 #include "Assets\ModelAsset.h"
+#include "Assets\MaterialShader.h"
 
 #include "ImGuiRenderLayer.h"
 
@@ -215,6 +216,26 @@ namespace sa {
 		if (ImGui::MenuItem("Reload Scene", "Ctrl + R")) {
 			m_pEngine->getCurrentScene()->load();
 		}
+
+		if (ImGui::MenuItem("Prebuild Shader Cache")) {
+			prebuildShaderCache(false);
+		}
+	}
+
+	void EngineEditor::prebuildShaderCache(bool wait) {
+		std::vector<std::filesystem::path> directories = { Engine::GetShaderDirectory() };
+		if (!m_projectFile.empty())
+			directories.push_back(std::filesystem::current_path());
+
+		auto prebuild = [directories]() {
+			for (const auto& directory : directories) {
+				MaterialShader::PrebuildShaderCache(directory);
+			}
+		};
+		if (wait)
+			prebuild();
+		else
+			Asset::GetTaskExecutor().silent_async(prebuild);
 	}
 
 	void EngineEditor::startSimulation() {
@@ -224,6 +245,10 @@ namespace sa {
 		pScene->compile(MakeEditorRelative("sceneCache.data"));
 		pScene->getProgress().waitAll();
 
+		ByteStream snapshot(4096);
+		pScene->capturePhysicsState(snapshot);
+		m_physicsSnapshot.assign(snapshot.data(), snapshot.data() + snapshot.size());
+
 		m_state = State::PLAYING;
 		pScene->onRuntimeStart();
 	}
@@ -233,7 +258,19 @@ namespace sa {
 		pScene->onRuntimeStop();
 		m_state = State::EDIT;
 		
+		// Scripts may have changed more than physics, so the scene is reloaded. The snapshot then gives the bodies
+		// back their sleep state and kinematic targets, which the reload alone would reset
 		pScene->loadCompiled(MakeEditorRelative("sceneCache.data"));
+		pScene->getProgress().waitAll();
+		restartPhysics();
+		m_physicsSnapshot.clear();
+	}
+
+	void EngineEditor::restartPhysics() {
+		if (m_physicsSnapshot.empty())
+			return;
+		ByteStream snapshot(m_physicsSnapshot.data(), m_physicsSnapshot.size());
+		m_pEngine->getCurrentScene()->restorePhysicsState(snapshot);
 	}
 
 
@@ -312,6 +349,7 @@ namespace sa {
 		m_editorModules.push_back(std::make_unique<SceneHierarchy>(&engine, this));
 		m_editorModules.push_back(std::make_unique<RenderPipelinePreferences>(&engine, this));
 		m_editorModules.push_back(std::make_unique<DirectoryView>(&engine, this));
+		m_editorModules.push_back(std::make_unique<FrameStatisticsView>(&engine, this));
 		m_editorModules.push_back(std::make_unique<GameView>(&engine, this, &renderWindow));
 		m_editorModules.push_back(std::make_unique<SceneView>(&engine, this, &renderWindow));
 
@@ -447,6 +485,11 @@ namespace sa {
 				if (ImGui::ImageButtonTinted(m_playPauseTex, ImVec2(buttonSize, buttonSize), ImVec2(2 * oneThird, 0), ImVec2(1, 1))) {
 					stopSimulation();
 				}
+				// Rewinds only the bodies, scripts keep their state
+				ImGui::SetCursorPosY(framePaddingY - (buttonSize * 0.25f));
+				if (ImGui::Button("Restart Physics")) {
+					restartPhysics();
+				}
 			}
 
 		}
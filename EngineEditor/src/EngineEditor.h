@@ -10,6 +10,7 @@
 #include "EntityInspector.h"
 #include "GameView.h"
 #include "RenderPipelinePreferences.h"
+#include "FrameStatisticsView.h"
 #include "DirectoryView.h"
 #include <imgui_internal.h>
 
@@ -43,6 +44,9 @@ namespace sa {
 
 		Scene* m_pEditingScene;
 
+		// Physics state of the scene when play was pressed, restoring it rewinds the simulation without a reload
+		std::vector<byte_t> m_physicsSnapshot;
+
 		void makePopups();
 
 		bool openProject();
@@ -56,6 +60,7 @@ namespace sa {
 
 		void startSimulation();
 		void stopSimulation();
+		void restartPhysics();
 
 		void imGuiProfiler();
 
@@ -69,6 +74,8 @@ namespace sa {
 		EngineEditor() = default;
 		
 		bool openProject(const std::filesystem::path& path);
+		// Compiles the engine shaders and the shaders of the open project into the shader cache
+		void prebuildShaderCache(bool wait);
 		
 		void onAttach(sa::Engine& engine, sa::RenderWindow& renderWindow) override;
 		void onDetach() override;
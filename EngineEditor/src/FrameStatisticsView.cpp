@@ -0,0 +1,117 @@
+#include "FrameStatisticsView.h"
+
+#include "CustomImGui.h"
+#include "Tools/FileDialogs.h"
+
+void FrameStatisticsView::imGuiPercentilesRow(const char* name, const sa::FramePercentiles& percentiles, float scale) {
+	ImGui::TableNextRow();
+	ImGui::TableNextColumn();
+	ImGui::Text("%s", name);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.2f", percentiles.p50 * scale);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.2f", percentiles.p95 * scale);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.2f", percentiles.p99 * scale);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.2f", percentiles.max * scale);
+}
+
+FrameStatisticsView::FrameStatisticsView(sa::Engine* pEngine, sa::EngineEditor* pEditor)
+	: EditorModule(pEngine, pEditor, "Frame Statistics", true)
+	, m_plotMetric(sa::FrameMetric::CPU_TIME)
+	, m_histogramMaxTime(50.f)
+	, m_histogramBucketCount(50)
+{
+
+}
+
+FrameStatisticsView::~FrameStatisticsView() {
+
+}
+
+void FrameStatisticsView::onImGui() {
+	if (!m_isOpen)
+		return;
+	if (ImGui::Begin(m_name, &m_isOpen)) {
+		sa::FrameStatistics& frameStatistics = sa::Engine::GetFrameStatistics();
+
+		ImGui::Text("Frames: %llu / %llu", (unsigned long long)frameStatistics.getFrameCount(), (unsigned long long)frameStatistics.getCapacity());
+		ImGui::SameLine();
+		if (ImGui::Button("Clear")) {
+			frameStatistics.clear();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export CSV")) {
+			std::filesystem::path path;
+			if (sa::FileDialogs::SaveFile("CSV\0*.csv\0\0", path)) {
+				if (!path.has_extension())
+					path.replace_extension(".csv");
+				frameStatistics.exportCSV(path);
+			}
+		}
+
+		// Percentiles, times in milliseconds
+		if (ImGui::BeginTable("Percentiles", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+			ImGui::TableSetupColumn("");
+			ImGui::TableSetupColumn("p50");
+			ImGui::TableSetupColumn("p95");
+			ImGui::TableSetupColumn("p99");
+			ImGui::TableSetupColumn("max");
+			ImGui::TableHeadersRow();
+
+			imGuiPercentilesRow("CPU ms", frameStatistics.getPercentiles(sa::FrameMetric::CPU_TIME), 1000.f);
+			imGuiPercentilesRow("GPU ms", frameStatistics.getPercentiles(sa::FrameMetric::GPU_TIME), 1000.f);
+			imGuiPercentilesRow("Draw calls", frameStatistics.getPercentiles(sa::FrameMetric::DRAW_CALLS), 1.f);
+			imGuiPercentilesRow("Triangles", frameStatistics.getPercentiles(sa::FrameMetric::TRIANGLES), 1.f);
+			imGuiPercentilesRow("Uploads", frameStatistics.getPercentiles(sa::FrameMetric::UPLOADS), 1.f);
+			imGuiPercentilesRow("Allocations", frameStatistics.getPercentiles(sa::FrameMetric::ALLOCATIONS), 1.f);
+
+			for (const auto& name : frameStatistics.getCounterNames()) {
+				imGuiPercentilesRow(name.c_str(), frameStatistics.getCounterPercentiles(name), 1.f);
+			}
+			ImGui::EndTable();
+		}
+
+		// History plot
+		if (ImGui::BeginCombo("Metric", sa::FrameStatistics::MetricName(m_plotMetric))) {
+			for (int i = 0; i <= (int)sa::FrameMetric::ALLOCATIONS; i++) {
+				sa::FrameMetric metric = (sa::FrameMetric)i;
+				if (ImGui::Selectable(sa::FrameStatistics::MetricName(metric), metric == m_plotMetric)) {
+					m_plotMetric = metric;
+				}
+			}
+			ImGui::EndCombo();
+		}
+
+		std::vector<float> values = frameStatistics.getValues(m_plotMetric);
+		bool isTime = m_plotMetric == sa::FrameMetric::CPU_TIME || m_plotMetric == sa::FrameMetric::GPU_TIME;
+		if (isTime) {
+			for (auto& value : values) {
+				value *= 1000.f;
+			}
+		}
+		ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(1.f, 1.f, 1.f, 1.f));
+		ImGui::PlotLines("##FrameHistory", values.data(), values.size(), 0, nullptr, 0.f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 80));
+		ImGui::PopStyleColor();
+
+		// Frame time histogram
+		ImGui::SliderFloat("Histogram range (ms)", &m_histogramMaxTime, 5.f, 200.f, "%.0f");
+		ImGui::SliderInt("Buckets", &m_histogramBucketCount, 5, 200);
+
+		std::vector<uint32_t> cpuBuckets = frameStatistics.getFrameTimeHistogram(m_histogramBucketCount, m_histogramMaxTime / 1000.f, sa::FrameMetric::CPU_TIME);
+		std::vector<float> cpuHistogram(cpuBuckets.begin(), cpuBuckets.end());
+		ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(1.f, 1.f, 1.f, 1.f));
+		ImGui::PlotHistogram("##CPUHistogram", cpuHistogram.data(), cpuHistogram.size(), 0, "CPU frame time", 0.f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 80));
+
+		std::vector<uint32_t> gpuBuckets = frameStatistics.getFrameTimeHistogram(m_histogramBucketCount, m_histogramMaxTime / 1000.f, sa::FrameMetric::GPU_TIME);
+		std::vector<float> gpuHistogram(gpuBuckets.begin(), gpuBuckets.end());
+		ImGui::PlotHistogram("##GPUHistogram", gpuHistogram.data(), gpuHistogram.size(), 0, "GPU frame time", 0.f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 80));
+		ImGui::PopStyleColor();
+	}
+	ImGui::End();
+}
+
+void FrameStatisticsView::update(float dt) {
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "EditorModule.h"
+
+#include <Tools/FrameStatistics.h>
+
+class FrameStatisticsView : public EditorModule {
+private:
+	sa::FrameMetric m_plotMetric;
+	float m_histogramMaxTime;
+	int m_histogramBucketCount;
+
+	void imGuiPercentilesRow(const char* name, const sa::FramePercentiles& percentiles, float scale);
+
+public:
+	FrameStatisticsView(sa::Engine* pEngine, sa::EngineEditor* pEditor);
+	virtual ~FrameStatisticsView();
+	virtual void onImGui() override;
+	virtual void update(float dt) override;
+};
@@ -41,6 +41,19 @@ void GameView::onImGui() {
 				ImGui::EndMenu();
 			}
 
+			if (ImGui::BeginMenu("Dynamic Resolution")) {
+				sa::DynamicResolution& dynamicResolution = m_pEngine->getMainRenderTarget().getDynamicResolution();
+				sa::DynamicResolutionSettings settings = dynamicResolution.getSettings();
+				bool changed = ImGui::Checkbox("Enabled", &settings.isEnabled);
+				changed |= ImGui::DragFloat("Target GPU time (ms)", &settings.targetFrameTime, 0.1f, 1.0f, 100.0f);
+				changed |= ImGui::SliderFloat("Min scale", &settings.minScale, 0.25f, 1.0f);
+				changed |= ImGui::SliderFloat("Sharpness", &settings.sharpness, 0.0f, 1.0f);
+				if (changed)
+					dynamicResolution.setSettings(settings);
+				ImGui::Text("Scale: %.2f", dynamicResolution.getScale());
+				ImGui::EndMenu();
+			}
+
 			ImGui::EndMenuBar();
 		}
 
@@ -63,7 +76,8 @@ void GameView::onImGui() {
 			pos -= imageSize * 0.5f;
 			
 			ImGui::SetCursorPos({ pos.x, pos.y });
-			ImGui::Image(m_pEngine->getMainRenderTarget().getOutputTexture(), {imageSize.x, imageSize.y});
+			glm::vec2 uvScale = m_pEngine->getMainRenderTarget().getOutputUVScale();
+			ImGui::Image(m_pEngine->getMainRenderTarget().getOutputTexture(), {imageSize.x, imageSize.y}, { 0, 0 }, { uvScale.x, uvScale.y });
 			
 		}
 	}
@@ -32,7 +32,7 @@ void ImGuiRenderLayer::cleanup() {
 	}
 }
 
-void ImGuiRenderLayer::render(sa::RenderContext& context, const sa::Texture& texture) {
+void ImGuiRenderLayer::render(sa::RenderContext& context, const sa::RenderTarget& renderTarget) {
 	context.beginRenderProgram(m_imGuiRenderProgram, m_imGuiFramebuffer, sa::SubpassContents::DIRECT);
 	context.renderImGuiFrame();
 	context.endRenderProgram(m_imGuiRenderProgram);
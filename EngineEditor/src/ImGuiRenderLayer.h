@@ -19,7 +19,7 @@ public:
 	virtual void init();
 	virtual void cleanup();
 
-	virtual void render(sa::RenderContext& context, const sa::Texture& texture) override;
+	virtual void render(sa::RenderContext& context, const sa::RenderTarget& renderTarget) override;
 
 	virtual void onWindowResize(sa::Extent newExtent) override;
 
@@ -4,16 +4,24 @@
 namespace sa {
 	class EditorApp : public Application {
 	public:
+		// Usage: SaturnEditor [project file] [--prebuild-shaders]
 		EditorApp(int argc, char** argv, bool enableImgui = true)
 			: Application(enableImgui) 
 		{
 			EngineEditor* pEditor = new EngineEditor;
 			pushLayer(pEditor);
-			if (argc > 1) {
-				std::filesystem::path projectPath = argv[1];
+			bool prebuildShaders = false;
+			for (int i = 1; i < argc; i++) {
+				if (strcmp(argv[i], "--prebuild-shaders") == 0) {
+					prebuildShaders = true;
+					continue;
+				}
+				std::filesystem::path projectPath = argv[i];
 				if (std::filesystem::exists(projectPath))
 					pEditor->openProject(projectPath);
 			}
+			if (prebuildShaders)
+				pEditor->prebuildShaderCache(true);
 		}
 
 	};
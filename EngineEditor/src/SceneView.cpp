@@ -213,6 +213,7 @@ void SceneView::onImGui() {
 				if (pForwardPlus) {
 					ImGui::Checkbox("Show Light Heatmap", 
 						&pForwardPlus->getRenderTargetData(m_renderTarget.getID()).renderDebugHeatmap);
+					ImGui::Checkbox("Occlusion Culling", &pForwardPlus->getPreferences().occlusionCulling);
 				}
 
 				ImGui::Checkbox("Show Icons", &showIcons);
@@ -250,7 +251,8 @@ void SceneView::onImGui() {
 		}
 		
 		if (m_renderTarget.isSampleReady()) {
-			ImGui::Image(m_renderTarget.getOutputTexture(), imAvailSize);
+			glm::vec2 uvScale = m_renderTarget.getOutputUVScale();
+			ImGui::Image(m_renderTarget.getOutputTexture(), imAvailSize, { 0, 0 }, { uvScale.x, uvScale.y });
 			
 			auto pForwardPlus = m_pEngine->getRenderPipeline().getLayer<sa::ForwardPlus>();
 			if (pForwardPlus) {
@@ -260,6 +262,20 @@ void SceneView::onImGui() {
 					const sa::Texture& heatmap = renderData.debugLightHeatmap.getTexture();
 					ImGui::SetCursorPos(ImGui::GetWindowContentRegionMin());
 					ImGui::Image(heatmap, imAvailSize);
+
+					if (ImGui::IsItemHovered()) {
+						ImVec2 itemMin = ImGui::GetItemRectMin();
+						ImVec2 itemSize = ImGui::GetItemRectSize();
+						ImVec2 mouse = ImGui::GetMousePos();
+						const sa::Extent& extent = m_renderTarget.getExtent();
+						glm::uvec2 pixel = {
+							(uint32_t)((mouse.x - itemMin.x) / itemSize.x * extent.width),
+							(uint32_t)((mouse.y - itemMin.y) / itemSize.y * extent.height)
+						};
+						glm::uvec2 tile = pixel / (uint32_t)TILE_SIZE;
+						ImGui::SetTooltip("Tile %u, %u: %u lights", tile.x, tile.y,
+							pForwardPlus->getTileLightCount(m_renderTarget.getID(), tile));
+					}
 				}
 			}
 		}
@@ -524,10 +540,18 @@ void SceneView::onImGui() {
 
 				ImGui::PopStyleColor();
 				ImGui::Text("Frame time: %f ms", stats.frameTime * 1000);
+				ImGui::Text("GPU frame time: %f ms", stats.gpuFrameTime * 1000);
 
 				ImGui::Text("Draw calls: %u", stats.drawCalls);
 				ImGui::Text("Dispatch calls: %u", stats.dispatchCalls);
 
+				if (ImGui::TreeNode("GPU Scopes")) {
+					for (const auto& scope : stats.gpuScopes) {
+						ImGui::Text("%*s%s: %.3f ms", scope.depth * 2, "", scope.name.c_str(), scope.durationMs);
+					}
+					ImGui::TreePop();
+				}
+
 			}
 			if (ImGui::CollapsingHeader("Memory")) {
 				ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(1.f, 1.f, 1.f, 1.f));
@@ -555,6 +579,7 @@ void SceneView::onImGui() {
 				}
 				ImGui::Unindent();
 				ImGui::Text("Total: %llu MB / %llu MB", stats.gpuMemoryStats.totalUsage / 1000000, stats.gpuMemoryStats.totalBudget / 1000000);
+				ImGui::Text("Transient textures: %llu MB", stats.gpuMemoryStats.transientTextureBytes / 1000000);
 			}
 			ImGui::PopStyleColor(4);
 			ImGui::Unindent();
@@ -0,0 +1,256 @@
+
+#include "Engine.h"
+#include "Tools/Clock.h"
+
+#include <fstream>
+
+// Frames stepped before the timing starts, so piles have settled into their steady contact count
+#define BENCHMARK_WARMUP_FRAMES 60U
+#define BENCHMARK_DEFAULT_FRAME_COUNT 600U
+
+namespace sa {
+
+	struct BenchmarkScenario {
+		const char* name;
+		std::function<void(Scene*)> build;
+		// Called before every frame with the simulated time, may be empty
+		std::function<void(float)> update;
+	};
+
+	struct BenchmarkResult {
+		std::string name;
+		size_t entityCount = 0;
+		uint32_t frameCount = 0;
+		uint64_t stepCount = 0;
+		double totalFrameMs = 0.0;
+		double minFrameMs = std::numeric_limits<double>::max();
+		double maxFrameMs = 0.0;
+		// Time inside simulate and fetchResults only, the rest of the frame is left out
+		double totalStepMs = 0.0;
+		double minStepMs = std::numeric_limits<double>::max();
+		double maxStepMs = 0.0;
+		double avgBroadphasePairs = 0.0;
+		uint32_t maxBroadphasePairs = 0;
+		double avgActiveActors = 0.0;
+		uint32_t maxActiveActors = 0;
+	};
+
+	static Entity CreateBody(Scene* pScene, const Vector3& position, bool isStatic) {
+		Entity entity = pScene->createEntity("Body");
+		// The actor is created at the transform, so it has to be placed before the rigid body is added
+		entity.addComponent<comp::Transform>()->position = position;
+		entity.addComponent<comp::RigidBody>(isStatic);
+		return entity;
+	}
+
+	static Entity CreateBox(Scene* pScene, const Vector3& position, const Vector3& halfLengths, bool isStatic) {
+		Entity entity = CreateBody(pScene, position, isStatic);
+		entity.addComponent<comp::BoxCollider>(halfLengths);
+		return entity;
+	}
+
+	static Entity CreateSphere(Scene* pScene, const Vector3& position, float radius, bool isStatic) {
+		Entity entity = CreateBody(pScene, position, isStatic);
+		entity.addComponent<comp::SphereCollider>(radius);
+		return entity;
+	}
+
+	static void CreateGround(Scene* pScene, float halfSize) {
+		CreateBox(pScene, Vector3(0.0f, -0.5f, 0.0f), Vector3(halfSize, 0.5f, halfSize), true);
+	}
+
+	static BenchmarkScenario StackedBoxes() {
+		return { "stacked_boxes", [](Scene* pScene) {
+			CreateGround(pScene, 50.0f);
+			for (int x = 0; x < 4; x++) {
+				for (int z = 0; z < 4; z++) {
+					for (int y = 0; y < 20; y++) {
+						CreateBox(pScene, Vector3(x * 4.0f - 6.0f, 0.5f + y * 1.01f, z * 4.0f - 6.0f), Vector3(0.5f), false);
+					}
+				}
+			}
+		} };
+	}
+
+	static BenchmarkScenario Pile() {
+		return { "pile_10k", [](Scene* pScene) {
+			CreateGround(pScene, 100.0f);
+			// 25 x 16 x 25 bodies dropped on top of each other, every other one a sphere
+			int i = 0;
+			for (int y = 0; y < 16; y++) {
+				for (int x = 0; x < 25; x++) {
+					for (int z = 0; z < 25; z++) {
+						const Vector3 position(x * 1.1f - 13.2f, 1.0f + y * 1.1f, z * 1.1f - 13.2f);
+						if (i++ % 2 == 0)
+							CreateBox(pScene, position, Vector3(0.5f), false);
+						else
+							CreateSphere(pScene, position, 0.5f, false);
+					}
+				}
+			}
+		} };
+	}
+
+	static BenchmarkScenario StaticHeavy() {
+		return { "static_heavy", [](Scene* pScene) {
+			// 100 x 100 tiles with a pillar on every tenth one, the broadphase has to skip them all
+			for (int x = 0; x < 100; x++) {
+				for (int z = 0; z < 100; z++) {
+					CreateBox(pScene, Vector3(x - 49.5f, -0.5f, z - 49.5f), Vector3(0.5f), true);
+					if ((x * 100 + z) % 10 == 0)
+						CreateBox(pScene, Vector3(x - 49.5f, 1.0f, z - 49.5f), Vector3(0.25f, 1.0f, 0.25f), true);
+				}
+			}
+			for (int x = 0; x < 8; x++) {
+				for (int z = 0; z < 8; z++) {
+					CreateSphere(pScene, Vector3(x * 10.0f - 35.0f, 10.0f, z * 10.0f - 35.0f), 0.5f, false);
+				}
+			}
+		} };
+	}
+
+	static BenchmarkScenario KinematicCrowd() {
+		// Shared between the build and update functions
+		auto pMovers = std::make_shared<std::vector<std::pair<Entity, Vector3>>>();
+		return { "kinematic_crowd", [=](Scene* pScene) {
+			CreateGround(pScene, 100.0f);
+			for (int x = 0; x < 32; x++) {
+				for (int z = 0; z < 32; z++) {
+					const Vector3 center(x * 3.0f - 46.5f, 0.5f, z * 3.0f - 46.5f);
+					Entity mover = CreateSphere(pScene, center, 0.4f, false);
+					mover.getComponent<comp::RigidBody>()->setKinematic(true);
+					pMovers->push_back({ mover, center });
+				}
+			}
+			// Dynamic boxes in between the walkers get pushed around
+			for (int x = 0; x < 16; x++) {
+				for (int z = 0; z < 16; z++) {
+					CreateBox(pScene, Vector3(x * 6.0f - 44.0f, 0.5f, z * 6.0f - 44.0f), Vector3(0.5f), false);
+				}
+			}
+		}, [=](float time) {
+			// Every walker circles its start position, written through the transform as a script would
+			for (size_t i = 0; i < pMovers->size(); i++) {
+				auto& [mover, center] = (*pMovers)[i];
+				const float angle = time + i * 0.37f;
+				mover.getComponent<comp::Transform>()->position = center + Vector3(std::cos(angle), 0.0f, std::sin(angle)) * 1.5f;
+			}
+		} };
+	}
+
+	static BenchmarkResult RunScenario(const BenchmarkScenario& scenario, uint32_t frameCount) {
+		SA_PROFILE_FUNCTION();
+		Scene* pScene = AssetManager::Get().createAsset<Scene>(scenario.name);
+		scenario.build(pScene);
+
+		BenchmarkResult result;
+		result.name = scenario.name;
+		result.entityCount = pScene->getEntityCount();
+		result.frameCount = frameCount;
+
+		// One step per frame, so every frame times exactly one step
+		const float dt = pScene->getPhysicsSettings().fixedTimeStep;
+		float time = 0.0f;
+		pScene->onRuntimeStart();
+		auto runFrame = [&]() {
+			if (scenario.update)
+				scenario.update(time);
+			pScene->runtimeUpdate(dt);
+			time += dt;
+		};
+		for (uint32_t i = 0; i < BENCHMARK_WARMUP_FRAMES; i++) {
+			runFrame();
+		}
+		pScene->syncPhysics();
+		const uint64_t firstStep = pScene->getPhysicsStatistics().stepCount;
+		const double firstStepTime = pScene->getPhysicsStatistics().totalStepTime;
+
+		Clock clock;
+		for (uint32_t i = 0; i < frameCount; i++) {
+			const uint64_t stepCount = pScene->getPhysicsStatistics().stepCount;
+			clock.restart();
+			runFrame();
+			// Fetched right away, so the step does not overlap the next frame and the fetch waits for all of it
+			pScene->syncPhysics();
+			const double frameMs = clock.getElapsedTime<std::chrono::duration<double, std::milli>>();
+			result.totalFrameMs += frameMs;
+			result.minFrameMs = std::min(result.minFrameMs, frameMs);
+			result.maxFrameMs = std::max(result.maxFrameMs, frameMs);
+
+			const PhysicsStatistics& stats = pScene->getPhysicsStatistics();
+			if (stats.stepCount != stepCount) {
+				const double stepMs = stats.stepTime * 1000.0;
+				result.minStepMs = std::min(result.minStepMs, stepMs);
+				result.maxStepMs = std::max(result.maxStepMs, stepMs);
+			}
+			result.avgBroadphasePairs += stats.broadphasePairCount;
+			result.maxBroadphasePairs = std::max(result.maxBroadphasePairs, stats.broadphasePairCount);
+			result.avgActiveActors += stats.activeActorCount;
+			result.maxActiveActors = std::max(result.maxActiveActors, stats.activeActorCount);
+		}
+		result.stepCount = pScene->getPhysicsStatistics().stepCount - firstStep;
+		result.totalStepMs = (pScene->getPhysicsStatistics().totalStepTime - firstStepTime) * 1000.0;
+		result.avgBroadphasePairs /= frameCount;
+		result.avgActiveActors /= frameCount;
+
+		pScene->onRuntimeStop();
+		AssetManager::Get().removeAsset(pScene);
+		return result;
+	}
+
+	static void SerializeResult(Serializer& s, const BenchmarkResult& result) {
+		s.beginObject();
+		s.value("name", result.name.c_str());
+		s.value("entityCount", result.entityCount);
+		s.value("frameCount", result.frameCount);
+		s.value("stepCount", result.stepCount);
+		s.value("msPerStep", result.stepCount > 0 ? result.totalStepMs / result.stepCount : 0.0);
+		s.value("minStepMs", result.stepCount > 0 ? result.minStepMs : 0.0);
+		s.value("maxStepMs", result.maxStepMs);
+		s.value("msPerFrame", result.frameCount > 0 ? result.totalFrameMs / result.frameCount : 0.0);
+		s.value("minFrameMs", result.minFrameMs);
+		s.value("maxFrameMs", result.maxFrameMs);
+		s.value("avgBroadphasePairs", result.avgBroadphasePairs);
+		s.value("maxBroadphasePairs", result.maxBroadphasePairs);
+		s.value("avgActiveActors", result.avgActiveActors);
+		s.value("maxActiveActors", result.maxActiveActors);
+		s.endObject();
+	}
+}
+
+// Usage: PhysicsBenchmark [output.json] [frame count]
+// Runs without a window, the report is printed and optionally written to a file to compare against earlier runs
+int main(int argc, char** argv) {
+	using namespace sa;
+
+	const uint32_t frameCount = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : BENCHMARK_DEFAULT_FRAME_COUNT;
+
+	const BenchmarkScenario scenarios[] = {
+		StackedBoxes(),
+		Pile(),
+		StaticHeavy(),
+		KinematicCrowd(),
+	};
+
+	Serializer s;
+	s.beginObject();
+	s.value("workerCount", PhysicsSystem::get().getWorkerCount());
+	s.beginArray("scenarios");
+	for (const BenchmarkScenario& scenario : scenarios) {
+		SerializeResult(s, RunScenario(scenario, frameCount));
+	}
+	s.endArray();
+	s.endObject();
+
+	const std::string report = s.dump();
+	std::cout << report << std::endl;
+	if (argc > 1) {
+		std::ofstream file(argv[1]);
+		if (!file.good()) {
+			std::cerr << "Failed to open " << argv[1] << std::endl;
+			return 1;
+		}
+		file << report;
+	}
+	return 0;
+}
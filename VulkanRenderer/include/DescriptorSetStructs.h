@@ -2,6 +2,11 @@
 #include <vector>
 #include "ShaderInfoStructs.h"
 
+// Descriptors allocated for a variable count binding, like the bindless texture table
+#define MAX_VARIABLE_DESCRIPTOR_COUNT 1024U
+// Descriptor count of a binding with a variable count, it has to be the last binding of its set
+#define VARIABLE_DESCRIPTOR_COUNT 0
+
 namespace vk {
 	class Sampler;
 }
@@ -68,5 +68,17 @@ namespace sa {
 		size_t totalBudget;
 		std::array<HeapMemoryStats, 32> heaps;
 		uint8_t heapCount;
+		// Number of bytes in the heaps shared by transient textures, included in the heap usage
+		size_t transientTextureBytes;
+	};
+
+	// Running totals since the renderer was created, sample them twice and subtract to get per frame values
+	struct DeviceActivityCounters {
+		// Number of buffers and images allocated
+		size_t allocationCount;
+		// Number of transfers recorded to upload data to the device
+		size_t uploadCount;
+		// Number of bytes read by those transfers
+		size_t uploadBytes;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace sa {
+
+	struct GpuTimestampScope {
+		std::string name;
+		double beginMs;		// relative to the beginning of the frame
+		double durationMs;
+		uint32_t depth;
+	};
+
+	struct GpuFrameTimestamps {
+		double frameTimeMs = 0.0;
+		long long cpuBeginTime = 0;	// microseconds since epoch on the high resolution clock, when the frame began recording
+		std::vector<GpuTimestampScope> scopes;
+	};
+
+}
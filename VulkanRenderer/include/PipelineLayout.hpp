@@ -13,10 +13,21 @@ namespace spirv_cross
 
 namespace sa {
 
+	struct ShaderDefine {
+		std::string name;
+		std::string value;
+	};
+
+	// Compiled SPIR-V is cached by a hash of the preprocessed source (includes resolved), defines, stage and compile options.
+	// Results are always cached in memory, and on disk when a directory is set. Pass an empty string to disable the disk cache.
+	void SetShaderCacheDirectory(const char* directory);
+	// Per user cache directory shared by the pipeline and shader caches, the working directory if there is none
+	std::string GetUserCacheDirectory();
+
 	// OBS: Will cause memory leak! This a an issue with shaderc_compiler
-	[[nodiscard]] std::vector<uint32_t> CompileGLSLFromFile(const char* glslPath, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory);
+	[[nodiscard]] std::vector<uint32_t> CompileGLSLFromFile(const char* glslPath, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory, const std::vector<ShaderDefine>& defines = {});
 	// OBS: Will cause memory leak! This a an issue with shaderc_compiler
-	[[nodiscard]] std::vector<uint32_t> CompileGLSLFromMemory(const char* glslCode, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory, const char* tag = "Unamed Source");
+	[[nodiscard]] std::vector<uint32_t> CompileGLSLFromMemory(const char* glslCode, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory, const char* tag = "Unamed Source", const std::vector<ShaderDefine>& defines = {});
 
 	[[nodiscard]] std::vector<uint32_t> ReadSPVFile(const char* spvPath);
 
@@ -27,6 +38,25 @@ namespace sa {
 	class VulkanCore;
 	class PipelineLayout;
 	class Shader;
+	class Buffer;
+	class Texture;
+
+	// The resources a cached descriptor set should hold. Only references are kept, they have to outlive the lookup.
+	class DescriptorSetResources {
+		friend class PipelineLayout;
+		struct Resource {
+			uint32_t binding;
+			const Buffer* pBuffer;
+			const Texture* pTexture;
+			ResourceID sampler;
+		};
+		std::vector<Resource> m_resources;
+	public:
+		DescriptorSetResources& bind(uint32_t binding, const Buffer& buffer);
+		DescriptorSetResources& bind(uint32_t binding, const Texture& texture, ResourceID sampler);
+		DescriptorSetResources& bind(uint32_t binding, const Texture& texture);
+		DescriptorSetResources& bind(uint32_t binding, ResourceID sampler);
+	};
 
 	class DescriptorSetFactory {
 		friend class PipelineLayout;
@@ -102,6 +132,11 @@ namespace sa {
 		bool hasTessellationStage() const;
 
 		ResourceID allocateDescriptorSet(uint32_t setIndex);
+		// Allocates a set from the current frame's descriptor pools. It is only valid for the current frame and should not be freed
+		ResourceID allocateTransientDescriptorSet(uint32_t setIndex);
+		// Returns a set already holding exactly these resources, or writes a new one. The set is shared and owned
+		// by the renderer, it must not be updated or freed and is only valid for the current frame.
+		ResourceID getCachedDescriptorSet(uint32_t setIndex, const DescriptorSetResources& resources);
 
 		bool hasAllocatedDescriptorSet(ResourceID descriptorSet);
 		
@@ -35,6 +35,18 @@ namespace sa {
 		SIMULTANEOUS_USE = 4
 	};
 
+	struct TextureBarrier {
+		const Texture* pTexture;
+		Transition src;
+		Transition dst;
+	};
+
+	struct BufferBarrier {
+		const Buffer* pBuffer;
+		Transition src;
+		Transition dst;
+	};
+
 	enum class SubpassContents {
 		DIRECT,
 		SUB_CONTEXT
@@ -92,6 +104,11 @@ namespace sa {
 
 		void executeSubContext(const sa::SubContext& context) const;
 
+		// GPU timestamps around the commands recorded in between, resolved into Renderer::getGpuTimestamps.
+		// Not allowed inside a render program begun with SubpassContents::SUB_CONTEXT
+		uint32_t beginGpuScope(const char* name) const;
+		void endGpuScope(uint32_t scope) const;
+
 		void bindPipelineLayout(const PipelineLayout& pipelineLayout);
 		void bindPipeline(ResourceID pipeline) const;
 		void bindShader(const Shader& shader) const;
@@ -203,6 +220,8 @@ namespace sa {
 		void barrier(const Buffer& buffer, Transition src, Transition dst) const;
 
 		void barrier(Transition src, Transition dst) const;
+		// Records every barrier in a single pipeline barrier with the stages of all of them combined
+		void barriers(const std::vector<TextureBarrier>& textureBarriers, const std::vector<BufferBarrier>& bufferBarriers) const;
 		void fullBarrier() const;
 
 
@@ -232,6 +251,10 @@ namespace sa {
 		SubContext(VulkanCore* pCore, FramebufferSet* pFramebufferSet, RenderProgram* pRenderProgram, uint32_t subpassIndex, ResourceID contextPool);
 
 		void begin(ContextUsageFlags usageFlags = 0);
+		// Begins recording into the buffer that parentContext will execute this frame,
+		// inheriting framebuffer if it is not NULL_RESOURCE. Safe to call from any thread as long as
+		// no other thread records into a context allocated from the same context pool.
+		void begin(const RenderContext& parentContext, ResourceID framebuffer, ContextUsageFlags usageFlags = 0);
 		void end();
 		void preRecord(std::function<void(RenderContext&)> function, ContextUsageFlags usageFlags = 0);
 
@@ -7,10 +7,12 @@
 #include "Resources/Buffer.hpp"
 #include "Resources/Texture.hpp"
 #include "Resources/DynamicTexture.hpp"
+#include "Resources/TransientTexture.hpp"
 #include "Image.hpp"
 #include "FormatFlags.hpp"
 #include "PipelineSettings.hpp"
 #include "DeviceMemoryStats.hpp"
+#include "GpuTimestamps.hpp"
 
 #include "ShaderSet.hpp"
 
@@ -20,9 +22,14 @@
 #include "imgui_stdlib.h"
 
 #include <mutex>
+#include <chrono>
+#include <atomic>
 
 #include "Resources/DynamicBuffer.hpp"
 
+// Seconds without new pipelines before the cache is written, so a burst of pipeline creation is only saved once
+#define PIPELINE_CACHE_SAVE_DELAY_SECONDS 5
+
 namespace sa {
 
 	class VulkanCore;
@@ -114,6 +121,14 @@ namespace sa {
 		
 		std::list<DataTransfer> m_transferQueue;
 		std::mutex m_transferMutex;
+		size_t m_uploadCount = 0;
+		size_t m_uploadBytes = 0;
+
+		// Pipelines may be created from any thread
+		std::atomic<bool> m_hasUnsavedPipelines = false;
+		std::atomic<std::chrono::steady_clock::rep> m_lastPipelineCreation = 0;
+
+		void onPipelineCreated();
 
 		const bool c_useVaildationLayers =
 #if SA_RENDER_VALIDATION_ENABLE
@@ -130,6 +145,9 @@ namespace sa {
 
 		VulkanCore* getCore() const;
 
+		// The pipeline cache is saved on shutdown and on a worker thread after new pipelines were created, call this to force a save
+		void savePipelineCache();
+
 #ifndef IMGUI_DISABLE
 		void initImGui(const Window& window, ResourceID renderProgram, uint32_t subpass);
 		void newImGuiFrame();
@@ -187,12 +205,21 @@ namespace sa {
 		void updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, const std::vector<Texture>& textures, ResourceID sampler, uint32_t firstElement);
 		void updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, const Texture* textures, uint32_t textureCount, ResourceID sampler, uint32_t firstElement);
 		void updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, const Texture* textures, uint32_t textureCount, uint32_t firstElement);
+		void updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, const DynamicTexture* textures, uint32_t textureCount, uint32_t firstElement);
 
 		void updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, ResourceID sampler);
 
 		void freeDescriptorSet(ResourceID descriptorSet);
 
+		// Places textures whose lifetimes do not overlap in the same memory, which is shared with every other
+		// allocation of the frame. Undefined formats are selected from the usage like Texture::create2D.
+		// ppTextures[i] stays valid until the same frame in flight begins again.
+		void allocateTransientTextures(const TransientTextureRequest* pRequests, uint32_t count, const TransientTexture** ppTextures);
+
 		DeviceMemoryStats getGPUMemoryUsage() const;
+		// Timings of the most recent frame whose results are available, scopes are written with RenderContext::beginGpuScope
+		const GpuFrameTimestamps& getGpuTimestamps() const;
+		DeviceActivityCounters getDeviceActivityCounters() const;
 
 		DataTransfer* queueTransfer(const DataTransfer& transfer);
 		bool cancelTransfer(DataTransfer* pTransfer);
@@ -205,6 +232,7 @@ namespace sa {
 		void endFrame(ResourceID swapchain);
 
 		ResourceID createContextPool();
+		void destroyContextPool(ResourceID contextPool);
 
 		DirectContext createDirectContext(ResourceID contextPool = NULL_RESOURCE);
 		SubContext createSubContext(ResourceID framebuffer, ResourceID renderProgram, uint32_t subpassIndex, ResourceID contextPool = NULL_RESOURCE);
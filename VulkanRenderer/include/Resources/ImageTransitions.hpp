@@ -12,6 +12,10 @@ namespace sa {
 		FRAGMENT_SHADER_READ,
 		FRAGMENT_SHADER_WRITE,
 		FRAGMENT_SHADER_READ_WRITE,
+		VERTEX_SHADER_READ,
+		INDIRECT_READ,
+		// Memory last used by another resource, waits for all previous work and discards the contents
+		ALIASED,
 	};
 
 	inline constexpr const char* to_string(Transition transition) {
@@ -36,6 +40,12 @@ namespace sa {
 			return "FRAGMENT_SHADER_WRITE";
 		case Transition::FRAGMENT_SHADER_READ_WRITE:
 			return "FRAGMENT_SHADER_READ_WRITE";
+		case Transition::VERTEX_SHADER_READ:
+			return "VERTEX_SHADER_READ";
+		case Transition::INDIRECT_READ:
+			return "INDIRECT_READ";
+		case Transition::ALIASED:
+			return "ALIASED";
 		default:
 			return "";
 		}
@@ -23,6 +23,8 @@ namespace sa {
 		STORAGE = 8,
 		COLOR_ATTACHMENT = 16,	
 		DEPTH_ATTACHMENT = 32,
+		// Only used as an attachment within a render program, placed in lazily allocated memory when the device has it
+		TRANSIENT_ATTACHMENT = 64,
 		INPUT_ATTACHMENT = 128,
 	};
 
@@ -38,6 +40,8 @@ namespace sa {
 
 	class Texture {
 	private:
+		friend class TransientTexturePool;
+
 		VulkanCore* m_pCore;
 		DeviceImage* m_pImage;
 		DeviceBuffer* m_pStagingBuffer;
@@ -54,6 +58,8 @@ namespace sa {
 		ImageView createImageView(TextureType viewType, uint32_t mipLevels, uint32_t baseMipLevel, uint32_t layers, uint32_t baseArrayLevel);
 		
 		void create2D(TextureType type, TextureUsageFlags usageFlags, Extent extent, Format format, uint32_t mipLevels, uint32_t arrayLayers, uint32_t samples, uint32_t imageCreateFlags);
+		// Takes ownership of an image that is already bound to memory
+		void create(DeviceImage* pImage, TextureType type, TextureUsageFlags usageFlags);
 
 	public:
 		Texture();
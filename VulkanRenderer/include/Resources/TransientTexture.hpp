@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Texture.hpp"
+
+namespace sa {
+
+	struct TransientTextureDesc {
+		TextureUsageFlags usage = 0;
+		Extent extent = { 1, 1 };
+		Format format = Format::UNDEFINED;
+		uint32_t mipLevels = 1;
+		uint32_t arrayLayers = 1;
+		uint32_t samples = 1;
+
+		bool operator==(const TransientTextureDesc& other) const = default;
+	};
+
+	// A texture is alive from the first to the last use, in any increasing unit like pass indices
+	struct TransientTextureRequest {
+		TransientTextureDesc desc;
+		uint32_t firstUse;
+		uint32_t lastUse;
+	};
+
+	// Texture placed in memory shared with other transient textures. The contents are undefined
+	// before its first use, since the memory may have been written through another texture.
+	struct TransientTexture {
+		Texture texture;
+		// One view per mip level
+		std::vector<Texture> mipLevelTextures;
+	};
+
+}
@@ -31,6 +31,7 @@ namespace sa {
 
 		vk::CommandBuffer getBuffer(uint32_t index = -1) const;
 		uint32_t getBufferIndex() const;
+		void setBufferIndex(uint32_t index);
 
 		uint32_t getQueueFamilyIndex() const;
 
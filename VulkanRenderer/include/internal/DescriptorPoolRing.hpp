@@ -0,0 +1,41 @@
+#pragma once
+
+#include "DescriptorSetStructs.h"
+
+#include <mutex>
+
+namespace sa {
+
+	// Frame scoped descriptor pools. Sets allocated from a frame are only valid until
+	// that frame comes around again, at which point every pool of the frame is reset at once.
+	class DescriptorPoolRing {
+	private:
+		struct Frame {
+			std::vector<vk::DescriptorPool> pools;
+			uint32_t currentPool = 0;
+			std::vector<ResourceID> descriptorSets;
+		};
+
+		vk::Device m_device;
+		std::vector<Frame> m_frames;
+		uint32_t m_frameIndex;
+
+		std::mutex m_mutex;
+
+		vk::DescriptorPool createPool();
+		
+	public:
+		DescriptorPoolRing();
+
+		void create(vk::Device device, uint32_t frameCount);
+		void destroy();
+
+		// Resets all pools used by frameIndex, the frame must no longer be in flight
+		void beginFrame(uint32_t frameIndex);
+
+		ResourceID allocate(const DescriptorSetLayoutInfo& info, vk::DescriptorSetLayout layout, uint32_t setIndex);
+
+		uint32_t getFrameIndex() const;
+	};
+
+}
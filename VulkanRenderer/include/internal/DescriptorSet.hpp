@@ -1,26 +1,58 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 #include "Resources\Texture.hpp"
 #include "Resources\Buffer.hpp"
 #include "DeviceMemoryManager.hpp"
 #include "DescriptorSetStructs.h"
 
-#define MAX_VARIABLE_DESCRIPTOR_COUNT 1024
-#define VARIABLE_DESCRIPTOR_COUNT 0
+// Destroyed handles remembered for invalidating written keys, past this every older key is treated as stale
+#define DESCRIPTOR_SET_MAX_DESTROYED_HANDLES 4096U
 
 namespace sa {
 
 	class DescriptorSet {
 	private:
+		struct WrittenKey {
+			std::vector<uint64_t> key;
+			// resource generation the key was last known to only reference live handles
+			uint64_t validatedGeneration = 0;
+		};
+
 		vk::Device m_device;
 		vk::DescriptorPool m_descriptorPool;
 		std::vector<vk::DescriptorSet> m_descriptorSets;
 		std::unordered_map<uint32_t, vk::WriteDescriptorSet> m_writes;
 		uint32_t m_setIndex;
+		
+		// every handle, offset and layout of the last write per binding, per set. Used to skip redundant updates
+		std::vector<std::unordered_map<uint32_t, WrittenKey>> m_writtenKeys;
+		std::vector<uint64_t> m_writeKey;
+		// cached sets are only freed once no frame in flight uses them, so freeing them does not wait for the device
+		bool m_isCached = false;
+		// transient sets are never freed on their own, their memory is reclaimed when the owning pool is reset
+		bool m_isTransient = false;
+
+		// bumped whenever a buffer, view, sampler or set layout is destroyed, since a new one may reuse the handle value
+		static std::atomic<uint64_t> s_resourceGeneration;
+		// generation each recently destroyed handle was destroyed at
+		static std::unordered_map<uint64_t, uint64_t> s_destroyedHandles;
+		// destroyed handles up to this generation have been forgotten
+		static uint64_t s_forgottenGeneration;
+		static std::mutex s_destroyedHandlesMutex;
 
 		void update(uint32_t binding, uint32_t arrayIndex, uint32_t indexToUpdate);
 
 	public:
+		// Stales every written key and cached set referencing handle, call when the handle is destroyed
+		static void OnHandleDestroyed(uint64_t handle);
+		// Returns false if a handle in key was destroyed after validatedGeneration, otherwise advances validatedGeneration
+		static bool IsKeyValid(const std::vector<uint64_t>& key, uint64_t& validatedGeneration);
+		static uint64_t GetResourceGeneration();
+		// Appends everything the write references, two writes with equal keys bind the same resources
+		static void GetWriteKey(const vk::WriteDescriptorSet& write, std::vector<uint64_t>& key);
 
 		void create(
 			vk::Device device,
@@ -28,7 +60,9 @@ namespace sa {
 			uint32_t count,
 			DescriptorSetLayoutInfo info,
 			vk::DescriptorSetLayout layout,
-			uint32_t setIndex);
+			uint32_t setIndex,
+			bool isCached = false,
+			bool isTransient = false);
 		void destroy();
 
 		void update(uint32_t binding, vk::Buffer buffer, vk::DeviceSize bufferSize, vk::DeviceSize bufferOffset, vk::BufferView* pView, uint32_t indexToUpdate);
@@ -43,5 +77,9 @@ namespace sa {
 
 		vk::DescriptorType getDescriptorType(uint32_t binding) const;
 
+		bool isCached() const;
+
+		bool isTransient() const;
+
 	};
 }
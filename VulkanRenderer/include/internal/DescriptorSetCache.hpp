@@ -0,0 +1,60 @@
+#pragma once
+
+#include "DescriptorSetStructs.h"
+
+#include <mutex>
+
+// Frames a cached set may go unused before it is freed, counted in begun frames of every swapchain
+#define DESCRIPTOR_SET_CACHE_MAX_UNUSED_FRAMES 8U
+
+namespace sa {
+
+	class DescriptorSet;
+
+	// Descriptor sets keyed by their layout plus every resource handle written to them. A lookup compares the
+	// whole key, so a set is only handed out again when it holds exactly the requested resources. Sets are
+	// written once when created and never updated after, they are freed when unused for a few frames.
+	class DescriptorSetCache {
+	public:
+		// Layout handle followed by the binding, handles, offsets and layouts of every written resource
+		using Key = std::vector<uint64_t>;
+
+	private:
+		struct KeyHash {
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry {
+			ResourceID descriptorSet;
+			uint64_t lastUsedFrame;
+			// resource generation the key was last known to only reference live handles
+			uint64_t validatedGeneration;
+		};
+
+		vk::Device m_device;
+		std::vector<vk::DescriptorPool> m_pools;
+		std::unordered_map<Key, Entry, KeyHash> m_entries;
+		// Sets that can not be handed out anymore, freed once no frame in flight can use them
+		std::vector<Entry> m_retiredEntries;
+
+		uint64_t m_frameCount;
+
+		std::mutex m_mutex;
+
+		vk::DescriptorPool createPool();
+		DescriptorSet allocate(const DescriptorSetLayoutInfo& info, vk::DescriptorSetLayout layout, uint32_t setIndex);
+
+	public:
+		DescriptorSetCache();
+
+		void create(vk::Device device);
+		void destroy();
+
+		// Frees sets that went unused for too long
+		void beginFrame();
+
+		// Returns the set holding the resources of key, write is called to fill in a newly allocated set
+		ResourceID get(const Key& key, const DescriptorSetLayoutInfo& info, vk::DescriptorSetLayout layout, uint32_t setIndex, const std::function<void(DescriptorSet&)>& write);
+	};
+
+}
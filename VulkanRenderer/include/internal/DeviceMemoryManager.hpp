@@ -39,6 +39,9 @@ namespace sa {
 		vk::ImageTiling tiling;
 		vk::ImageUsageFlags usage;
 
+		// Bound to memory owned by someone else, destroying the image does not free it
+		bool isAliasing = false;
+
 		using DeviceResource::DeviceResource;
 		DeviceImage(const DeviceImage&) = delete;
 
@@ -58,6 +61,9 @@ namespace sa {
 		
 		std::mutex m_memoryMutex;
 
+		size_t m_allocationCount = 0;
+		bool m_hasLazilyAllocatedMemory = false;
+
 	public:
 		DeviceMemoryManager() = default;
 		
@@ -93,12 +99,21 @@ namespace sa {
 		DeviceImage* createTexture3D(vk::Extent3D extent, vk::ImageUsageFlags usage, vk::SampleCountFlagBits sampleCount, vk::Format format, uint32_t mipLevels = 1, uint32_t arrayLayers = 1);
 		*/
 
+		// Memory for images to be bound with createAliasingImage, freed with freeMemory
+		VmaAllocation allocateMemory(const vk::MemoryRequirements& requirements, VmaMemoryUsage memoryUsage, vk::MemoryPropertyFlags requiredMemoryProperties);
+		void freeMemory(VmaAllocation allocation);
+		vk::MemoryRequirements getImageMemoryRequirements(const vk::ImageCreateInfo& info) const;
+		DeviceImage* createAliasingImage(VmaAllocation allocation, vk::DeviceSize offset, const vk::ImageCreateInfo& info);
+
 		void destroyBuffer(DeviceBuffer* buffer);
 		void destroyImage(DeviceImage* texture);
 
 		void setCurrentFrameIndex(uint32_t frameIndex);
 
 		DeviceMemoryStats getDeviceMemoryStats() const;
+		// Number of buffers and images created so far
+		size_t getAllocationCount() const;
+		bool hasLazilyAllocatedMemory() const;
 
 	};
 }
\ No newline at end of file
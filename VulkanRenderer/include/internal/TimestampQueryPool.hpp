@@ -0,0 +1,56 @@
+#pragma once
+
+#include "GpuTimestamps.hpp"
+
+#include <mutex>
+
+namespace sa {
+
+	// Timestamp queries for one frame per frame in flight. Results of a frame are resolved
+	// when its slot is reused, so they are never waited on and arrive a frame in flight later.
+	class TimestampQueryPool {
+	private:
+		struct Frame {
+			vk::QueryPool queryPool;
+			std::vector<std::string> scopeNames;
+			std::vector<uint32_t> scopeDepths;
+			long long cpuBeginTime = 0;
+			bool isPending = false;
+		};
+
+		vk::Device m_device;
+		std::vector<Frame> m_frames;
+		uint32_t m_frameIndex;
+		uint32_t m_maxScopes;
+		uint32_t m_depth;
+		bool m_isRecording;
+
+		double m_timestampPeriod; // nanoseconds per tick
+		uint64_t m_timestampMask;
+
+		std::mutex m_mutex;
+
+		GpuFrameTimestamps m_lastResults;
+
+		void resolve(Frame& frame);
+
+	public:
+		TimestampQueryPool();
+
+		void create(vk::PhysicalDevice physicalDevice, vk::Device device, uint32_t queueFamily, uint32_t frameCount, uint32_t maxScopes);
+		void destroy();
+
+		// Resolves the previous results of frameIndex, the frame must no longer be in flight
+		void beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex);
+		void endFrame(vk::CommandBuffer commandBuffer);
+
+		// Returns UINT32_MAX if no timestamp was written
+		uint32_t beginScope(vk::CommandBuffer commandBuffer, const char* name);
+		void endScope(vk::CommandBuffer commandBuffer, uint32_t scope);
+
+		bool isEnabled() const;
+
+		const GpuFrameTimestamps& getLastResults() const;
+	};
+
+}
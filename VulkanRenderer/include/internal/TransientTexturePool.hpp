@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Resources/TransientTexture.hpp"
+#include "DeviceMemoryManager.hpp"
+
+#include <list>
+
+// Frames a cached texture may go unused before it is destroyed
+#define TRANSIENT_TEXTURE_MAX_UNUSED_FRAMES 120U
+
+namespace sa {
+
+	// Frame scoped memory for textures that are only alive during part of a frame. Every allocation
+	// of a frame places its textures from the start of the same heaps, so textures of different
+	// allocations alias, as do textures of the same allocation whose lifetimes do not overlap.
+	// Textures are cached by their placement, a heap only changes when it has to grow.
+	class TransientTexturePool {
+	private:
+		struct Entry {
+			TransientTextureDesc desc;
+			vk::DeviceSize offset;
+			TransientTexture texture;
+			uint64_t lastUsedFrame;
+		};
+
+		struct Heap {
+			VmaAllocation allocation = nullptr;
+			vk::DeviceSize size = 0;
+			// std::list so handed out pointers stay valid while entries are added
+			std::list<Entry> entries;
+		};
+
+		struct Frame {
+			// Keyed by memory type bits, lazily allocated heaps have the upper half set
+			std::unordered_map<uint64_t, Heap> heaps;
+			// Replaced heaps, the textures might still be used by the frame that replaced them
+			std::vector<Heap> retiredHeaps;
+		};
+
+		DeviceMemoryManager* m_pMemoryManager;
+		std::vector<Frame> m_frames;
+		uint32_t m_frameIndex;
+		uint64_t m_frameCount;
+
+		void destroyHeap(Heap& heap);
+		vk::ImageCreateInfo getImageCreateInfo(const TransientTextureDesc& desc) const;
+		const TransientTexture* getTexture(Heap& heap, const TransientTextureDesc& desc, vk::DeviceSize offset);
+
+	public:
+		TransientTexturePool();
+
+		void create(DeviceMemoryManager* pMemoryManager, uint32_t frameCount);
+		void destroy();
+
+		// Destroys heaps retired by frameIndex and textures unused for too long, the frame must no longer be in flight
+		void beginFrame(uint32_t frameIndex);
+
+		// Formats must be resolved. ppTextures[i] is valid until the same frame index begins again.
+		void allocate(const TransientTextureRequest* pRequests, uint32_t count, const TransientTexture** ppTextures);
+
+		// Size of the heaps of every frame in flight
+		vk::DeviceSize getMemorySize() const;
+	};
+
+}
@@ -11,6 +11,12 @@
 #include "CommandPool.hpp"
 #include "ShaderSet.hpp"
 #include "internal/DeviceMemoryManager.hpp"
+#include "internal/DescriptorPoolRing.hpp"
+#include "internal/DescriptorSetCache.hpp"
+#include "internal/TimestampQueryPool.hpp"
+#include "internal/TransientTexturePool.hpp"
+
+#include <future>
 
 #include "FormatFlags.hpp"
 #include "Resources/ImageTransitions.hpp"
@@ -120,6 +126,16 @@ namespace sa {
 
 		DeviceMemoryManager m_memoryManager;
 
+		DescriptorPoolRing m_transientDescriptorPools;
+		DescriptorSetCache m_descriptorSetCache;
+		TimestampQueryPool m_timestampQueryPool;
+		TransientTexturePool m_transientTextures;
+
+		vk::PipelineCache m_pipelineCache;
+		std::string m_pipelineCachePath;
+		size_t m_savedPipelineCacheSize;
+		std::future<void> m_pipelineCacheSave;
+
 		vk::DescriptorPool m_imGuiDescriptorPool;
 		std::unordered_map<VkImageView, VkDescriptorSet> m_imGuiImages;
 		vk::Sampler m_imGuiImageSampler;
@@ -137,6 +153,10 @@ namespace sa {
 
 		void createCommandPool();
 
+		void createPipelineCache();
+		void destroyPipelineCache();
+		void writePipelineCache();
+
 	public:
 		static const unsigned int FRAMES_IN_FLIGHT = 2;
 
@@ -233,10 +253,23 @@ namespace sa {
 		vk::SampleCountFlags getSupportedDepthSampleCounts() const;
 
 		DeviceMemoryStats getGPUMemoryUsage() const;
+		size_t getAllocationCount() const;
 
 		// used by memory manager to check memory bugets 
 		void setMemoryManagerFrameIndex(uint32_t frameIndex);
 
+		DescriptorPoolRing& getTransientDescriptorPools();
+		DescriptorSetCache& getDescriptorSetCache();
+		TimestampQueryPool& getTimestampQueryPool();
+		TransientTexturePool& getTransientTexturePool();
+
+		// Shared by every pipeline created, vk::PipelineCache is internally synchronized
+		vk::PipelineCache getPipelineCache() const;
+		// Writes the cache to disk if it has grown since last save
+		void savePipelineCache();
+		// Same as savePipelineCache but written on a worker thread. Returns false if the previous save is still running
+		bool savePipelineCacheAsync();
+
 	};
 
 
@@ -131,6 +131,12 @@ namespace sa {
 		return m_currentBufferIndex;
 	}
 
+	void CommandBufferSet::setBufferIndex(uint32_t index) {
+		if (index >= m_buffers.size())
+			throw std::runtime_error("Buffer index out of range: " + std::to_string(index));
+		m_currentBufferIndex = index;
+	}
+
 	uint32_t CommandBufferSet::getQueueFamilyIndex() const {
 		return m_queueFamilyIndex;
 	}
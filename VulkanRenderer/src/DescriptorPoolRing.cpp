@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "internal/DescriptorPoolRing.hpp"
+
+#include "internal/DescriptorSet.hpp"
+
+#define TRANSIENT_POOL_MAX_SETS 256U
+#define TRANSIENT_POOL_DESCRIPTOR_COUNT 1024U
+
+namespace sa {
+
+	vk::DescriptorPool DescriptorPoolRing::createPool() {
+		std::array<vk::DescriptorPoolSize, 8> poolSizes = {
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampler, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, TRANSIENT_POOL_DESCRIPTOR_COUNT * 4 },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageImage, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eUniformTexelBuffer, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageTexelBuffer, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, TRANSIENT_POOL_DESCRIPTOR_COUNT },
+		};
+
+		vk::DescriptorPoolCreateInfo poolInfo{
+			.flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, // in case the layout contains a bindless table
+			.maxSets = TRANSIENT_POOL_MAX_SETS,
+		};
+		poolInfo.setPoolSizes(poolSizes);
+		return m_device.createDescriptorPool(poolInfo);
+	}
+
+	DescriptorPoolRing::DescriptorPoolRing()
+		: m_frameIndex(0)
+	{
+	}
+
+	void DescriptorPoolRing::create(vk::Device device, uint32_t frameCount) {
+		m_device = device;
+		m_frames.resize(frameCount);
+		m_frameIndex = 0;
+	}
+
+	void DescriptorPoolRing::destroy() {
+		for (auto& frame : m_frames) {
+			for (auto pool : frame.pools) {
+				m_device.destroyDescriptorPool(pool);
+			}
+		}
+		m_frames.clear();
+	}
+
+	void DescriptorPoolRing::beginFrame(uint32_t frameIndex) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_frameIndex = frameIndex % m_frames.size();
+		Frame& frame = m_frames[m_frameIndex];
+
+		for (ResourceID id : frame.descriptorSets) {
+			ResourceManager::Get().remove<DescriptorSet>(id);
+		}
+		frame.descriptorSets.clear();
+
+		for (auto pool : frame.pools) {
+			m_device.resetDescriptorPool(pool);
+		}
+		frame.currentPool = 0;
+	}
+
+	ResourceID DescriptorPoolRing::allocate(const DescriptorSetLayoutInfo& info, vk::DescriptorSetLayout layout, uint32_t setIndex) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Frame& frame = m_frames[m_frameIndex];
+
+		DescriptorSet descriptorSet;
+		while (true) {
+			if (frame.currentPool == frame.pools.size()) {
+				frame.pools.push_back(createPool());
+			}
+			try {
+				descriptorSet.create(m_device, frame.pools[frame.currentPool], 1, info, layout, setIndex, false, true);
+				break;
+			}
+			catch (const vk::OutOfPoolMemoryError&) {
+				frame.currentPool++;
+			}
+			catch (const vk::FragmentedPoolError&) {
+				frame.currentPool++;
+			}
+		}
+
+		ResourceID id = ResourceManager::Get().insert<DescriptorSet>(descriptorSet);
+		frame.descriptorSets.push_back(id);
+		return id;
+	}
+
+	uint32_t DescriptorPoolRing::getFrameIndex() const {
+		return m_frameIndex;
+	}
+
+}
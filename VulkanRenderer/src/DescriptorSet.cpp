@@ -2,10 +2,88 @@
 #include "internal/DescriptorSet.hpp"
 
 namespace sa {
+
+	std::atomic<uint64_t> DescriptorSet::s_resourceGeneration = 0;
+	std::unordered_map<uint64_t, uint64_t> DescriptorSet::s_destroyedHandles;
+	uint64_t DescriptorSet::s_forgottenGeneration = 0;
+	std::mutex DescriptorSet::s_destroyedHandlesMutex;
+
+	void DescriptorSet::OnHandleDestroyed(uint64_t handle) {
+		std::lock_guard<std::mutex> lock(s_destroyedHandlesMutex);
+		const uint64_t generation = ++s_resourceGeneration;
+		if (s_destroyedHandles.size() >= DESCRIPTOR_SET_MAX_DESTROYED_HANDLES) {
+			s_destroyedHandles.clear();
+			s_forgottenGeneration = generation;
+			return;
+		}
+		s_destroyedHandles[handle] = generation;
+	}
+
+	bool DescriptorSet::IsKeyValid(const std::vector<uint64_t>& key, uint64_t& validatedGeneration) {
+		const uint64_t generation = s_resourceGeneration.load();
+		if (validatedGeneration == generation)
+			return true;
+
+		std::lock_guard<std::mutex> lock(s_destroyedHandlesMutex);
+		if (validatedGeneration < s_forgottenGeneration)
+			return false;
+		// offsets and ranges are looked up too, a match only costs a redundant write
+		for (uint64_t value : key) {
+			auto it = s_destroyedHandles.find(value);
+			if (it != s_destroyedHandles.end() && it->second > validatedGeneration)
+				return false;
+		}
+		validatedGeneration = generation;
+		return true;
+	}
+
+	uint64_t DescriptorSet::GetResourceGeneration() {
+		return s_resourceGeneration.load();
+	}
+
+	void DescriptorSet::GetWriteKey(const vk::WriteDescriptorSet& write, std::vector<uint64_t>& key) {
+		key.push_back(write.dstArrayElement);
+		key.push_back(write.descriptorCount);
+
+		switch (write.descriptorType) {
+		case vk::DescriptorType::eSampler:
+		case vk::DescriptorType::eCombinedImageSampler:
+		case vk::DescriptorType::eSampledImage:
+		case vk::DescriptorType::eStorageImage:
+		case vk::DescriptorType::eInputAttachment:
+			if (!write.pImageInfo)
+				break;
+			for (uint32_t i = 0; i < write.descriptorCount; i++) {
+				key.push_back((uint64_t)(VkSampler)write.pImageInfo[i].sampler);
+				key.push_back((uint64_t)(VkImageView)write.pImageInfo[i].imageView);
+				key.push_back((uint64_t)write.pImageInfo[i].imageLayout);
+			}
+			break;
+		case vk::DescriptorType::eUniformTexelBuffer:
+		case vk::DescriptorType::eStorageTexelBuffer:
+			if (!write.pTexelBufferView)
+				break;
+			for (uint32_t i = 0; i < write.descriptorCount; i++) {
+				key.push_back((uint64_t)(VkBufferView)write.pTexelBufferView[i]);
+			}
+			break;
+		default:
+			if (!write.pBufferInfo)
+				break;
+			for (uint32_t i = 0; i < write.descriptorCount; i++) {
+				key.push_back((uint64_t)(VkBuffer)write.pBufferInfo[i].buffer);
+				key.push_back(write.pBufferInfo[i].offset);
+				key.push_back(write.pBufferInfo[i].range);
+			}
+			break;
+		}
+	}
 	
-	void DescriptorSet::create(vk::Device device, vk::DescriptorPool descriptorPool, uint32_t count, DescriptorSetLayoutInfo info, vk::DescriptorSetLayout layout, uint32_t setIndex) {
+	void DescriptorSet::create(vk::Device device, vk::DescriptorPool descriptorPool, uint32_t count, DescriptorSetLayoutInfo info, vk::DescriptorSetLayout layout, uint32_t setIndex, bool isCached, bool isTransient) {
 		m_device = device;
 		m_descriptorPool = descriptorPool;
+		m_isCached = isCached;
+		m_isTransient = isTransient;
 
 		std::vector<vk::DescriptorSetLayout> layouts(count, layout);
 		vk::DescriptorSetAllocateInfo allocInfo{
@@ -27,6 +105,8 @@ namespace sa {
 		}
 		
 		m_descriptorSets = m_device.allocateDescriptorSets(allocInfo);
+		m_writtenKeys.clear();
+		m_writtenKeys.resize(m_descriptorSets.size());
 
 		m_setIndex = setIndex;
 
@@ -43,30 +123,56 @@ namespace sa {
 
 	void DescriptorSet::update(uint32_t binding, uint32_t arrayIndex, uint32_t indexToUpdate) {
 		m_writes[binding].dstArrayElement = arrayIndex;
-		
+
+		// skip the write if the same resources are already bound and none of them were destroyed since
+		m_writeKey.clear();
+		GetWriteKey(m_writes[binding], m_writeKey);
+		const uint64_t generation = s_resourceGeneration.load();
+
 		if (indexToUpdate == UINT32_MAX) {
-			m_device.waitIdle();
 			std::vector<vk::WriteDescriptorSet> writes;
 			for (uint32_t i = 0; i < m_descriptorSets.size(); i++) {
+				WrittenKey& writtenKey = m_writtenKeys[i][binding];
+				if (writtenKey.key == m_writeKey && IsKeyValid(writtenKey.key, writtenKey.validatedGeneration))
+					continue;
+				writtenKey.key = m_writeKey;
+				writtenKey.validatedGeneration = generation;
 				m_writes[binding].dstSet = m_descriptorSets[i];
 				writes.push_back(m_writes[binding]);
 			}
+			if (writes.empty())
+				return;
+			m_device.waitIdle();
 			m_device.updateDescriptorSets(writes, nullptr);
 		}
 		else {
+			indexToUpdate = std::min(indexToUpdate, (uint32_t)m_descriptorSets.size() - 1);
+			WrittenKey& writtenKey = m_writtenKeys[indexToUpdate][binding];
+			if (writtenKey.key == m_writeKey && IsKeyValid(writtenKey.key, writtenKey.validatedGeneration))
+				return;
+			writtenKey.key = m_writeKey;
+			writtenKey.validatedGeneration = generation;
 			m_writes[binding].dstSet = m_descriptorSets[indexToUpdate];
 			m_device.updateDescriptorSets(m_writes[binding], nullptr);
 		}
 	}
 
 	void DescriptorSet::destroy() {
+		if (m_isTransient) {
+			// memory is reclaimed when the owning pool is reset
+			m_descriptorSets.clear();
+			m_writtenKeys.clear();
+			return;
+		}
 		if (!m_descriptorPool || m_descriptorSets.empty())
 			return;
-		m_device.waitIdle();
+		if (!m_isCached)
+			m_device.waitIdle();
 		m_device.freeDescriptorSets(m_descriptorPool, m_descriptorSets);
 			
 		m_descriptorPool = VK_NULL_HANDLE;
 		m_descriptorSets.clear();
+		m_writtenKeys.clear();
 	}
 
 	void DescriptorSet::update(uint32_t binding, vk::Buffer buffer, vk::DeviceSize bufferSize, vk::DeviceSize bufferOffset, vk::BufferView* pView, uint32_t indexToUpdate) {
@@ -173,6 +279,9 @@ namespace sa {
 	}
 
 	vk::DescriptorSet DescriptorSet::getSet(uint32_t index) const {
+		// cached sets only have one copy that is used for every frame
+		if (m_descriptorSets.size() == 1)
+			return m_descriptorSets[0];
 		return m_descriptorSets.at(index);
 	}
 
@@ -184,4 +293,12 @@ namespace sa {
 		return m_writes.at(binding).descriptorType;
 	}
 
+	bool DescriptorSet::isCached() const {
+		return m_isCached;
+	}
+
+	bool DescriptorSet::isTransient() const {
+		return m_isTransient;
+	}
+
 }
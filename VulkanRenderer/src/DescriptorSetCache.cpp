@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "internal/DescriptorSetCache.hpp"
+
+#include "internal/DescriptorSet.hpp"
+
+#define DESCRIPTOR_SET_CACHE_POOL_MAX_SETS 256U
+#define DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT 1024U
+
+namespace sa {
+
+	size_t DescriptorSetCache::KeyHash::operator()(const Key& key) const {
+		size_t seed = key.size();
+		for (uint64_t value : key) {
+			seed ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+		return seed;
+	}
+
+	vk::DescriptorPool DescriptorSetCache::createPool() {
+		std::array<vk::DescriptorPoolSize, 8> poolSizes = {
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampler, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT * 4 },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageImage, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eUniformTexelBuffer, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageTexelBuffer, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, DESCRIPTOR_SET_CACHE_POOL_DESCRIPTOR_COUNT },
+		};
+
+		vk::DescriptorPoolCreateInfo poolInfo{
+			.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet | vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, // in case the layout contains a bindless table
+			.maxSets = DESCRIPTOR_SET_CACHE_POOL_MAX_SETS,
+		};
+		poolInfo.setPoolSizes(poolSizes);
+		return m_device.createDescriptorPool(poolInfo);
+	}
+
+	DescriptorSet DescriptorSetCache::allocate(const DescriptorSetLayoutInfo& info, vk::DescriptorSetLayout layout, uint32_t setIndex) {
+		DescriptorSet descriptorSet;
+		// Sets are freed individually, so any of the pools may have room again
+		for (auto pool : m_pools) {
+			try {
+				descriptorSet.create(m_device, pool, 1, info, layout, setIndex, true);
+				return descriptorSet;
+			}
+			catch (const vk::OutOfPoolMemoryError&) {}
+			catch (const vk::FragmentedPoolError&) {}
+		}
+		m_pools.push_back(createPool());
+		descriptorSet.create(m_device, m_pools.back(), 1, info, layout, setIndex, true);
+		return descriptorSet;
+	}
+
+	DescriptorSetCache::DescriptorSetCache()
+		: m_frameCount(0)
+	{
+	}
+
+	void DescriptorSetCache::create(vk::Device device) {
+		m_device = device;
+		m_frameCount = 0;
+	}
+
+	void DescriptorSetCache::destroy() {
+		// The sets themselves are freed along with the pools
+		m_entries.clear();
+		m_retiredEntries.clear();
+		for (auto pool : m_pools) {
+			m_device.destroyDescriptorPool(pool);
+		}
+		m_pools.clear();
+	}
+
+	void DescriptorSetCache::beginFrame() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_frameCount++;
+
+		for (auto it = m_entries.begin(); it != m_entries.end();) {
+			if (it->second.lastUsedFrame + DESCRIPTOR_SET_CACHE_MAX_UNUSED_FRAMES > m_frameCount) {
+				++it;
+				continue;
+			}
+			m_retiredEntries.push_back(it->second);
+			it = m_entries.erase(it);
+		}
+
+		std::erase_if(m_retiredEntries, [&](const Entry& entry) {
+			if (entry.lastUsedFrame + DESCRIPTOR_SET_CACHE_MAX_UNUSED_FRAMES > m_frameCount)
+				return false;
+			ResourceManager::Get().remove<DescriptorSet>(entry.descriptorSet);
+			return true;
+		});
+	}
+
+	ResourceID DescriptorSetCache::get(const Key& key, const DescriptorSetLayoutInfo& info, vk::DescriptorSetLayout layout, uint32_t setIndex, const std::function<void(DescriptorSet&)>& write) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_entries.find(key);
+		if (it != m_entries.end()) {
+			// A destroyed resource may hand its handle value to a new one, so the set only matches if none of its handles were destroyed
+			if (DescriptorSet::IsKeyValid(it->first, it->second.validatedGeneration)) {
+				it->second.lastUsedFrame = m_frameCount;
+				return it->second.descriptorSet;
+			}
+			m_retiredEntries.push_back(it->second);
+			m_entries.erase(it);
+		}
+
+		const uint64_t generation = DescriptorSet::GetResourceGeneration();
+		DescriptorSet descriptorSet = allocate(info, layout, setIndex);
+		write(descriptorSet);
+		const ResourceID id = ResourceManager::Get().insert<DescriptorSet>(descriptorSet);
+		m_entries[key] = { id, m_frameCount, generation };
+		return id;
+	}
+
+}
@@ -20,6 +20,14 @@ namespace sa {
 		m_allocatorInfo.flags = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
 		vmaCreateAllocator(&m_allocatorInfo, &m_allocator);
+
+		auto memoryProperties = physicalDevice.getMemoryProperties();
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+			if (memoryProperties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated) {
+				m_hasLazilyAllocatedMemory = true;
+				break;
+			}
+		}
 	}
 
 	void DeviceMemoryManager::destroy() {
@@ -31,7 +39,10 @@ namespace sa {
 		}
 
 		for (auto& image : m_images) {
-			vmaDestroyImage(m_allocator, image->image, image->allocation);
+			if (image->isAliasing)
+				m_device.destroyImage(image->image);
+			else
+				vmaDestroyImage(m_allocator, image->image, image->allocation);
 			delete image;
 		}
 
@@ -64,6 +75,7 @@ namespace sa {
 
 		buffer->size = size;
 		buffer->mappedData = info.pMappedData;
+		m_allocationCount++;
 		if (buffer->mappedData != nullptr && initialData != nullptr) {
 			memcpy(buffer->mappedData, initialData, buffer->size);
 		}
@@ -121,12 +133,74 @@ namespace sa {
 			false
 		);
 		image->image = cimage;
+		m_allocationCount++;
 
 		m_memoryMutex.unlock();
 
 		return image;
 	}
 
+	VmaAllocation DeviceMemoryManager::allocateMemory(const vk::MemoryRequirements& requirements, VmaMemoryUsage memoryUsage, vk::MemoryPropertyFlags requiredMemoryProperties) {
+		m_memoryMutex.lock();
+
+		VmaAllocationCreateInfo allocInfo = {};
+		allocInfo.usage = memoryUsage;
+		allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		allocInfo.requiredFlags = (VkMemoryPropertyFlags)requiredMemoryProperties;
+
+		VkMemoryRequirements cRequirements = (VkMemoryRequirements)requirements;
+		VmaAllocation allocation = nullptr;
+		sa::checkError(
+			(vk::Result)vmaAllocateMemory(m_allocator, &cRequirements, &allocInfo, &allocation, nullptr),
+			"Failed to allocate memory of size " + std::to_string(requirements.size)
+		);
+		m_allocationCount++;
+
+		m_memoryMutex.unlock();
+		return allocation;
+	}
+
+	void DeviceMemoryManager::freeMemory(VmaAllocation allocation) {
+		m_memoryMutex.lock();
+		vmaFreeMemory(m_allocator, allocation);
+		m_memoryMutex.unlock();
+	}
+
+	vk::MemoryRequirements DeviceMemoryManager::getImageMemoryRequirements(const vk::ImageCreateInfo& info) const {
+		vk::DeviceImageMemoryRequirements requirementsInfo{
+			.pCreateInfo = &info,
+		};
+		return m_device.getImageMemoryRequirements(requirementsInfo).memoryRequirements;
+	}
+
+	DeviceImage* DeviceMemoryManager::createAliasingImage(VmaAllocation allocation, vk::DeviceSize offset, const vk::ImageCreateInfo& info) {
+		m_memoryMutex.lock();
+		m_images.push_back(new DeviceImage());
+		DeviceImage* image = m_images.back();
+		image->format = info.format;
+		image->layout = info.initialLayout;
+		image->sampleCount = info.samples;
+		image->extent = info.extent;
+		image->arrayLayers = info.arrayLayers;
+		image->imageType = info.imageType;
+		image->mipLevels = info.mipLevels;
+		image->sharingMode = info.sharingMode;
+		image->tiling = info.tiling;
+		image->usage = info.usage;
+		image->isAliasing = true;
+		image->allocation = allocation;
+
+		image->image = m_device.createImage(info);
+		sa::checkError(
+			(vk::Result)vmaBindImageMemory2(m_allocator, allocation, offset, image->image, nullptr),
+			"Failed to bind aliasing image memory",
+			false
+		);
+
+		m_memoryMutex.unlock();
+		return image;
+	}
+
 	void DeviceMemoryManager::destroyBuffer(DeviceBuffer* buffer) {
 		m_memoryMutex.lock();
 		vmaDestroyBuffer(m_allocator, buffer->buffer, buffer->allocation);
@@ -139,7 +213,10 @@ namespace sa {
 
 	void DeviceMemoryManager::destroyImage(DeviceImage* texture) {
 		m_memoryMutex.lock();
-		vmaDestroyImage(m_allocator, texture->image, texture->allocation);
+		if (texture->isAliasing)
+			m_device.destroyImage(texture->image);
+		else
+			vmaDestroyImage(m_allocator, texture->image, texture->allocation);
 		m_images.erase(std::find(m_images.begin(), m_images.end(), texture));
 		delete texture;
 		texture = nullptr;
@@ -151,6 +228,14 @@ namespace sa {
 		vmaSetCurrentFrameIndex(m_allocator, frameIndex);
 	}
 
+	size_t DeviceMemoryManager::getAllocationCount() const {
+		return m_allocationCount;
+	}
+
+	bool DeviceMemoryManager::hasLazilyAllocatedMemory() const {
+		return m_hasLazilyAllocatedMemory;
+	}
+
 	DeviceMemoryStats DeviceMemoryManager::getDeviceMemoryStats() const {
 		auto prop = m_physicalDevice.getMemoryProperties();
 		VmaBudget* budgets = new VmaBudget[prop.memoryHeapCount];
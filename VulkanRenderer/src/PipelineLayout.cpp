@@ -10,11 +10,34 @@
 
 #include <shaderc/shaderc.hpp>
 #include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <thread>
 
 #include "internal/RenderProgram.hpp"
 
 
 namespace sa {
+	DescriptorSetResources& DescriptorSetResources::bind(uint32_t binding, const Buffer& buffer) {
+		m_resources.push_back({ binding, &buffer, nullptr, NULL_RESOURCE });
+		return *this;
+	}
+
+	DescriptorSetResources& DescriptorSetResources::bind(uint32_t binding, const Texture& texture, ResourceID sampler) {
+		m_resources.push_back({ binding, nullptr, &texture, sampler });
+		return *this;
+	}
+
+	DescriptorSetResources& DescriptorSetResources::bind(uint32_t binding, const Texture& texture) {
+		m_resources.push_back({ binding, nullptr, &texture, NULL_RESOURCE });
+		return *this;
+	}
+
+	DescriptorSetResources& DescriptorSetResources::bind(uint32_t binding, ResourceID sampler) {
+		m_resources.push_back({ binding, nullptr, nullptr, sampler });
+		return *this;
+	}
+
 	DescriptorSetFactory::DescriptorSetFactory(PipelineLayout* pLayout, uint32_t setIndex)
 		: m_playout(pLayout)
 		, m_setIndex(setIndex)
@@ -340,7 +363,107 @@ namespace sa {
 		};
 	};
 
-	std::vector<uint32_t> CompileGLSLFromFile(const char* glslPath, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory) {
+#define SHADER_CACHE_VERSION 1U
+#define SPIRV_MAGIC_NUMBER 0x07230203U
+
+	namespace {
+		std::mutex s_shaderCacheMutex;
+		std::string s_shaderCacheDirectory;
+		std::unordered_map<uint64_t, std::vector<uint32_t>> s_shaderCache;
+
+		// FNV-1a
+		void HashBytes(uint64_t& hash, const void* data, size_t size) {
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < size; i++) {
+				hash ^= bytes[i];
+				hash *= 0x100000001b3ULL;
+			}
+		}
+
+		template<typename T>
+		void HashValue(uint64_t& hash, const T& value) {
+			HashBytes(hash, &value, sizeof(T));
+		}
+
+		void HashString(uint64_t& hash, const std::string& str) {
+			HashValue(hash, str.size());
+			HashBytes(hash, str.data(), str.size());
+		}
+
+		std::filesystem::path GetShaderCachePath(const std::string& directory, uint64_t key) {
+			std::stringstream ss;
+			ss << std::hex << std::setw(16) << std::setfill('0') << key << ".spv";
+			return std::filesystem::path(directory) / ss.str();
+		}
+
+		bool FindCachedShader(uint64_t key, std::vector<uint32_t>& outCode) {
+			std::string directory;
+			{
+				std::lock_guard<std::mutex> lock(s_shaderCacheMutex);
+				auto it = s_shaderCache.find(key);
+				if (it != s_shaderCache.end()) {
+					outCode = it->second;
+					return true;
+				}
+				directory = s_shaderCacheDirectory;
+			}
+			if (directory.empty())
+				return false;
+
+			std::filesystem::path path = GetShaderCachePath(directory, key);
+			if (!std::filesystem::exists(path))
+				return false;
+
+			std::vector<uint32_t> code = ReadSPVFile(path.generic_string().c_str());
+			if (code.empty() || code[0] != SPIRV_MAGIC_NUMBER) {
+				SA_DEBUG_LOG_WARNING("Ignoring invalid cached shader ", path.generic_string());
+				return false;
+			}
+
+			std::lock_guard<std::mutex> lock(s_shaderCacheMutex);
+			s_shaderCache[key] = code;
+			outCode = std::move(code);
+			return true;
+		}
+
+		void StoreCachedShader(uint64_t key, const std::vector<uint32_t>& code) {
+			std::string directory;
+			{
+				std::lock_guard<std::mutex> lock(s_shaderCacheMutex);
+				s_shaderCache[key] = code;
+				directory = s_shaderCacheDirectory;
+			}
+			if (directory.empty())
+				return;
+
+			std::error_code ec;
+			std::filesystem::create_directories(directory, ec);
+			
+			// unique temp file per thread, renamed into place so readers never see a partial file
+			std::filesystem::path path = GetShaderCachePath(directory, key);
+			std::filesystem::path tempPath = path;
+			tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open()) {
+					SA_DEBUG_LOG_WARNING("Failed to write shader cache file ", tempPath.generic_string());
+					return;
+				}
+				file.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(uint32_t));
+			}
+			std::filesystem::rename(tempPath, path, ec);
+			if (ec) {
+				std::filesystem::remove(tempPath, ec);
+			}
+		}
+	}
+
+	void SetShaderCacheDirectory(const char* directory) {
+		std::lock_guard<std::mutex> lock(s_shaderCacheMutex);
+		s_shaderCacheDirectory = directory;
+	}
+
+	std::vector<uint32_t> CompileGLSLFromFile(const char* glslPath, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory, const std::vector<ShaderDefine>& defines) {
 		std::ifstream file(glslPath, std::ios::in);
 		if (!file.is_open()) {
 			throw std::runtime_error("Failed to open file " + std::string(glslPath));
@@ -357,25 +480,53 @@ namespace sa {
 
 		file.close();
 
-		return CompileGLSLFromMemory(buffer.c_str(), shaderStage, entryPointName, additionalIncludeDirectory, glslPath);
+		// includes are resolved relative to the tag, so it has to be absolute to not depend on the working directory
+		std::string tag = std::filesystem::absolute(glslPath).generic_string();
+		return CompileGLSLFromMemory(buffer.c_str(), shaderStage, entryPointName, additionalIncludeDirectory, tag.c_str(), defines);
 	}
 
-	std::vector<uint32_t> CompileGLSLFromMemory(const char* glslCode, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory, const char* tag) {
+	std::vector<uint32_t> CompileGLSLFromMemory(const char* glslCode, ShaderStageFlagBits shaderStage, const char* entryPointName, const char* additionalIncludeDirectory, const char* tag, const std::vector<ShaderDefine>& defines) {
 		shaderc::CompileOptions options;
 		options.SetAutoBindUniforms(true);
 		options.SetAutoMapLocations(true);
 		options.SetTargetEnvironment(shaderc_target_env_vulkan, SA_VK_API_VERSION);
 		options.SetIncluder(std::make_unique<ShaderIncluder>(additionalIncludeDirectory));
+		for (const auto& define : defines) {
+			options.AddMacroDefinition(define.name, define.value);
+		}
 
 		shaderc::Compiler compiler;
+		shaderc::PreprocessedSourceCompilationResult preprocessed = compiler.PreprocessGlsl(glslCode, ToShadercKind(shaderStage), tag, options);
+		if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+			throw std::runtime_error("Failed to preprocess GLSL code: " + preprocessed.GetErrorMessage());
+		}
+		// the preprocessed code has every include inlined, so any change in an included file changes the key
+		std::string preprocessedCode(preprocessed.begin(), preprocessed.end());
+
+		uint64_t key = 0xcbf29ce484222325ULL;
+		HashValue(key, SHADER_CACHE_VERSION);
+		HashString(key, preprocessedCode);
+		HashValue(key, shaderStage);
+		HashString(key, entryPointName);
+		HashValue(key, (uint32_t)SA_VK_API_VERSION);
+		for (const auto& define : defines) {
+			HashString(key, define.name);
+			HashString(key, define.value);
+		}
+
+		std::vector<uint32_t> output;
+		if (FindCachedShader(key, output)) {
+			return std::move(output);
+		}
+
 		shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(glslCode, ToShadercKind(shaderStage), tag, entryPointName, options);
 
 		if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
 			throw std::runtime_error("Failed to compile GLSL code: " + result.GetErrorMessage());
 		}
 
-		std::vector<uint32_t> output;
 		std::copy(result.begin(), result.end(), std::back_inserter(output));
+		StoreCachedShader(key, output);
 		return std::move(output);
 	}
 
@@ -466,7 +617,9 @@ namespace sa {
 	void PipelineLayout::createDescriptorPoolAndLayouts() {
 		std::set<vk::DescriptorType> descriptorTypes;
 		std::vector<vk::DescriptorPoolSize> poolSizes;
+		bool poolUpdateAfterBind = false;
 		for (auto& [set, info] : m_descriptorSetLayoutInfos) {
+			bool updateAfterBind = false;
 
 
 
@@ -487,6 +640,13 @@ namespace sa {
 					// to support variable descriptor counts
 					layoutBindings[i].descriptorCount = MAX_VARIABLE_DESCRIPTOR_COUNT;
 					flags[i] = vk::DescriptorBindingFlagBits::eVariableDescriptorCount | vk::DescriptorBindingFlagBits::ePartiallyBound;
+					if ((vk::DescriptorType)info.bindings[i].type == vk::DescriptorType::eSampledImage ||
+						(vk::DescriptorType)info.bindings[i].type == vk::DescriptorType::eCombinedImageSampler) 
+					{
+						// bindless texture tables can be written while frames using other slots are in flight
+						flags[i] |= vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+						updateAfterBind = true;
+					}
 					auto it = std::max_element(info.bindings.begin(), info.bindings.end(), [](const auto& highest, const auto& next) { return highest.binding < next.binding; });
 					if (info.bindings[i].binding != it->binding) {
 						throw std::runtime_error("Variable count descriptors has to be on the last binding");
@@ -501,6 +661,10 @@ namespace sa {
 			flagCreateInfo.setBindingFlags(flags);
 			
 			vk::DescriptorSetLayoutCreateInfo layoutInfo;
+			if (updateAfterBind) {
+				layoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+				poolUpdateAfterBind = true;
+			}
 			layoutInfo.setPNext(&flagCreateInfo);
 			layoutInfo.setBindings(layoutBindings);
 
@@ -523,6 +687,8 @@ namespace sa {
 				.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
 					.maxSets = UINT16_MAX,
 			};
+			if (poolUpdateAfterBind)
+				poolInfo.flags |= vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
 			poolInfo.setPoolSizes(poolSizes);
 			m_descriptorPool = ResourceManager::Get().insert<vk::DescriptorPool>(m_pCore->getDevice().createDescriptorPool(poolInfo));
 		}
@@ -589,6 +755,7 @@ namespace sa {
 	}
 
 	void PipelineLayout::create() {
+		createDescriptorPoolAndLayouts();
 		createPipelineLayout();
 	}
 
@@ -756,6 +923,83 @@ namespace sa {
 		return id;
 	}
 
+	ResourceID PipelineLayout::allocateTransientDescriptorSet(uint32_t setIndex) {
+		if (!m_descriptorSetLayouts.count(setIndex)) {
+			throw std::runtime_error("Invalid set index!");
+		}
+
+		vk::DescriptorSetLayout* pLayout = ResourceManager::Get().get<vk::DescriptorSetLayout>(m_descriptorSetLayouts.at(setIndex));
+		if (!pLayout) {
+			SA_DEBUG_LOG_ERROR("Invalid descriptor layout ID", m_descriptorSetLayouts.at(setIndex));
+			throw std::runtime_error("Invalid descriptor layout ID!");
+		}
+
+		return m_pCore->getTransientDescriptorPools().allocate(m_descriptorSetLayoutInfos.at(setIndex), *pLayout, setIndex);
+	}
+
+	ResourceID PipelineLayout::getCachedDescriptorSet(uint32_t setIndex, const DescriptorSetResources& resources) {
+		if (!m_descriptorSetLayouts.count(setIndex)) {
+			throw std::runtime_error("Invalid set index!");
+		}
+
+		vk::DescriptorSetLayout* pLayout = ResourceManager::Get().get<vk::DescriptorSetLayout>(m_descriptorSetLayouts.at(setIndex));
+		if (!pLayout) {
+			SA_DEBUG_LOG_ERROR("Invalid descriptor layout ID", m_descriptorSetLayouts.at(setIndex));
+			throw std::runtime_error("Invalid descriptor layout ID!");
+		}
+
+		// Resolve every resource to the handles a write would reference
+		struct ResolvedResource {
+			uint32_t binding;
+			vk::Buffer buffer;
+			vk::DeviceSize size;
+			vk::BufferView* pBufferView;
+			vk::ImageView imageView;
+			vk::ImageLayout imageLayout;
+			vk::Sampler* pSampler;
+		};
+		std::vector<ResolvedResource> resolved;
+		resolved.reserve(resources.m_resources.size());
+
+		DescriptorSetCache::Key key;
+		key.push_back((uint64_t)(VkDescriptorSetLayout)*pLayout);
+		for (const auto& resource : resources.m_resources) {
+			ResolvedResource& r = resolved.emplace_back(ResolvedResource{ resource.binding });
+			if (resource.pBuffer) {
+				const DeviceBuffer* pDeviceBuffer = (const DeviceBuffer*)*resource.pBuffer;
+				r.buffer = pDeviceBuffer->buffer;
+				r.size = pDeviceBuffer->size;
+				if (resource.pBuffer->getType() == BufferType::UNIFORM_TEXEL || resource.pBuffer->getType() == BufferType::STORAGE_TEXEL)
+					r.pBufferView = resource.pBuffer->getView();
+			}
+			if (resource.pTexture) {
+				r.imageView = *resource.pTexture->getView();
+				r.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+				if ((resource.pTexture->getUsageFlags() & TextureUsageFlagBits::STORAGE) == TextureUsageFlagBits::STORAGE)
+					r.imageLayout = vk::ImageLayout::eGeneral;
+			}
+			if (resource.sampler != NULL_RESOURCE)
+				r.pSampler = ResourceManager::Get().get<vk::Sampler>(resource.sampler);
+
+			key.push_back(r.binding);
+			key.push_back((uint64_t)(VkBuffer)r.buffer);
+			key.push_back(r.size);
+			key.push_back(r.pBufferView ? (uint64_t)(VkBufferView)*r.pBufferView : 0);
+			key.push_back((uint64_t)(VkImageView)r.imageView);
+			key.push_back((uint64_t)r.imageLayout);
+			key.push_back(r.pSampler ? (uint64_t)(VkSampler)*r.pSampler : 0);
+		}
+
+		return m_pCore->getDescriptorSetCache().get(key, m_descriptorSetLayoutInfos.at(setIndex), *pLayout, setIndex, [&](DescriptorSet& descriptorSet) {
+			for (const auto& r : resolved) {
+				if (r.buffer)
+					descriptorSet.update(r.binding, r.buffer, r.size, 0, r.pBufferView, 0);
+				else
+					descriptorSet.update(r.binding, r.imageView, r.imageLayout, r.pSampler, 0);
+			}
+		});
+	}
+
 	bool PipelineLayout::hasAllocatedDescriptorSet(ResourceID descriptorSet) {
 		return m_allocatedDescriptorSets.contains(descriptorSet);
 	}
@@ -152,6 +152,18 @@ namespace sa {
 		m_pCommandBufferSet->getBuffer().executeCommands(context.m_pCommandBufferSet->getBuffer(m_pCommandBufferSet->getBufferIndex()));
 	}
 
+	uint32_t RenderContext::beginGpuScope(const char* name) const {
+		if (!m_pCore)
+			return UINT32_MAX;
+		return m_pCore->getTimestampQueryPool().beginScope(m_pCommandBufferSet->getBuffer(), name);
+	}
+
+	void RenderContext::endGpuScope(uint32_t scope) const {
+		if (!m_pCore)
+			return;
+		m_pCore->getTimestampQueryPool().endScope(m_pCommandBufferSet->getBuffer(), scope);
+	}
+
 	void RenderContext::bindPipelineLayout(const PipelineLayout& pipelineLayout) {
 		m_pLastPipelineLayout = const_cast<PipelineLayout*>(&pipelineLayout);
 	}
@@ -755,6 +767,103 @@ namespace sa {
 			nullptr);
 	}
 
+	void RenderContext::barriers(const std::vector<TextureBarrier>& textureBarriers, const std::vector<BufferBarrier>& bufferBarriers) const {
+		if (textureBarriers.empty() && bufferBarriers.empty())
+			return;
+
+		vk::PipelineStageFlags srcStages;
+		vk::PipelineStageFlags dstStages;
+
+		std::vector<vk::ImageMemoryBarrier> imageMemoryBarriers;
+		imageMemoryBarriers.reserve(textureBarriers.size());
+		for (const auto& textureBarrier : textureBarriers) {
+			const ImageView& imageView = textureBarrier.pTexture->getView();
+			const DeviceImage* pImage = imageView.getImage();
+
+			vk::AccessFlags srcAccess;
+			vk::AccessFlags dstAccess;
+			vk::PipelineStageFlags srcStage;
+			vk::PipelineStageFlags dstStage;
+			vk::ImageLayout oldLayout = vk::ImageLayout::eUndefined;
+			vk::ImageLayout newLayout = vk::ImageLayout::eUndefined;
+
+			VulkanCore::GetTransitionInfo(textureBarrier.src, &srcStage, &srcAccess, &oldLayout);
+			VulkanCore::GetTransitionInfo(textureBarrier.dst, &dstStage, &dstAccess, &newLayout);
+			srcStages |= srcStage;
+			dstStages |= dstStage;
+
+			vk::Format vkFormat = static_cast<vk::Format>(imageView.getFormat());
+
+			vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eColor;
+			if (VulkanCore::IsDepthFormat(vkFormat)) {
+				aspectFlags = vk::ImageAspectFlagBits::eDepth;
+				if (VulkanCore::HasStencilComponent(vkFormat)) {
+					aspectFlags |= vk::ImageAspectFlagBits::eStencil;
+				}
+			}
+
+			const bool isStorage = (textureBarrier.pTexture->getUsageFlags() & sa::TextureUsageFlagBits::STORAGE) == sa::TextureUsageFlagBits::STORAGE;
+			if (oldLayout == vk::ImageLayout::eShaderReadOnlyOptimal && isStorage) {
+				oldLayout = vk::ImageLayout::eGeneral;
+			}
+			if (newLayout == vk::ImageLayout::eShaderReadOnlyOptimal && isStorage) {
+				newLayout = vk::ImageLayout::eGeneral;
+			}
+
+			imageMemoryBarriers.push_back({
+				.srcAccessMask = srcAccess,
+				.dstAccessMask = dstAccess,
+				.oldLayout = oldLayout,
+				.newLayout = newLayout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = pImage->image,
+				.subresourceRange{
+					.aspectMask = aspectFlags,
+					.baseMipLevel = imageView.getBaseMipLevel(),
+					.levelCount = imageView.getMipLevelCount(),
+					.baseArrayLayer = imageView.getBaseArrayLayer(),
+					.layerCount = imageView.getArrayLayerCount(),
+				},
+			});
+		}
+
+		std::vector<vk::BufferMemoryBarrier> bufferMemoryBarriers;
+		bufferMemoryBarriers.reserve(bufferBarriers.size());
+		for (const auto& bufferBarrier : bufferBarriers) {
+			const DeviceBuffer* pBuffer = *bufferBarrier.pBuffer;
+
+			vk::AccessFlags srcAccess;
+			vk::AccessFlags dstAccess;
+			vk::PipelineStageFlags srcStage;
+			vk::PipelineStageFlags dstStage;
+			vk::ImageLayout tmpLayout;
+
+			VulkanCore::GetTransitionInfo(bufferBarrier.src, &srcStage, &srcAccess, &tmpLayout);
+			VulkanCore::GetTransitionInfo(bufferBarrier.dst, &dstStage, &dstAccess, &tmpLayout);
+			srcStages |= srcStage;
+			dstStages |= dstStage;
+
+			bufferMemoryBarriers.push_back({
+				.srcAccessMask = srcAccess,
+				.dstAccessMask = dstAccess,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = pBuffer->buffer,
+				.offset = 0,
+				.size = pBuffer->size,
+			});
+		}
+
+		m_pCommandBufferSet->getBuffer().pipelineBarrier(
+			srcStages,
+			dstStages,
+			(vk::DependencyFlags)0,
+			nullptr,
+			bufferMemoryBarriers,
+			imageMemoryBarriers);
+	}
+
 	void RenderContext::fullBarrier() const {
 		vk::PipelineStageFlags srcStage = vk::PipelineStageFlagBits::eAllCommands;
 		vk::PipelineStageFlags dstStage = vk::PipelineStageFlagBits::eAllCommands;
@@ -867,6 +976,30 @@ namespace sa {
 		m_pCommandBufferSet->begin((vk::CommandBufferUsageFlags)usageFlags, &inheritInfo);
 	}
 
+	void SubContext::begin(const RenderContext& parentContext, ResourceID framebuffer, ContextUsageFlags usageFlags) {
+		m_pCommandBufferSet->setBufferIndex(parentContext.getFrameIndex());
+		
+		vk::Framebuffer inheritedFramebuffer = VK_NULL_HANDLE;
+		if (framebuffer != NULL_RESOURCE) {
+			FramebufferSet* pFramebufferSet = GetFramebufferSet(framebuffer);
+			uint32_t framebufferIndex = m_pCommandBufferSet->getBufferIndex() % pFramebufferSet->getBufferCount();
+			Swapchain* pSwapchain = pFramebufferSet->getSwapchain();
+			if (pSwapchain) {
+				framebufferIndex = pSwapchain->getImageIndex();
+			}
+			inheritedFramebuffer = pFramebufferSet->getBuffer(framebufferIndex);
+		}
+
+		vk::CommandBufferInheritanceInfo inheritInfo{
+			.renderPass = m_pRenderProgram ? m_pRenderProgram->getRenderPass() : VK_NULL_HANDLE,
+			.subpass = m_subpassIndex,
+			.framebuffer = inheritedFramebuffer,
+			.occlusionQueryEnable = VK_FALSE,
+		};
+
+		m_pCommandBufferSet->begin((vk::CommandBufferUsageFlags)usageFlags, &inheritInfo);
+	}
+
 	void SubContext::end() {
 		m_pCommandBufferSet->end();
 	}
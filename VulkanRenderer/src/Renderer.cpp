@@ -51,12 +51,12 @@ namespace sa {
 			ResourceManager::Get().setCleanupFunction<vk::Pipeline>([&](vk::Pipeline* p) { m_pCore->getDevice().destroyPipeline(*p); });
 			ResourceManager::Get().setCleanupFunction<vk::PipelineLayout>([&](vk::PipelineLayout* p) { m_pCore->getDevice().destroyPipelineLayout(*p); });
 			ResourceManager::Get().setCleanupFunction<vk::ShaderModule>([&](vk::ShaderModule* p) { m_pCore->getDevice().destroyShaderModule(*p); });
-			ResourceManager::Get().setCleanupFunction<vk::DescriptorSetLayout>([&](vk::DescriptorSetLayout* p) { m_pCore->getDevice().destroyDescriptorSetLayout(*p); });
+			ResourceManager::Get().setCleanupFunction<vk::DescriptorSetLayout>([&](vk::DescriptorSetLayout* p) { m_pCore->getDevice().destroyDescriptorSetLayout(*p); DescriptorSet::OnHandleDestroyed((uint64_t)(VkDescriptorSetLayout)*p); });
 			ResourceManager::Get().setCleanupFunction<vk::DescriptorPool>([&](vk::DescriptorPool* p) { m_pCore->getDevice().destroyDescriptorPool(*p); });
 			ResourceManager::Get().setCleanupFunction<DescriptorSet>([](DescriptorSet* p) { p->destroy(); });
-			ResourceManager::Get().setCleanupFunction<vk::Sampler>([&](vk::Sampler* p) { m_pCore->getDevice().destroySampler(*p); });
-			ResourceManager::Get().setCleanupFunction<vk::ImageView>([&](vk::ImageView* p) { m_pCore->getDevice().destroyImageView(*p); });
-			ResourceManager::Get().setCleanupFunction<vk::BufferView>([&](vk::BufferView* p) { m_pCore->getDevice().destroyBufferView(*p); });
+			ResourceManager::Get().setCleanupFunction<vk::Sampler>([&](vk::Sampler* p) { m_pCore->getDevice().destroySampler(*p); DescriptorSet::OnHandleDestroyed((uint64_t)(VkSampler)*p); });
+			ResourceManager::Get().setCleanupFunction<vk::ImageView>([&](vk::ImageView* p) { m_pCore->getDevice().destroyImageView(*p); DescriptorSet::OnHandleDestroyed((uint64_t)(VkImageView)*p); });
+			ResourceManager::Get().setCleanupFunction<vk::BufferView>([&](vk::BufferView* p) { m_pCore->getDevice().destroyBufferView(*p); DescriptorSet::OnHandleDestroyed((uint64_t)(VkBufferView)*p); });
 			ResourceManager::Get().setCleanupFunction<CommandPool>([](CommandPool* p) { p->destroy(); });
 
 
@@ -66,6 +66,16 @@ namespace sa {
 		}
 	}
 
+	void Renderer::onPipelineCreated() {
+		m_lastPipelineCreation = std::chrono::steady_clock::now().time_since_epoch().count();
+		m_hasUnsavedPipelines = true;
+	}
+
+	void Renderer::savePipelineCache() {
+		m_hasUnsavedPipelines = false;
+		m_pCore->savePipelineCache();
+	}
+
 	Renderer& Renderer::Get() {
 		static Renderer instance;
 		return instance;
@@ -320,7 +330,8 @@ namespace sa {
 		createInfo.basePipelineHandle = VK_NULL_HANDLE;
 		createInfo.basePipelineIndex = 0;
 
-		const auto pipeline = m_pCore->getDevice().createComputePipeline(VK_NULL_HANDLE, createInfo);
+		const auto pipeline = m_pCore->getDevice().createComputePipeline(m_pCore->getPipelineCache(), createInfo);
+		onPipelineCreated();
 		return ResourceManager::Get().insert(pipeline.value);
 	}
 
@@ -381,9 +392,10 @@ namespace sa {
 			{ extent.width, extent.height },
 			vk_shaderStageInfos,
 			vertexInput,
-			nullptr,
+			m_pCore->getPipelineCache(),
 			config
 		);
+		onPipelineCreated();
 		return ResourceManager::Get().insert(vkPipeline);
 	}
 
@@ -484,6 +496,19 @@ namespace sa {
 		pDescriptorSet->update(binding, firstElement, textures, textureCount, nullptr, UINT32_MAX);
 	}
 
+	void Renderer::updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, const DynamicTexture* textures, uint32_t textureCount, uint32_t firstElement) {
+		if (textureCount == 0)
+			return;
+		DescriptorSet* pDescriptorSet = RenderContext::GetDescriptorSet(descriptorSet);
+		std::vector<Texture> frameTextures(textureCount);
+		for (uint32_t i = 0; i < textures[0].getTextureCount(); i++) {
+			for (uint32_t j = 0; j < textureCount; j++) {
+				frameTextures[j] = textures[j].getTexture(i);
+			}
+			pDescriptorSet->update(binding, firstElement, frameTextures.data(), textureCount, nullptr, i);
+		}
+	}
+
 
 	void Renderer::updateDescriptorSet(ResourceID descriptorSet, uint32_t binding, ResourceID sampler) {
 		DescriptorSet* pDescriptorSet = RenderContext::GetDescriptorSet(descriptorSet);
@@ -495,10 +520,35 @@ namespace sa {
 		ResourceManager::Get().remove<DescriptorSet>(descriptorSet);
 	}
 
+	void Renderer::allocateTransientTextures(const TransientTextureRequest* pRequests, uint32_t count, const TransientTexture** ppTextures) {
+		std::vector<TransientTextureRequest> requests(pRequests, pRequests + count);
+		for (auto& request : requests) {
+			TransientTextureDesc& desc = request.desc;
+			desc.extent = { std::max(desc.extent.width, 1U), std::max(desc.extent.height, 1U) };
+			desc.mipLevels = std::min(desc.mipLevels, (uint32_t)floor(log2(std::max(desc.extent.width, desc.extent.height))) + 1);
+			if (desc.format == Format::UNDEFINED) {
+				desc.format = (desc.usage & TextureUsageFlagBits::DEPTH_ATTACHMENT) ? getDefaultDepthFormat() : selectFormat(desc.usage);
+			}
+		}
+		m_pCore->getTransientTexturePool().allocate(requests.data(), count, ppTextures);
+	}
+
 	DeviceMemoryStats Renderer::getGPUMemoryUsage() const {
 		return std::move(m_pCore->getGPUMemoryUsage());
 	}
+
+	const GpuFrameTimestamps& Renderer::getGpuTimestamps() const {
+		return m_pCore->getTimestampQueryPool().getLastResults();
+	}
 	
+	DeviceActivityCounters Renderer::getDeviceActivityCounters() const {
+		DeviceActivityCounters counters = {};
+		counters.allocationCount = m_pCore->getAllocationCount();
+		counters.uploadCount = m_uploadCount;
+		counters.uploadBytes = m_uploadBytes;
+		return counters;
+	}
+
 	DataTransfer* Renderer::queueTransfer(const DataTransfer& transfer) {
 		const std::lock_guard<std::mutex> lock(m_transferMutex);
 		return &m_transferQueue.emplace_back(transfer);
@@ -563,6 +613,19 @@ namespace sa {
 		}
 
 		m_pCore->setMemoryManagerFrameIndex(pSwapchain->getFrameIndex());
+		m_pCore->getTransientDescriptorPools().beginFrame(pSwapchain->getFrameIndex());
+		m_pCore->getDescriptorSetCache().beginFrame();
+		m_pCore->getTimestampQueryPool().beginFrame(pCommandBufferSet->getBuffer(), pSwapchain->getFrameIndex());
+		m_pCore->getTransientTexturePool().beginFrame(pSwapchain->getFrameIndex());
+
+		if (m_hasUnsavedPipelines) {
+			const std::chrono::steady_clock::time_point lastCreation{ std::chrono::steady_clock::duration(m_lastPipelineCreation.load()) };
+			if (std::chrono::steady_clock::now() - lastCreation > std::chrono::seconds(PIPELINE_CACHE_SAVE_DELAY_SECONDS)
+				&& m_pCore->savePipelineCacheAsync())
+			{
+				m_hasUnsavedPipelines = false;
+			}
+		}
 
 		m_transferMutex.lock();
 		while (!m_transferQueue.empty()) {
@@ -588,6 +651,8 @@ namespace sa {
 					vk::AccessFlagBits::eShaderRead,
 					vk::PipelineStageFlagBits::eFragmentShader);
 				transfer.dstImage->layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+				m_uploadCount++;
+				m_uploadBytes += transfer.srcBuffer->size;
 				break;
 			}
 			case DataTransfer::Type::BUFFER_TO_BUFFER:
@@ -610,6 +675,7 @@ namespace sa {
 
 	void Renderer::endFrame(ResourceID swapchain) {
 		Swapchain* pSwapchain = RenderContext::GetSwapchain(swapchain);
+		m_pCore->getTimestampQueryPool().endFrame(pSwapchain->getCommandBufferSet()->getBuffer());
 		pSwapchain->endFrame();
 	}
 
@@ -619,12 +685,17 @@ namespace sa {
 		return id;
 	}
 
+	void Renderer::destroyContextPool(ResourceID contextPool) {
+		ResourceManager::Get().remove<CommandPool>(contextPool);
+	}
+
 	DirectContext Renderer::createDirectContext(ResourceID contextPool) {
 		return DirectContext(m_pCore.get(), contextPool);
 	}
 
 	SubContext Renderer::createSubContext(ResourceID framebuffer, ResourceID renderProgram, uint32_t subpassIndex, ResourceID contextPool) {
-		FramebufferSet* pFramebufferSet = RenderContext::GetFramebufferSet(framebuffer);
+		// framebuffer may be NULL_RESOURCE when it is only known at record time, see SubContext::begin
+		FramebufferSet* pFramebufferSet = framebuffer != NULL_RESOURCE ? RenderContext::GetFramebufferSet(framebuffer) : nullptr;
 		RenderProgram* pRenderProgram = RenderContext::GetRenderProgram(renderProgram);
 		
 		return SubContext(m_pCore.get(), pFramebufferSet, pRenderProgram, subpassIndex, contextPool);
@@ -89,6 +89,13 @@ namespace sa {
 
 	}
 
+	void Texture::create(DeviceImage* pImage, TextureType type, TextureUsageFlags usageFlags) {
+		m_usage = usageFlags;
+		m_type = type;
+		m_pImage = pImage;
+		m_view = createImageView(type, pImage->mipLevels, 0, pImage->arrayLayers, 0);
+	}
+
 	void Texture::create2D(TextureUsageFlags usageFlags, Extent extent, Format format, uint32_t mipLevels, uint32_t arrayLayers, uint32_t samples) {
 		create2D((arrayLayers > 1) ? TextureType::TEXTURE_TYPE_2D_ARRAY : TextureType::TEXTURE_TYPE_2D, usageFlags, extent, format, mipLevels, arrayLayers, samples, 0);
 	}
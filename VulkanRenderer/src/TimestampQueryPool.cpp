@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "internal/TimestampQueryPool.hpp"
+
+namespace sa {
+
+	void TimestampQueryPool::resolve(Frame& frame) {
+		frame.isPending = false;
+		const uint32_t queryCount = static_cast<uint32_t>(frame.scopeNames.size()) * 2;
+		if (queryCount == 0)
+			return;
+
+		// value and availability per query
+		std::vector<uint64_t> data(queryCount * 2);
+		vk::Result result = m_device.getQueryPoolResults(
+			frame.queryPool,
+			0,
+			queryCount,
+			data.size() * sizeof(uint64_t),
+			data.data(),
+			sizeof(uint64_t) * 2,
+			vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+		if (result != vk::Result::eSuccess && result != vk::Result::eNotReady)
+			return;
+
+		auto isAvailable = [&](uint32_t query) { return data[query * 2 + 1] != 0; };
+		auto ticksToMs = [&](uint64_t begin, uint64_t end) { return static_cast<double>((end - begin) & m_timestampMask) * m_timestampPeriod / 1000000.0; };
+
+		// scope 0 always spans the whole frame
+		if (!isAvailable(0) || !isAvailable(1))
+			return;
+		const uint64_t frameBegin = data[0];
+
+		m_lastResults.frameTimeMs = ticksToMs(frameBegin, data[2]);
+		m_lastResults.cpuBeginTime = frame.cpuBeginTime;
+		m_lastResults.scopes.clear();
+		for (uint32_t i = 1; i < frame.scopeNames.size(); i++) {
+			const uint32_t beginQuery = i * 2;
+			const uint32_t endQuery = beginQuery + 1;
+			if (!isAvailable(beginQuery) || !isAvailable(endQuery))
+				continue;
+
+			m_lastResults.scopes.push_back(GpuTimestampScope{
+				.name = frame.scopeNames[i],
+				.beginMs = ticksToMs(frameBegin, data[beginQuery * 2]),
+				.durationMs = ticksToMs(data[beginQuery * 2], data[endQuery * 2]),
+				.depth = frame.scopeDepths[i],
+			});
+		}
+	}
+
+	TimestampQueryPool::TimestampQueryPool()
+		: m_frameIndex(0)
+		, m_maxScopes(0)
+		, m_depth(0)
+		, m_isRecording(false)
+		, m_timestampPeriod(0.0)
+		, m_timestampMask(0)
+	{
+	}
+
+	void TimestampQueryPool::create(vk::PhysicalDevice physicalDevice, vk::Device device, uint32_t queueFamily, uint32_t frameCount, uint32_t maxScopes) {
+		m_device = device;
+		m_maxScopes = maxScopes;
+
+		const vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
+		const uint32_t validBits = physicalDevice.getQueueFamilyProperties().at(queueFamily).timestampValidBits;
+		if (validBits == 0 || properties.limits.timestampPeriod == 0.0f) {
+			SA_DEBUG_LOG_WARNING("Timestamp queries not supported on queue family ", queueFamily, ", GPU timings disabled");
+			return;
+		}
+		m_timestampPeriod = properties.limits.timestampPeriod;
+		m_timestampMask = validBits >= 64 ? UINT64_MAX : (1ULL << validBits) - 1;
+
+		m_frames.resize(frameCount);
+		for (auto& frame : m_frames) {
+			frame.queryPool = m_device.createQueryPool(vk::QueryPoolCreateInfo{
+				.queryType = vk::QueryType::eTimestamp,
+				.queryCount = m_maxScopes * 2,
+			});
+			frame.scopeNames.reserve(m_maxScopes);
+			frame.scopeDepths.reserve(m_maxScopes);
+		}
+	}
+
+	void TimestampQueryPool::destroy() {
+		for (auto& frame : m_frames) {
+			m_device.destroyQueryPool(frame.queryPool);
+		}
+		m_frames.clear();
+	}
+
+	void TimestampQueryPool::beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex) {
+		if (!isEnabled())
+			return;
+		const std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_frameIndex = frameIndex % m_frames.size();
+		Frame& frame = m_frames[m_frameIndex];
+		if (frame.isPending) {
+			resolve(frame);
+		}
+
+		frame.scopeNames.clear();
+		frame.scopeDepths.clear();
+		frame.cpuBeginTime = std::chrono::time_point_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()).time_since_epoch().count();
+		commandBuffer.resetQueryPool(frame.queryPool, 0, m_maxScopes * 2);
+
+		m_isRecording = true;
+		m_depth = 0;
+
+		frame.scopeNames.push_back("Frame");
+		frame.scopeDepths.push_back(m_depth++);
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool, 0);
+	}
+
+	void TimestampQueryPool::endFrame(vk::CommandBuffer commandBuffer) {
+		if (!m_isRecording)
+			return;
+		const std::lock_guard<std::mutex> lock(m_mutex);
+
+		Frame& frame = m_frames[m_frameIndex];
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool, 1);
+		frame.isPending = true;
+		m_isRecording = false;
+	}
+
+	uint32_t TimestampQueryPool::beginScope(vk::CommandBuffer commandBuffer, const char* name) {
+		if (!m_isRecording)
+			return UINT32_MAX;
+		const std::lock_guard<std::mutex> lock(m_mutex);
+
+		Frame& frame = m_frames[m_frameIndex];
+		if (frame.scopeNames.size() >= m_maxScopes)
+			return UINT32_MAX;
+
+		uint32_t scope = static_cast<uint32_t>(frame.scopeNames.size());
+		frame.scopeNames.push_back(name);
+		frame.scopeDepths.push_back(m_depth++);
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool, scope * 2);
+		return scope;
+	}
+
+	void TimestampQueryPool::endScope(vk::CommandBuffer commandBuffer, uint32_t scope) {
+		if (!m_isRecording || scope == UINT32_MAX)
+			return;
+		const std::lock_guard<std::mutex> lock(m_mutex);
+
+		Frame& frame = m_frames[m_frameIndex];
+		if (m_depth > 0)
+			m_depth--;
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool, scope * 2 + 1);
+	}
+
+	bool TimestampQueryPool::isEnabled() const {
+		return !m_frames.empty();
+	}
+
+	const GpuFrameTimestamps& TimestampQueryPool::getLastResults() const {
+		return m_lastResults;
+	}
+
+}
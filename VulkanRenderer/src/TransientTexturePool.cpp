@@ -0,0 +1,202 @@
+#include "pch.h"
+#include "internal/TransientTexturePool.hpp"
+
+#define LAZY_HEAP_KEY_BIT (1ULL << 32)
+
+namespace sa {
+
+	static bool LifetimesOverlap(const TransientTextureRequest& first, const TransientTextureRequest& second) {
+		return first.firstUse <= second.lastUse && second.firstUse <= first.lastUse;
+	}
+
+	static vk::DeviceSize AlignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	void TransientTexturePool::destroyHeap(Heap& heap) {
+		for (auto& entry : heap.entries) {
+			for (auto& mipTexture : entry.texture.mipLevelTextures) {
+				mipTexture.destroy();
+			}
+			entry.texture.texture.destroy();
+		}
+		heap.entries.clear();
+
+		if (heap.allocation) {
+			m_pMemoryManager->freeMemory(heap.allocation);
+			heap.allocation = nullptr;
+		}
+		heap.size = 0;
+	}
+
+	vk::ImageCreateInfo TransientTexturePool::getImageCreateInfo(const TransientTextureDesc& desc) const {
+		return vk::ImageCreateInfo{
+			.imageType = vk::ImageType::e2D,
+			.format = static_cast<vk::Format>(desc.format),
+			.extent = { desc.extent.width, desc.extent.height, 1 },
+			.mipLevels = desc.mipLevels,
+			.arrayLayers = desc.arrayLayers,
+			.samples = static_cast<vk::SampleCountFlagBits>(desc.samples),
+			.tiling = vk::ImageTiling::eOptimal,
+			.usage = static_cast<vk::ImageUsageFlags>(desc.usage),
+			.sharingMode = vk::SharingMode::eExclusive,
+			.initialLayout = vk::ImageLayout::eUndefined,
+		};
+	}
+
+	const TransientTexture* TransientTexturePool::getTexture(Heap& heap, const TransientTextureDesc& desc, vk::DeviceSize offset) {
+		for (auto& entry : heap.entries) {
+			if (entry.offset == offset && entry.desc == desc) {
+				entry.lastUsedFrame = m_frameCount;
+				return &entry.texture;
+			}
+		}
+
+		Entry& entry = heap.entries.emplace_back();
+		entry.desc = desc;
+		entry.offset = offset;
+		entry.lastUsedFrame = m_frameCount;
+
+		DeviceImage* pImage = m_pMemoryManager->createAliasingImage(heap.allocation, offset, getImageCreateInfo(desc));
+		TextureType type = (desc.arrayLayers > 1) ? TextureType::TEXTURE_TYPE_2D_ARRAY : TextureType::TEXTURE_TYPE_2D;
+		entry.texture.texture.create(pImage, type, desc.usage);
+		entry.texture.mipLevelTextures = entry.texture.texture.createMipLevelTextures();
+		return &entry.texture;
+	}
+
+	TransientTexturePool::TransientTexturePool()
+		: m_pMemoryManager(nullptr)
+		, m_frameIndex(0)
+		, m_frameCount(0)
+	{
+	}
+
+	void TransientTexturePool::create(DeviceMemoryManager* pMemoryManager, uint32_t frameCount) {
+		m_pMemoryManager = pMemoryManager;
+		m_frames.resize(frameCount);
+		m_frameIndex = 0;
+		m_frameCount = 0;
+	}
+
+	void TransientTexturePool::destroy() {
+		for (auto& frame : m_frames) {
+			for (auto& [key, heap] : frame.heaps) {
+				destroyHeap(heap);
+			}
+			for (auto& heap : frame.retiredHeaps) {
+				destroyHeap(heap);
+			}
+		}
+		m_frames.clear();
+	}
+
+	void TransientTexturePool::beginFrame(uint32_t frameIndex) {
+		m_frameIndex = frameIndex % m_frames.size();
+		m_frameCount++;
+		Frame& frame = m_frames[m_frameIndex];
+
+		for (auto& heap : frame.retiredHeaps) {
+			destroyHeap(heap);
+		}
+		frame.retiredHeaps.clear();
+
+		// Textures of resized render targets are never asked for again
+		for (auto& [key, heap] : frame.heaps) {
+			heap.entries.remove_if([&](Entry& entry) {
+				if (entry.lastUsedFrame + TRANSIENT_TEXTURE_MAX_UNUSED_FRAMES > m_frameCount)
+					return false;
+				for (auto& mipTexture : entry.texture.mipLevelTextures) {
+					mipTexture.destroy();
+				}
+				entry.texture.texture.destroy();
+				return true;
+			});
+		}
+	}
+
+	void TransientTexturePool::allocate(const TransientTextureRequest* pRequests, uint32_t count, const TransientTexture** ppTextures) {
+		Frame& frame = m_frames[m_frameIndex];
+
+		struct Placement {
+			uint32_t request;
+			vk::MemoryRequirements requirements;
+			vk::DeviceSize offset;
+		};
+
+		// Textures can only share memory of a type they all support
+		std::unordered_map<uint64_t, std::vector<Placement>> groups;
+		for (uint32_t i = 0; i < count; i++) {
+			const TransientTextureDesc& desc = pRequests[i].desc;
+			vk::MemoryRequirements requirements = m_pMemoryManager->getImageMemoryRequirements(getImageCreateInfo(desc));
+			uint64_t key = requirements.memoryTypeBits;
+			if ((desc.usage & TextureUsageFlagBits::TRANSIENT_ATTACHMENT) && m_pMemoryManager->hasLazilyAllocatedMemory())
+				key |= LAZY_HEAP_KEY_BIT;
+			groups[key].push_back({ i, requirements, 0 });
+		}
+
+		for (auto& [key, placements] : groups) {
+			// Largest first, smaller textures then fill in around them
+			std::sort(placements.begin(), placements.end(), [](const Placement& first, const Placement& second) {
+				return first.requirements.size > second.requirements.size;
+			});
+
+			vk::DeviceSize heapSize = 0;
+			vk::DeviceSize heapAlignment = 1;
+			for (size_t i = 0; i < placements.size(); i++) {
+				Placement& placement = placements[i];
+				const TransientTextureRequest& request = pRequests[placement.request];
+
+				// Move past every placed texture that is alive at the same time and overlaps in memory
+				bool isMoved = true;
+				while (isMoved) {
+					isMoved = false;
+					for (size_t j = 0; j < i; j++) {
+						const Placement& other = placements[j];
+						if (!LifetimesOverlap(request, pRequests[other.request]))
+							continue;
+						if (placement.offset < other.offset + other.requirements.size && other.offset < placement.offset + placement.requirements.size) {
+							placement.offset = AlignUp(other.offset + other.requirements.size, placement.requirements.alignment);
+							isMoved = true;
+						}
+					}
+				}
+				heapSize = std::max(heapSize, placement.offset + placement.requirements.size);
+				heapAlignment = std::max(heapAlignment, placement.requirements.alignment);
+			}
+
+			Heap& heap = frame.heaps[key];
+			if (heap.size < heapSize) {
+				if (heap.allocation) {
+					frame.retiredHeaps.push_back(std::move(heap));
+					heap = Heap();
+				}
+
+				vk::MemoryRequirements requirements = {
+					.size = heapSize,
+					.alignment = heapAlignment,
+					.memoryTypeBits = static_cast<uint32_t>(key),
+				};
+				if (key & LAZY_HEAP_KEY_BIT)
+					heap.allocation = m_pMemoryManager->allocateMemory(requirements, VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED, vk::MemoryPropertyFlagBits::eLazilyAllocated);
+				else
+					heap.allocation = m_pMemoryManager->allocateMemory(requirements, VMA_MEMORY_USAGE_UNKNOWN, vk::MemoryPropertyFlagBits::eDeviceLocal);
+				heap.size = heapSize;
+			}
+
+			for (const auto& placement : placements) {
+				ppTextures[placement.request] = getTexture(heap, pRequests[placement.request].desc, placement.offset);
+			}
+		}
+	}
+
+	vk::DeviceSize TransientTexturePool::getMemorySize() const {
+		vk::DeviceSize size = 0;
+		for (const auto& frame : m_frames) {
+			for (const auto& [key, heap] : frame.heaps) {
+				size += heap.size;
+			}
+		}
+		return size;
+	}
+
+}
@@ -1,8 +1,11 @@
 #include "pch.h"
 #include "internal/VulkanCore.hpp"
+#include "internal/DescriptorSet.hpp"
 
 #include "internal/debugFunctions.hpp" // for checkError and debugCallback
 
+#define GPU_TIMESTAMP_MAX_SCOPES 256U
+
 
 EXT_INITIALIZATION(vkCreateShadersEXT);
 EXT_INITIALIZATION(vkDestroyShaderEXT);
@@ -219,6 +222,8 @@ namespace sa {
 		indexingFeatures.runtimeDescriptorArray = VK_TRUE;
 		indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
 		indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
 		
 		/*
 		// VK_EXT_shader_object
@@ -273,6 +278,165 @@ namespace sa {
 		m_mainCommandPool.create(m_device, m_queueInfo.family, vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
 	}
 
+	struct PipelineCacheFileHeader {
+		uint32_t magic;
+		uint32_t dataSize;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t driverUUID[VK_UUID_SIZE];
+	};
+#define PIPELINE_CACHE_FILE_MAGIC 0x43505153 // "SQPC"
+
+	// Per user cache directory, the working directory may be read only or differ between runs
+	std::string GetUserCacheDirectory() {
+		std::filesystem::path directory;
+#ifdef _WIN32
+		char* pValue = nullptr;
+		size_t length = 0;
+		if (_dupenv_s(&pValue, &length, "LOCALAPPDATA") == 0 && pValue) {
+			directory = pValue;
+			free(pValue);
+		}
+#else
+		if (const char* pValue = std::getenv("XDG_CACHE_HOME"))
+			directory = pValue;
+		else if (const char* pHome = std::getenv("HOME"))
+			directory = std::filesystem::path(pHome) / ".cache";
+#endif
+		if (directory.empty())
+			return std::filesystem::current_path().generic_string();
+
+		directory /= "Saturn";
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			SA_DEBUG_LOG_WARNING("Could not create ", directory.generic_string(), ", using the working directory for the caches");
+			return std::filesystem::current_path().generic_string();
+		}
+		return directory.generic_string();
+	}
+
+	void VulkanCore::createPipelineCache() {
+		m_pipelineCachePath = (std::filesystem::path(GetUserCacheDirectory()) / "pipeline_cache.bin").generic_string();
+		m_savedPipelineCacheSize = 0;
+
+		auto properties = m_physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+		const vk::PhysicalDeviceProperties& deviceProperties = properties.get<vk::PhysicalDeviceProperties2>().properties;
+		const vk::PhysicalDeviceIDProperties& idProperties = properties.get<vk::PhysicalDeviceIDProperties>();
+
+		std::vector<char> data;
+		std::ifstream file(m_pipelineCachePath, std::ios::binary | std::ios::ate);
+		if (file.is_open()) {
+			size_t fileSize = file.tellg();
+			file.seekg(0);
+			
+			PipelineCacheFileHeader header = {};
+			if (fileSize >= sizeof(header)) {
+				file.read((char*)&header, sizeof(header));
+			}
+
+			bool isValid = header.magic == PIPELINE_CACHE_FILE_MAGIC
+				&& header.dataSize == fileSize - sizeof(header)
+				&& header.vendorID == deviceProperties.vendorID
+				&& header.deviceID == deviceProperties.deviceID
+				&& header.driverVersion == deviceProperties.driverVersion
+				&& memcmp(header.driverUUID, idProperties.driverUUID.data(), VK_UUID_SIZE) == 0;
+
+			if (isValid) {
+				data.resize(header.dataSize);
+				file.read(data.data(), data.size());
+				
+				// the vulkan header should agree as well, otherwise the driver would throw the data away anyway
+				VkPipelineCacheHeaderVersionOne cacheHeader = {};
+				if (data.size() >= sizeof(cacheHeader))
+					memcpy(&cacheHeader, data.data(), sizeof(cacheHeader));
+				
+				isValid = cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+					&& cacheHeader.vendorID == deviceProperties.vendorID
+					&& cacheHeader.deviceID == deviceProperties.deviceID
+					&& memcmp(cacheHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+			}
+
+			if (!isValid) {
+				SA_DEBUG_LOG_WARNING("Pipeline cache ", m_pipelineCachePath, " was created by another device or driver, ignoring it");
+				data.clear();
+			}
+		}
+
+		vk::PipelineCacheCreateInfo info = {};
+		info.initialDataSize = data.size();
+		info.pInitialData = data.data();
+		m_pipelineCache = m_device.createPipelineCache(info);
+		m_savedPipelineCacheSize = data.size();
+		SA_DEBUG_LOG_INFO("Pipeline cache created, initial size: ", data.size());
+	}
+
+	void VulkanCore::destroyPipelineCache() {
+		if (!m_pipelineCache)
+			return;
+		savePipelineCache();
+		m_device.destroyPipelineCache(m_pipelineCache);
+		m_pipelineCache = VK_NULL_HANDLE;
+	}
+
+	void VulkanCore::savePipelineCache() {
+		if (m_pipelineCacheSave.valid())
+			m_pipelineCacheSave.wait();
+		writePipelineCache();
+	}
+
+	bool VulkanCore::savePipelineCacheAsync() {
+		if (m_pipelineCacheSave.valid() && m_pipelineCacheSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+		m_pipelineCacheSave = std::async(std::launch::async, [this]() { writePipelineCache(); });
+		return true;
+	}
+
+	void VulkanCore::writePipelineCache() {
+		if (!m_pipelineCache)
+			return;
+		
+		std::vector<uint8_t> data = m_device.getPipelineCacheData(m_pipelineCache);
+		if (data.size() == m_savedPipelineCacheSize)
+			return;
+
+		auto properties = m_physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+		const vk::PhysicalDeviceProperties& deviceProperties = properties.get<vk::PhysicalDeviceProperties2>().properties;
+		const vk::PhysicalDeviceIDProperties& idProperties = properties.get<vk::PhysicalDeviceIDProperties>();
+
+		PipelineCacheFileHeader header = {
+			.magic = PIPELINE_CACHE_FILE_MAGIC,
+			.dataSize = (uint32_t)data.size(),
+			.vendorID = deviceProperties.vendorID,
+			.deviceID = deviceProperties.deviceID,
+			.driverVersion = deviceProperties.driverVersion,
+		};
+		memcpy(header.driverUUID, idProperties.driverUUID.data(), VK_UUID_SIZE);
+
+		// write to a temporary file first so a crash mid write can't leave a broken cache behind
+		std::string tempPath = m_pipelineCachePath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				SA_DEBUG_LOG_ERROR("Failed to open ", tempPath, " for writing");
+				return;
+			}
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)data.data(), data.size());
+		}
+		std::remove(m_pipelineCachePath.c_str());
+		if (std::rename(tempPath.c_str(), m_pipelineCachePath.c_str()) != 0) {
+			SA_DEBUG_LOG_ERROR("Failed to write pipeline cache ", m_pipelineCachePath);
+			return;
+		}
+		m_savedPipelineCacheSize = data.size();
+	}
+
+	vk::PipelineCache VulkanCore::getPipelineCache() const {
+		return m_pipelineCache;
+	}
+
 	bool VulkanCore::IsDepthFormat(vk::Format format) {
 		return format == vk::Format::eD16Unorm
 			|| format == vk::Format::eD16UnormS8Uint
@@ -343,6 +507,21 @@ namespace sa {
 			*pStage = vk::PipelineStageFlagBits::eFragmentShader;
 			*pLayout = vk::ImageLayout::eGeneral;
 			break;
+		case Transition::VERTEX_SHADER_READ:
+			*pAccess = vk::AccessFlagBits::eShaderRead;
+			*pStage = vk::PipelineStageFlagBits::eVertexShader;
+			*pLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+			break;
+		case Transition::INDIRECT_READ: // only meaningful for buffers
+			*pAccess = vk::AccessFlagBits::eIndirectCommandRead;
+			*pStage = vk::PipelineStageFlagBits::eDrawIndirect;
+			*pLayout = vk::ImageLayout::eUndefined;
+			break;
+		case Transition::ALIASED:
+			*pAccess = vk::AccessFlagBits::eMemoryWrite;
+			*pStage = vk::PipelineStageFlagBits::eAllCommands;
+			*pLayout = vk::ImageLayout::eUndefined;
+			break;
 		default:
 			throw std::runtime_error("Unimplemented transition");
 			break;
@@ -362,6 +541,12 @@ namespace sa {
 		createCommandPool();
 
 		m_memoryManager.create(m_instance, m_device, m_physicalDevice, m_appInfo.apiVersion);
+		m_transientDescriptorPools.create(m_device, FRAMES_IN_FLIGHT);
+		m_descriptorSetCache.create(m_device);
+		m_timestampQueryPool.create(m_physicalDevice, m_device, m_queueInfo.family, FRAMES_IN_FLIGHT, GPU_TIMESTAMP_MAX_SCOPES);
+		m_transientTextures.create(&m_memoryManager, FRAMES_IN_FLIGHT);
+
+		createPipelineCache();
 
 		fillFormats();
 
@@ -372,6 +557,11 @@ namespace sa {
 	void VulkanCore::cleanup() {
 		cleanupImGui();
 
+		destroyPipelineCache();
+		m_transientTextures.destroy();
+		m_timestampQueryPool.destroy();
+		m_descriptorSetCache.destroy();
+		m_transientDescriptorPools.destroy();
 		m_memoryManager.destroy();
 		m_mainCommandPool.destroy();
 
@@ -432,7 +622,7 @@ namespace sa {
 			.Device = m_device,
 			.QueueFamily = m_queueInfo.family,
 			.Queue = imguiQueue,
-			.PipelineCache = VK_NULL_HANDLE,
+			.PipelineCache = m_pipelineCache,
 			.DescriptorPool = m_imGuiDescriptorPool,
 			.Subpass = subpass,
 			.MinImageCount = 2,
@@ -716,10 +906,14 @@ namespace sa {
 	}
 
 	void VulkanCore::destroyBuffer(DeviceBuffer* pBuffer) {
+		const uint64_t handle = (uint64_t)(VkBuffer)pBuffer->buffer;
 		m_memoryManager.destroyBuffer(pBuffer);
+		DescriptorSet::OnHandleDestroyed(handle);
 	}
 
 	DeviceImage* VulkanCore::createImage2D(Extent extent, vk::Format format, vk::ImageUsageFlags usage, vk::SampleCountFlagBits sampleCount, uint32_t mipLevels, uint32_t arrayLayers, vk::ImageCreateFlags flags) {
+		// Transient attachments never leave tile memory on devices that can back them lazily
+		const bool isLazilyAllocated = (usage & vk::ImageUsageFlagBits::eTransientAttachment) && m_memoryManager.hasLazilyAllocatedMemory();
 		return m_memoryManager.createImage(
 			{ extent.width, extent.height, 1 },
 			arrayLayers,
@@ -732,8 +926,8 @@ namespace sa {
 			vk::SharingMode::eExclusive,
 			vk::ImageTiling::eOptimal,
 			usage,
-			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			isLazilyAllocated ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+			isLazilyAllocated ? vk::MemoryPropertyFlagBits::eLazilyAllocated : vk::MemoryPropertyFlagBits::eDeviceLocal,
 			flags
 		);
 	}
@@ -758,6 +952,7 @@ namespace sa {
 	}
 
 	void VulkanCore::destroyImage(DeviceImage* pImage) {
+		// descriptors reference the views of the image, which invalidate their own entries
 		m_memoryManager.destroyImage(pImage);
 	}
 
@@ -1043,11 +1238,33 @@ namespace sa {
 	}
 
 	DeviceMemoryStats VulkanCore::getGPUMemoryUsage() const {
-		return std::move(m_memoryManager.getDeviceMemoryStats());
+		DeviceMemoryStats stats = m_memoryManager.getDeviceMemoryStats();
+		stats.transientTextureBytes = m_transientTextures.getMemorySize();
+		return std::move(stats);
+	}
+
+	size_t VulkanCore::getAllocationCount() const {
+		return m_memoryManager.getAllocationCount();
 	}
 
 	void VulkanCore::setMemoryManagerFrameIndex(uint32_t frameIndex) {
 		m_memoryManager.setCurrentFrameIndex(frameIndex);
 	}
 
+	DescriptorPoolRing& VulkanCore::getTransientDescriptorPools() {
+		return m_transientDescriptorPools;
+	}
+
+	DescriptorSetCache& VulkanCore::getDescriptorSetCache() {
+		return m_descriptorSetCache;
+	}
+
+	TimestampQueryPool& VulkanCore::getTimestampQueryPool() {
+		return m_timestampQueryPool;
+	}
+
+	TransientTexturePool& VulkanCore::getTransientTexturePool() {
+		return m_transientTextures;
+	}
+
 }
\ No newline at end of file